@@ -0,0 +1,84 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <nlohmann/json.hpp>
+
+void BenchmarkRunner::addResult(BenchmarkResult& result)
+{
+    std::vector<double> sorted = result.samples;
+    std::sort(sorted.begin(), sorted.end());
+
+    double sum = 0.0;
+    for (double sample : sorted)
+    {
+        sum += sample;
+    }
+    result.mean = sum / sorted.size();
+    result.min = sorted.front();
+    result.max = sorted.back();
+    size_t middle = sorted.size() / 2;
+    result.median = sorted.size() % 2 ? sorted[middle] : (sorted[middle - 1] + sorted[middle]) * 0.5;
+
+    double variance = 0.0;
+    for (double sample : sorted)
+    {
+        variance += (sample - result.mean) * (sample - result.mean);
+    }
+    result.stddev = sorted.size() > 1 ? std::sqrt(variance / (sorted.size() - 1)) : 0.0;
+
+    if (results.empty())
+    {
+        std::cout << std::left << std::setw(44) << "Benchmark" << std::right << std::setw(14) << "median ns"
+            << std::setw(14) << "mean ns" << std::setw(14) << "min ns" << std::setw(9) << "cv %" << std::setw(12)
+            << "calls" << std::endl;
+    }
+
+    std::ios::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(1) << std::left << std::setw(44) << result.name << std::right
+        << std::setw(14) << result.median << std::setw(14) << result.mean << std::setw(14) << result.min
+        << std::setw(9) << (result.mean > 0.0 ? result.stddev / result.mean * 100.0 : 0.0) << std::setw(12)
+        << result.callsPerRepetition << std::endl;
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+
+    results.push_back(result);
+}
+
+bool BenchmarkRunner::writeJSON(const std::string& path) const
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+
+    nlohmann::json benchmarks = nlohmann::json::array();
+    for (const BenchmarkResult& result : results)
+    {
+        benchmarks.push_back({
+            {"name", result.name},
+            {"items_per_call", result.itemsPerCall},
+            {"calls_per_repetition", result.callsPerRepetition},
+            {"mean_ns", result.mean},
+            {"median_ns", result.median},
+            {"min_ns", result.min},
+            {"max_ns", result.max},
+            {"stddev_ns", result.stddev},
+            {"samples_ns", result.samples}
+        });
+    }
+
+    nlohmann::json document = {
+        {"warmup_repetitions", settings.warmupRepetitions},
+        {"repetitions", settings.repetitions},
+        {"min_repetition_seconds", settings.minRepetitionSeconds},
+        {"benchmarks", benchmarks}
+    };
+    file << document.dump(2) << std::endl;
+    return (bool)file;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Keeps the compiler from discarding a result the benchmark does not otherwise use.
+template<typename T>
+inline void doNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    const volatile char* bytes = reinterpret_cast<const volatile char*>(&value);
+    (void)bytes[0];
+#endif
+}
+
+struct BenchmarkSettings
+{
+    // Untimed repetitions before measuring, to warm caches and the allocator.
+    int warmupRepetitions = 2;
+    int repetitions = 10;
+    // Calls per repetition are raised until one repetition takes at least this long.
+    double minRepetitionSeconds = 0.05;
+    // Only benchmarks whose name contains this run.
+    std::string filter;
+};
+
+struct BenchmarkResult
+{
+    std::string name;
+    size_t itemsPerCall = 1;
+    size_t callsPerRepetition = 0;
+    // Nanoseconds per item, one sample per repetition.
+    std::vector<double> samples;
+    double mean = 0.0;
+    double median = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+    double stddev = 0.0;
+};
+
+// Times a function over repeated calls. The number of calls per repetition is
+// calibrated first so a repetition is long enough for the clock to resolve; the
+// statistics are over the per-repetition averages.
+class BenchmarkRunner
+{
+public:
+    explicit BenchmarkRunner(const BenchmarkSettings& settings) : settings(settings) {}
+
+    // fn handles itemsPerCall items per call (e.g. objects in a batch); results are per item.
+    template<typename Fn>
+    void run(const std::string& name, size_t itemsPerCall, Fn&& fn)
+    {
+        if (!settings.filter.empty() && name.find(settings.filter) == std::string::npos)
+        {
+            return;
+        }
+
+        size_t calls = 1;
+        double seconds = timeCalls(fn, calls);
+        while (seconds < settings.minRepetitionSeconds && calls < ((size_t)1 << 30))
+        {
+            double scale = seconds > 0.0 ? settings.minRepetitionSeconds / seconds * 1.2 : 10.0;
+            calls = (size_t)(calls * std::min(std::max(scale, 2.0), 100.0));
+            seconds = timeCalls(fn, calls);
+        }
+
+        for (int i = 0; i < settings.warmupRepetitions; ++i)
+        {
+            timeCalls(fn, calls);
+        }
+
+        BenchmarkResult result;
+        result.name = name;
+        result.itemsPerCall = itemsPerCall;
+        result.callsPerRepetition = calls;
+        for (int i = 0; i < settings.repetitions; ++i)
+        {
+            result.samples.push_back(timeCalls(fn, calls) * 1e9 / ((double)calls * itemsPerCall));
+        }
+        addResult(result);
+    }
+
+    const std::vector<BenchmarkResult>& getResults() const { return results; }
+    bool writeJSON(const std::string& path) const;
+
+private:
+    template<typename Fn>
+    static double timeCalls(Fn& fn, size_t calls)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < calls; ++i)
+        {
+            fn();
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Computes the statistics and prints the result line.
+    void addResult(BenchmarkResult& result);
+
+    BenchmarkSettings settings;
+    std::vector<BenchmarkResult> results;
+};
@@ -0,0 +1,445 @@
+// Micro benchmarks of the CPU hot paths of the application: model and material
+// loading, curve evaluation, collision and frustum tests, model matrix
+// construction, static batching, the CPU particle simulation, recording and
+// null-backend replay of command buffers and config parsing. Run a Release
+// build from the build directory so the fixtures in finalProject are found:
+//
+//     bench --json results.json [--filter name] [--repetitions N] [--min-time seconds]
+//
+// --commands replays a frame saved by the application with --dump-commands too.
+
+#include "Benchmark.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <nlohmann/json.hpp>
+#include <glm/glm/gtc/matrix_transform.hpp>
+#include <glm/glm/gtc/quaternion.hpp>
+#include <ParametricCurves/Bezier.h>
+#include <ParametricCurves/Hermite.h>
+#include <Rendering/CommandBackend.h>
+#include <Rendering/ObjLoader.h>
+#include <Scene/StaticBatch.h>
+#include <Scene/Transform.h>
+#include <Simulation/Collision.h>
+#include <Simulation/FrameSnapshot.h>
+#include <Simulation/ParticleSimulation.h>
+
+using json = nlohmann::json;
+
+namespace
+{
+    const size_t BATCH_SIZE = 1024;
+    const float PI = 3.14159265f;
+
+    // Writes a UV sphere as a triangulated OBJ with v/vt/vn faces, the only form loadObject reads.
+    void writeSphereOBJ(const std::string& path, int rings, int sectors)
+    {
+        std::ofstream file(path);
+        file << "mtllib sphere.mtl\n";
+        for (int r = 0; r <= rings; ++r)
+        {
+            float phi = PI * r / rings;
+            for (int s = 0; s <= sectors; ++s)
+            {
+                float theta = 2.0f * PI * s / sectors;
+                glm::vec3 n(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta));
+                file << "v " << n.x << " " << n.y << " " << n.z << "\n";
+                file << "vt " << (float)s / sectors << " " << (float)r / rings << "\n";
+                file << "vn " << n.x << " " << n.y << " " << n.z << "\n";
+            }
+        }
+        file << "usemtl sphere\n";
+        for (int r = 0; r < rings; ++r)
+        {
+            for (int s = 0; s < sectors; ++s)
+            {
+                int a = r * (sectors + 1) + s + 1;
+                int b = a + sectors + 1;
+                file << "f " << a << "/" << a << "/" << a << " " << b << "/" << b << "/" << b << " "
+                    << a + 1 << "/" << a + 1 << "/" << a + 1 << "\n";
+                file << "f " << a + 1 << "/" << a + 1 << "/" << a + 1 << " " << b << "/" << b << "/" << b << " "
+                    << b + 1 << "/" << b + 1 << "/" << b + 1 << "\n";
+            }
+        }
+    }
+
+    void writeSphereMTL(const std::string& path)
+    {
+        std::ofstream file(path);
+        file << "newmtl sphere\n"
+            << "Ns 250.0\n"
+            << "Ka 1.0 1.0 1.0\n"
+            << "Kd 0.8 0.4 0.1\n"
+            << "Ks 0.5 0.5 0.5\n"
+            << "Ke 0.0 0.0 0.0\n"
+            << "map_Kd sphere.jpg\n";
+    }
+
+    std::string readFile(const std::string& path)
+    {
+        std::ifstream file(path);
+        std::stringstream stream;
+        stream << file.rdbuf();
+        return stream.str();
+    }
+
+    // Stands in for the config when the benchmark is not run from the build directory.
+    std::string makeSyntheticConfig()
+    {
+        json config;
+        config["simulationRate"] = 120;
+        config["shadowMapSize"] = 2048;
+        for (int i = 0; i < 16; ++i)
+        {
+            config["objects"].push_back({
+                {"name", "object" + std::to_string(i)},
+                {"path", "../models/object/object.obj"},
+                {"position", {i * 1.5f, 0.0f, -2.0f}},
+                {"rotation", {0.0f, i * 10.0f, 0.0f}},
+                {"scale", {1.0f, 1.0f, 1.0f}}
+            });
+        }
+        return config.dump(4);
+    }
+
+    void printUsage()
+    {
+        std::cout << "Usage: bench [--json path] [--filter name] [--repetitions N] [--min-time seconds]"
+            " [--commands commands.bin]" << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkSettings settings;
+    std::string jsonOutput;
+    std::string commandsInput;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (argument == "--json" && hasValue)
+        {
+            jsonOutput = argv[++i];
+        }
+        else if (argument == "--filter" && hasValue)
+        {
+            settings.filter = argv[++i];
+        }
+        else if (argument == "--repetitions" && hasValue)
+        {
+            settings.repetitions = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (argument == "--min-time" && hasValue)
+        {
+            settings.minRepetitionSeconds = std::atof(argv[++i]);
+        }
+        else if (argument == "--commands" && hasValue)
+        {
+            commandsInput = argv[++i];
+        }
+        else
+        {
+            printUsage();
+            return argument == "--help" ? 0 : 1;
+        }
+    }
+
+    // --- Fixtures ---
+
+    std::filesystem::path fixtureDirectory = std::filesystem::temp_directory_path() / "basket_bench";
+    std::filesystem::create_directories(fixtureDirectory);
+    std::string sphereOBJ = (fixtureDirectory / "sphere.obj").string();
+    std::string sphereMTL = (fixtureDirectory / "sphere.mtl").string();
+    writeSphereOBJ(sphereOBJ, 32, 64);
+    writeSphereMTL(sphereMTL);
+
+    std::string orangeOBJ = "../finalProject/models/orange/orange.obj";
+    std::string orangeMTL = "../finalProject/models/orange/orange.mtl";
+    bool hasOrange = std::filesystem::exists(orangeOBJ) && std::filesystem::exists(orangeMTL);
+
+    std::string configText = readFile("../finalProject/basketball_config.json");
+    if (configText.empty())
+    {
+        std::cout << "basketball_config.json not found, parsing a synthetic config" << std::endl;
+        configText = makeSyntheticConfig();
+    }
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    std::vector<glm::vec3> sphereCenters(BATCH_SIZE);
+    for (glm::vec3& center : sphereCenters)
+    {
+        center = glm::vec3(unit(random), unit(random), unit(random)) * 3.0f;
+    }
+
+    std::vector<glm::vec3> positions(BATCH_SIZE);
+    std::vector<glm::quat> rotations(BATCH_SIZE);
+    std::vector<glm::vec3> scales(BATCH_SIZE);
+    std::vector<InterpolatedTransform> transforms(BATCH_SIZE);
+    for (size_t i = 0; i < BATCH_SIZE; ++i)
+    {
+        positions[i] = glm::vec3(unit(random), unit(random), unit(random)) * 10.0f;
+        rotations[i] = glm::normalize(glm::quat(unit(random), unit(random), unit(random), unit(random)));
+        scales[i] = glm::vec3(1.0f + unit(random) * 0.5f);
+
+        transforms[i].previousPosition = positions[i];
+        transforms[i].position = positions[i] + glm::vec3(0.1f, 0.0f, 0.0f);
+        transforms[i].previousRotation = rotations[i];
+        transforms[i].rotation = glm::normalize(rotations[i] * glm::angleAxis(0.1f, glm::vec3(0.0f, 1.0f, 0.0f)));
+        transforms[i].scale = scales[i];
+    }
+
+    // A three point arc, like the throwing preview.
+    Bezier bezier;
+    bezier.setControlPoints({glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(2.0f, 4.0f, -3.0f), glm::vec3(4.0f, 0.0f, -6.0f)});
+
+    // A ring of 100 points, like the path of the stars.
+    std::vector<glm::vec3> hermiteControlPoints;
+    for (int i = 0; i < 100; ++i)
+    {
+        float angle = 2.0f * PI * i / 100;
+        hermiteControlPoints.push_back(glm::vec3(std::cos(angle) * 60.0f, 0.0f, std::sin(angle) * 60.0f));
+    }
+    Hermite hermite;
+    hermite.setControlPoints(hermiteControlPoints);
+
+    // Copies of the sphere placed around the court with two materials, like static scenery.
+    std::vector<StaticMeshInstance> staticInstances(64);
+    {
+        std::vector<glm::vec3> vertices;
+        std::vector<glm::vec2> uvs;
+        std::vector<glm::vec3> normals;
+        loadObject(sphereOBJ.c_str(), vertices, uvs, normals);
+        auto interleaved = std::make_shared<std::vector<GLfloat>>();
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            interleaved->insert(interleaved->end(), {vertices[i].x, vertices[i].y, vertices[i].z, uvs[i].x, uvs[i].y,
+                                                     normals[i].x, normals[i].y, normals[i].z});
+        }
+
+        for (size_t i = 0; i < staticInstances.size(); ++i)
+        {
+            StaticMeshInstance& instance = staticInstances[i];
+            instance.mesh.vertexCount = (GLuint)vertices.size();
+            instance.vertices = interleaved;
+            instance.materialIndex = (MaterialIndex)(i % 2);
+            Transform transform;
+            transform.setPosition(positions[i]);
+            transform.setRotation(rotations[i]);
+            transform.setScale(scales[i]);
+            instance.model = transform.getWorldMatrix();
+            instance.normalMatrix = transform.getNormalMatrix();
+        }
+    }
+
+    // A command stream saved by the application with --dump-commands.
+    CommandBuffer capturedCommands;
+    if (!commandsInput.empty() && !capturedCommands.load(commandsInput))
+    {
+        return 1;
+    }
+
+    glm::mat4 cameraViewProjection = glm::perspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f, 100.0f) *
+        glm::lookAt(glm::vec3(0.0f, 5.0f, 10.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    Frustum frustum = Frustum::fromMatrix(cameraViewProjection);
+
+    // --- Benchmarks ---
+
+    BenchmarkRunner runner(settings);
+
+    runner.run("loadObject/sphere_4k_triangles", 1, [&]()
+    {
+        std::vector<glm::vec3> vertices;
+        std::vector<glm::vec2> uvs;
+        std::vector<glm::vec3> normals;
+        loadObject(sphereOBJ.c_str(), vertices, uvs, normals);
+        doNotOptimize(vertices.data());
+    });
+
+    if (hasOrange)
+    {
+        runner.run("loadObject/orange", 1, [&]()
+        {
+            std::vector<glm::vec3> vertices;
+            std::vector<glm::vec2> uvs;
+            std::vector<glm::vec3> normals;
+            loadObject(orangeOBJ.c_str(), vertices, uvs, normals);
+            doNotOptimize(vertices.data());
+        });
+
+        runner.run("loadMTL/orange", 1, [&]()
+        {
+            MTLMaterial material = loadMTL(orangeMTL);
+            doNotOptimize(material);
+        });
+    }
+
+    runner.run("loadMTL/sphere", 1, [&]()
+    {
+        MTLMaterial material = loadMTL(sphereMTL);
+        doNotOptimize(material);
+    });
+
+    runner.run("Bezier::evaluateQuadraticCurve/30", 1, [&]()
+    {
+        bezier.evaluateQuadraticCurve(30);
+        doNotOptimize(bezier.getPointOnCurve(0));
+    });
+
+    runner.run("Hermite::evaluateCurve/100x60", 1, [&]()
+    {
+        hermite.evaluateCurve(60);
+        doNotOptimize(hermite.getPointOnCurve(0));
+    });
+
+    runner.run("checkSphereAABB", BATCH_SIZE, [&]()
+    {
+        int hits = 0;
+        for (const glm::vec3& center : sphereCenters)
+        {
+            hits += checkSphereAABB(center, 0.5f, glm::vec3(-1.0f), glm::vec3(1.0f));
+        }
+        doNotOptimize(hits);
+    });
+
+    runner.run("Frustum::intersectsAABB", BATCH_SIZE, [&]()
+    {
+        int visible = 0;
+        for (const glm::vec3& position : positions)
+        {
+            visible += frustum.intersectsAABB(position - glm::vec3(0.5f), position + glm::vec3(0.5f));
+        }
+        doNotOptimize(visible);
+    });
+
+    for (int threadCount : {1, 0})
+    {
+        std::string threads = threadCount ? "1_thread" : "all_threads";
+        runner.run("buildStaticBatches/64_spheres_" + threads, 1, [&]()
+        {
+            std::vector<StaticBatch> batches = buildStaticBatches(staticInstances, 2048, threadCount);
+            doNotOptimize(batches.data());
+        });
+    }
+
+    // The objects pass: per object its transforms, material, texture, vertex array and draw.
+    CommandBuffer commands;
+    auto recordObjects = [&]()
+    {
+        commands.reset();
+        commands.useProgram(1);
+        commands.bindSampler(0, 1);
+        for (size_t i = 0; i < BATCH_SIZE; ++i)
+        {
+            commands.setUniform(0, transforms[i].getModelMatrix(0.5f));
+            commands.setUniform(1, transforms[i].getNormalMatrix(0.5f));
+            commands.setUniform(2, (int)(i % 4));
+            commands.bindTexture(0, GL_TEXTURE_2D, 1 + (GLuint)(i % 4));
+            commands.bindVertexArray(1 + (GLuint)(i % 16));
+            commands.drawArrays(GL_TRIANGLES, 0, 3 * 4096);
+        }
+    };
+
+    runner.run("CommandBuffer::record/objects_pass", BATCH_SIZE, [&]()
+    {
+        recordObjects();
+        doNotOptimize(commands.size());
+    });
+
+    recordObjects();
+    NullCommandBackend nullBackend;
+    runner.run("NullCommandBackend::submit/objects_pass", BATCH_SIZE, [&]()
+    {
+        RenderStats stats;
+        nullBackend.submit(commands, 0, stats);
+        doNotOptimize(stats.drawCalls);
+    });
+
+    if (!capturedCommands.empty())
+    {
+        runner.run("NullCommandBackend::submit/captured", capturedCommands.size(), [&]()
+        {
+            RenderStats stats;
+            nullBackend.submit(capturedCommands, 0, stats);
+            doNotOptimize(stats.drawCalls);
+        });
+
+        // Counts and validation errors of a single replay.
+        nullBackend.reset();
+        RenderStats stats;
+        nullBackend.submit(capturedCommands, 0, stats);
+        nullBackend.print(std::cout);
+    }
+
+    runner.run("Transform::composeWorldMatrix+NormalMatrix", BATCH_SIZE, [&]()
+    {
+        glm::mat4 sum(0.0f);
+        for (size_t i = 0; i < BATCH_SIZE; ++i)
+        {
+            sum += Transform::composeWorldMatrix(positions[i], rotations[i], scales[i]);
+            sum[0] += glm::vec4(Transform::composeNormalMatrix(rotations[i], scales[i])[0], 0.0f);
+        }
+        doNotOptimize(sum);
+    });
+
+    runner.run("InterpolatedTransform::getModelMatrix", BATCH_SIZE, [&]()
+    {
+        glm::mat4 sum(0.0f);
+        for (const InterpolatedTransform& transform : transforms)
+        {
+            sum += transform.getModelMatrix(0.5f);
+        }
+        doNotOptimize(sum);
+    });
+
+    // Steady state of the CPU particle backend: the burst is re-emitted once half
+    // of it died, so almost every call is one integrate and compact pass.
+    ParticleSettings particleSettings;
+    for (int particleCount : {4096, 65536})
+    {
+        ParticleSimulation simulation(particleCount);
+        ParticleBurst burst;
+        burst.count = particleCount;
+        runner.run("ParticleSimulation::update/" + std::to_string(particleCount), particleCount, [&]()
+        {
+            if (simulation.getCount() < particleCount / 2)
+            {
+                simulation.clear();
+                burst.seed++;
+                simulation.emit(particleSettings, burst);
+            }
+            simulation.update(particleSettings, 1.0f / 60.0f);
+            doNotOptimize(simulation.getCount());
+        });
+    }
+
+    runner.run("json::parse/config", 1, [&]()
+    {
+        json config = json::parse(configText);
+        doNotOptimize(config.size());
+    });
+
+    if (!jsonOutput.empty())
+    {
+        if (runner.writeJSON(jsonOutput))
+        {
+            std::cout << "Benchmark results written to " << jsonOutput << std::endl;
+        }
+        else
+        {
+            std::cerr << "Failed to write benchmark results to " << jsonOutput << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
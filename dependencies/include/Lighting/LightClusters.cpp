@@ -0,0 +1,242 @@
+#include "LightClusters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+    struct ClusterUniforms
+    {
+        glm::uvec4 grid;   // x, y, z, light count
+        glm::vec4 screen;  // tile width, tile height, slice scale, slice bias
+    };
+
+    bool sphereIntersectsBounds(const glm::vec3& center, float radius, const ClusterBounds& bounds)
+    {
+        glm::vec3 closest = glm::clamp(center, bounds.min, bounds.max);
+        glm::vec3 offset = center - closest;
+        return glm::dot(offset, offset) <= radius * radius;
+    }
+}
+
+LightClusters::LightClusters(int maxLights, int maxLightIndices)
+    : maxLights(maxLights), maxLightIndices(maxLightIndices)
+{
+    GLint alignment = 0;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    if (alignment > 0)
+    {
+        storageAlignment = alignment;
+    }
+
+    clusterRanges.resize(CLUSTER_COUNT);
+    lights.reserve(maxLights);
+    lightIndices.reserve(maxLightIndices);
+}
+
+void LightClusters::buildClusterBounds(float fovY, float aspect, float nearPlane, float farPlane)
+{
+    boundsFovY = fovY;
+    boundsAspect = aspect;
+    this->nearPlane = nearPlane;
+    this->farPlane = farPlane;
+    logDepthRatio = std::log(farPlane / nearPlane);
+
+    tanHalfFovY = std::tan(fovY * 0.5f);
+    tanHalfFovX = tanHalfFovY * aspect;
+
+    sliceDepths.resize(GRID_Z + 1);
+    for (int z = 0; z <= GRID_Z; ++z)
+    {
+        sliceDepths[z] = nearPlane * std::pow(farPlane / nearPlane, (float)z / GRID_Z);
+    }
+
+    clusterBounds.resize(CLUSTER_COUNT);
+    for (int z = 0; z < GRID_Z; ++z)
+    {
+        float sliceNear = sliceDepths[z];
+        float sliceFar = sliceDepths[z + 1];
+
+        for (int y = 0; y < GRID_Y; ++y)
+        {
+            float bottom = -1.0f + 2.0f * y / GRID_Y;
+            float top = -1.0f + 2.0f * (y + 1) / GRID_Y;
+
+            for (int x = 0; x < GRID_X; ++x)
+            {
+                float left = -1.0f + 2.0f * x / GRID_X;
+                float right = -1.0f + 2.0f * (x + 1) / GRID_X;
+
+                // The tile widens with depth, so the extremes are at either the near or far slice plane.
+                ClusterBounds& bounds = clusterBounds[x + GRID_X * (y + GRID_Y * z)];
+                bounds.min = glm::vec3(std::min(left * tanHalfFovX * sliceNear, left * tanHalfFovX * sliceFar),
+                                       std::min(bottom * tanHalfFovY * sliceNear, bottom * tanHalfFovY * sliceFar),
+                                       -sliceFar);
+                bounds.max = glm::vec3(std::max(right * tanHalfFovX * sliceNear, right * tanHalfFovX * sliceFar),
+                                       std::max(top * tanHalfFovY * sliceNear, top * tanHalfFovY * sliceFar),
+                                       -sliceNear);
+            }
+        }
+    }
+}
+
+int LightClusters::getSlice(float depth) const
+{
+    int slice = (int)(std::log(depth / nearPlane) / logDepthRatio * GRID_Z);
+    return std::clamp(slice, 0, GRID_Z - 1);
+}
+
+void LightClusters::getTileRange(float minimum, float maximum, float nearDepth, float farDepth, float tanHalfFov,
+                                 int tiles, int& first, int& last)
+{
+    // Projected extents are monotonic in depth, so the widest span is at one of the two depths.
+    float nearScale = 1.0f / (nearDepth * tanHalfFov);
+    float farScale = 1.0f / (farDepth * tanHalfFov);
+    float low = std::min(minimum * nearScale, minimum * farScale);
+    float high = std::max(maximum * nearScale, maximum * farScale);
+
+    first = std::clamp((int)std::floor((low + 1.0f) * 0.5f * tiles), 0, tiles - 1);
+    last = std::clamp((int)std::floor((high + 1.0f) * 0.5f * tiles), 0, tiles - 1);
+}
+
+void LightClusters::build(const std::vector<PointLight>& lights, const glm::mat4& view,
+                          float fovY, float aspect, float nearPlane, float farPlane)
+{
+    if (fovY != boundsFovY || aspect != boundsAspect || nearPlane != this->nearPlane || farPlane != this->farPlane)
+    {
+        buildClusterBounds(fovY, aspect, nearPlane, farPlane);
+    }
+
+    size_t lightCount = std::min(lights.size(), (size_t)maxLights);
+    this->lights.assign(lights.begin(), lights.begin() + lightCount);
+
+    // First pass: collect (cluster, light) pairs and count lights per cluster.
+    hits.clear();
+    for (glm::uvec2& range : clusterRanges)
+    {
+        range = glm::uvec2(0);
+    }
+
+    for (size_t i = 0; i < lightCount; ++i)
+    {
+        const PointLight& light = lights[i];
+        glm::vec3 center = glm::vec3(view * glm::vec4(light.position, 1.0f));
+        float depth = -center.z;
+
+        if (depth + light.radius < nearPlane || depth - light.radius > farPlane)
+        {
+            continue;
+        }
+
+        int firstSlice = getSlice(std::max(depth - light.radius, nearPlane));
+        int lastSlice = getSlice(std::min(depth + light.radius, farPlane));
+
+        for (int z = firstSlice; z <= lastSlice; ++z)
+        {
+            float nearDepth = std::max(sliceDepths[z], depth - light.radius);
+            float farDepth = std::min(sliceDepths[z + 1], depth + light.radius);
+
+            int firstX, lastX, firstY, lastY;
+            getTileRange(center.x - light.radius, center.x + light.radius, nearDepth, farDepth, tanHalfFovX,
+                         GRID_X, firstX, lastX);
+            getTileRange(center.y - light.radius, center.y + light.radius, nearDepth, farDepth, tanHalfFovY,
+                         GRID_Y, firstY, lastY);
+
+            for (int y = firstY; y <= lastY; ++y)
+            {
+                for (int x = firstX; x <= lastX; ++x)
+                {
+                    int cluster = x + GRID_X * (y + GRID_Y * z);
+                    if (sphereIntersectsBounds(center, light.radius, clusterBounds[cluster]))
+                    {
+                        hits.push_back(glm::uvec2(cluster, i));
+                        clusterRanges[cluster].y++;
+                    }
+                }
+            }
+        }
+    }
+
+    // Second pass: turn the counts into offsets and scatter the light indices.
+    GLuint offset = 0;
+    for (glm::uvec2& range : clusterRanges)
+    {
+        GLuint available = (GLuint)maxLightIndices - offset;
+        if (range.y > available)
+        {
+            if (!indicesOverflowReported)
+            {
+                std::cerr << "Light index list full (" << maxLightIndices << " entries), dropping lights" << std::endl;
+                indicesOverflowReported = true;
+            }
+            range.y = available;
+        }
+
+        range.x = offset;
+        offset += range.y;
+    }
+
+    lightIndices.resize(offset);
+    std::vector<GLuint> cursor(CLUSTER_COUNT, 0);
+    for (const glm::uvec2& hit : hits)
+    {
+        const glm::uvec2& range = clusterRanges[hit.x];
+        GLuint& written = cursor[hit.x];
+        if (written < range.y)
+        {
+            lightIndices[range.x + written] = hit.y;
+            written++;
+        }
+    }
+}
+
+void LightClusters::bindStorage(RingBuffer& ring, CommandBuffer& commands, GLuint binding, const void* data,
+                                GLsizeiptr size)
+{
+    // Empty ranges cannot be bound, so an empty list still reserves a few bytes.
+    RingAllocation allocation = size > 0 ? ring.upload(data, size, storageAlignment)
+                                         : ring.allocate(16, storageAlignment);
+    if (allocation.valid())
+    {
+        commands.bindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, allocation.buffer, allocation.offset,
+                                 allocation.size);
+    }
+}
+
+void LightClusters::upload(RingBuffer& ring, int framebufferWidth, int framebufferHeight, CommandBuffer& commands)
+{
+    ClusterUniforms uniforms;
+    uniforms.grid = glm::uvec4(GRID_X, GRID_Y, GRID_Z, (GLuint)lights.size());
+    uniforms.screen = glm::vec4((float)framebufferWidth / GRID_X,
+                                (float)framebufferHeight / GRID_Y,
+                                GRID_Z / logDepthRatio,
+                                -GRID_Z * std::log(nearPlane) / logDepthRatio);
+
+    RingAllocation uniformAllocation = ring.upload(&uniforms, sizeof(ClusterUniforms), ring.getUniformAlignment());
+    if (uniformAllocation.valid())
+    {
+        commands.bindBufferRange(GL_UNIFORM_BUFFER, UNIFORM_BINDING, uniformAllocation.buffer,
+                                 uniformAllocation.offset, sizeof(ClusterUniforms));
+    }
+
+    bindStorage(ring, commands, LIGHTS_BINDING, lights.data(), lights.size() * sizeof(PointLight));
+    bindStorage(ring, commands, RANGES_BINDING, clusterRanges.data(), clusterRanges.size() * sizeof(glm::uvec2));
+    bindStorage(ring, commands, INDICES_BINDING, lightIndices.data(), lightIndices.size() * sizeof(GLuint));
+}
+
+GLsizeiptr LightClusters::getMaxUploadSize() const
+{
+    GLsizeiptr size = sizeof(ClusterUniforms) + maxLights * sizeof(PointLight) +
+        CLUSTER_COUNT * sizeof(glm::uvec2) + maxLightIndices * sizeof(GLuint);
+    return size + 4 * std::max(storageAlignment, (GLsizeiptr)256);
+}
+
+void LightClusters::bindUniformBlock(GLuint program)
+{
+    GLuint blockIndex = glGetUniformBlockIndex(program, "ClusterData");
+    if (blockIndex != GL_INVALID_INDEX)
+    {
+        glUniformBlockBinding(program, blockIndex, UNIFORM_BINDING);
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm/glm.hpp>
+#include <Rendering/CommandBuffer.h>
+#include <Rendering/RingBuffer.h>
+
+// Matches the std430 layout of PointLight in the fragment shader.
+struct PointLight
+{
+    glm::vec3 position = glm::vec3(0.0f);
+    float radius = 1.0f;
+    glm::vec3 color = glm::vec3(1.0f);
+    float intensity = 1.0f;
+};
+
+// View-space bounds of one cluster.
+struct ClusterBounds
+{
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+// Clustered forward lighting. The view frustum is split into screen tiles and
+// exponentially spaced depth slices; each frame every light is tested only against
+// the clusters its bounding sphere can reach, producing a compact light index list
+// per cluster. The fragment shader finds its cluster from gl_FragCoord and shades
+// just the lights in that list, so the cost per fragment follows the local light
+// density instead of the total light count.
+//
+// Lights, cluster ranges and indices are streamed into shader storage buffers
+// through the frame ring; the grid parameters go into the ClusterData uniform block.
+class LightClusters
+{
+public:
+    static constexpr int GRID_X = 16;
+    static constexpr int GRID_Y = 9;
+    static constexpr int GRID_Z = 24;
+    static constexpr int CLUSTER_COUNT = GRID_X * GRID_Y * GRID_Z;
+
+    static constexpr GLuint UNIFORM_BINDING = 1;
+    static constexpr GLuint LIGHTS_BINDING = 0;
+    static constexpr GLuint RANGES_BINDING = 1;
+    static constexpr GLuint INDICES_BINDING = 2;
+
+    LightClusters(int maxLights, int maxLightIndices);
+
+    // Rebuilds the per-cluster light lists. Lights are given in world space; the
+    // cluster grid is rebuilt only when the projection changes.
+    void build(const std::vector<PointLight>& lights, const glm::mat4& view,
+               float fovY, float aspect, float nearPlane, float farPlane);
+
+    // Streams the result of the last build into the ring and records binding it for drawing.
+    void upload(RingBuffer& ring, int framebufferWidth, int framebufferHeight, CommandBuffer& commands);
+
+    // Largest ring allocation upload() can need in one frame.
+    GLsizeiptr getMaxUploadSize() const;
+
+    static void bindUniformBlock(GLuint program);
+
+    int getLightCount() const { return (int)lights.size(); }
+    int getIndexCount() const { return (int)lightIndices.size(); }
+
+private:
+    void buildClusterBounds(float fovY, float aspect, float nearPlane, float farPlane);
+    int getSlice(float depth) const;
+    // Conservative tile range covered by [minimum, maximum] at view depths between nearDepth and farDepth.
+    static void getTileRange(float minimum, float maximum, float nearDepth, float farDepth, float tanHalfFov,
+                             int tiles, int& first, int& last);
+    void bindStorage(RingBuffer& ring, CommandBuffer& commands, GLuint binding, const void* data, GLsizeiptr size);
+
+    int maxLights;
+    int maxLightIndices;
+    GLsizeiptr storageAlignment = 256;
+    bool indicesOverflowReported = false;
+
+    float boundsFovY = 0.0f;
+    float boundsAspect = 0.0f;
+    float nearPlane = 0.0f;
+    float farPlane = 0.0f;
+    float logDepthRatio = 1.0f;
+    float tanHalfFovX = 1.0f;
+    float tanHalfFovY = 1.0f;
+
+    std::vector<ClusterBounds> clusterBounds;
+    std::vector<float> sliceDepths;
+    std::vector<PointLight> lights;
+    std::vector<glm::uvec2> clusterRanges;
+    std::vector<GLuint> lightIndices;
+    std::vector<glm::uvec2> hits;
+};
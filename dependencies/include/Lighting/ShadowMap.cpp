@@ -0,0 +1,258 @@
+#include "ShadowMap.h"
+
+#include <glm/glm/gtc/matrix_transform.hpp>
+
+namespace
+{
+    struct ShadowUniforms
+    {
+        glm::mat4 lightViewProjection;
+        glm::vec4 lightPosition;  // xyz, far plane
+        glm::ivec4 params;        // type
+        glm::vec4 bias;           // depth bias, normal bias, strength
+    };
+
+    // Face order and up vectors follow the GL cube map convention.
+    const glm::vec3 CUBE_DIRECTIONS[6] = {
+        glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+        glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+        glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f)
+    };
+    const glm::vec3 CUBE_UPS[6] = {
+        glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+        glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f),
+        glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)
+    };
+}
+
+ShadowMap::ShadowMap(Shader* depthShader)
+    : depthShader(depthShader)
+{
+    modelLoc = glGetUniformLocation(depthShader->ID, "model");
+    lightViewProjectionLoc = glGetUniformLocation(depthShader->ID, "lightViewProjection");
+    lightPositionLoc = glGetUniformLocation(depthShader->ID, "lightPosition");
+    farPlaneLoc = glGetUniformLocation(depthShader->ID, "farPlane");
+    linearDepthLoc = glGetUniformLocation(depthShader->ID, "linearDepth");
+
+    // Depth only: no color is drawn or read.
+    GLint boundFramebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &boundFramebuffer);
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    glBindFramebuffer(GL_FRAMEBUFFER, boundFramebuffer);
+}
+
+ShadowMap::~ShadowMap()
+{
+    destroyTextures();
+    glDeleteFramebuffers(1, &framebuffer);
+}
+
+void ShadowMap::createTextures()
+{
+    GLenum target = settings.type == ShadowType::Point ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+    glGenTextures(2, textures);
+
+    for (GLuint texture : textures)
+    {
+        glBindTexture(target, texture);
+
+        if (target == GL_TEXTURE_CUBE_MAP)
+        {
+            for (int face = 0; face < 6; ++face)
+            {
+                glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_DEPTH_COMPONENT24,
+                             settings.resolution, settings.resolution, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+            }
+            glTexParameteri(target, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+            glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        }
+        else
+        {
+            glTexImage2D(target, 0, GL_DEPTH_COMPONENT24, settings.resolution, settings.resolution, 0,
+                         GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+
+            // Outside the map nothing is in shadow.
+            float border[] = {1.0f, 1.0f, 1.0f, 1.0f};
+            glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+            glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+            glTexParameterfv(target, GL_TEXTURE_BORDER_COLOR, border);
+        }
+
+        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(target, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glTexParameteri(target, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    }
+
+    glBindTexture(target, 0);
+    dynamicEmpty = false;
+}
+
+void ShadowMap::destroyTextures()
+{
+    if (textures[0])
+    {
+        glDeleteTextures(2, textures);
+        textures[0] = textures[1] = 0;
+    }
+}
+
+bool ShadowMap::update(const ShadowSettings& settings, unsigned int staticVersion)
+{
+    if (settings == this->settings && staticVersion == this->staticVersion)
+    {
+        return isEnabled() && !staticValid;
+    }
+
+    bool reallocate = settings.type != this->settings.type || settings.resolution != this->settings.resolution;
+    this->settings = settings;
+    this->staticVersion = staticVersion;
+    staticValid = false;
+
+    if (reallocate)
+    {
+        destroyTextures();
+        if (isEnabled())
+        {
+            createTextures();
+        }
+    }
+
+    return isEnabled();
+}
+
+int ShadowMap::getPassCount() const
+{
+    return settings.type == ShadowType::Point ? 6 : 1;
+}
+
+glm::mat4 ShadowMap::getLightViewProjection(int pass) const
+{
+    if (settings.type == ShadowType::Point)
+    {
+        glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, settings.farPlane);
+        glm::vec3 eye = settings.lightPosition;
+        return projection * glm::lookAt(eye, eye + CUBE_DIRECTIONS[pass], CUBE_UPS[pass]);
+    }
+
+    glm::vec3 direction = glm::normalize(settings.lightDirection);
+    glm::vec3 up = fabs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    glm::vec3 eye = settings.center - direction * settings.extent * 2.0f;
+
+    glm::mat4 projection = glm::ortho(-settings.extent, settings.extent, -settings.extent, settings.extent,
+                                      0.1f, settings.extent * 4.0f);
+    return projection * glm::lookAt(eye, settings.center, up);
+}
+
+void ShadowMap::bindPass(Layer layer, int pass, CommandBuffer& commands)
+{
+    if (layer == STATIC_LAYER && pass == 0)
+    {
+        staticValid = true;
+        staticRebuilds++;
+    }
+    if (layer == DYNAMIC_LAYER)
+    {
+        dynamicEmpty = false;
+    }
+
+    if (pass == 0)
+    {
+        commands.bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        commands.viewport(0, 0, settings.resolution, settings.resolution);
+        commands.enable(GL_POLYGON_OFFSET_FILL);
+        commands.polygonOffset(2.0f, 4.0f);
+    }
+
+    GLenum attachment = settings.type == ShadowType::Point ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + pass : GL_TEXTURE_2D;
+    commands.framebufferTexture(GL_DEPTH_ATTACHMENT, attachment, textures[layer], 0);
+    commands.clear(GL_DEPTH_BUFFER_BIT, glm::vec4(0.0f));
+}
+
+void ShadowMap::beginPass(Layer layer, int pass, CommandBuffer& commands)
+{
+    bindPass(layer, pass, commands);
+
+    commands.useProgram(depthShader->ID);
+    commands.setUniform(lightPositionLoc, settings.lightPosition);
+    commands.setUniform(farPlaneLoc, settings.farPlane);
+    commands.setUniform(linearDepthLoc, (int)(settings.type == ShadowType::Point));
+    commands.setUniform(lightViewProjectionLoc, getLightViewProjection(pass));
+}
+
+void ShadowMap::drawCaster(CommandBuffer& commands, const glm::mat4& model, GLuint VAO, GLsizei vertexCount)
+{
+    commands.setUniform(modelLoc, model);
+    commands.bindVertexArray(VAO);
+    commands.drawArrays(GL_TRIANGLES, 0, vertexCount);
+}
+
+void ShadowMap::endPasses(CommandBuffer& commands, GLuint framebuffer, int width, int height)
+{
+    commands.bindVertexArray(0);
+    commands.disable(GL_POLYGON_OFFSET_FILL);
+    commands.bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    commands.viewport(0, 0, width, height);
+}
+
+void ShadowMap::clearDynamicLayer(CommandBuffer& commands, GLuint framebuffer, int width, int height)
+{
+    if (dynamicEmpty)
+    {
+        return;
+    }
+
+    for (int pass = 0; pass < getPassCount(); ++pass)
+    {
+        bindPass(DYNAMIC_LAYER, pass, commands);
+    }
+    endPasses(commands, framebuffer, width, height);
+    dynamicEmpty = true;
+}
+
+void ShadowMap::upload(RingBuffer& ring, CommandBuffer& commands)
+{
+    ShadowUniforms uniforms;
+    uniforms.lightViewProjection = isEnabled() ? getLightViewProjection(0) : glm::mat4(1.0f);
+    uniforms.lightPosition = glm::vec4(settings.lightPosition, settings.farPlane);
+    uniforms.params = glm::ivec4((int)settings.type, 0, 0, 0);
+    uniforms.bias = glm::vec4(0.002f, 0.05f, settings.strength, 0.0f);
+
+    RingAllocation allocation = ring.upload(&uniforms, sizeof(ShadowUniforms), ring.getUniformAlignment());
+    if (allocation.valid())
+    {
+        commands.bindBufferRange(GL_UNIFORM_BUFFER, UNIFORM_BINDING, allocation.buffer, allocation.offset,
+                                 sizeof(ShadowUniforms));
+    }
+
+    if (!isEnabled())
+    {
+        return;
+    }
+
+    GLint unit = settings.type == ShadowType::Point ? POINT_TEXTURE_UNIT : DIRECTIONAL_TEXTURE_UNIT;
+    GLenum target = settings.type == ShadowType::Point ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+    for (int layer = 0; layer < 2; ++layer)
+    {
+        commands.bindTexture(unit + layer, target, textures[layer]);
+    }
+}
+
+void ShadowMap::bindProgram(GLuint program)
+{
+    GLuint blockIndex = glGetUniformBlockIndex(program, "ShadowData");
+    if (blockIndex != GL_INVALID_INDEX)
+    {
+        glUniformBlockBinding(program, blockIndex, UNIFORM_BINDING);
+    }
+
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "staticShadowMap"), DIRECTIONAL_TEXTURE_UNIT);
+    glUniform1i(glGetUniformLocation(program, "dynamicShadowMap"), DIRECTIONAL_TEXTURE_UNIT + 1);
+    glUniform1i(glGetUniformLocation(program, "staticShadowCube"), POINT_TEXTURE_UNIT);
+    glUniform1i(glGetUniformLocation(program, "dynamicShadowCube"), POINT_TEXTURE_UNIT + 1);
+}
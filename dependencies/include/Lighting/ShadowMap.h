@@ -0,0 +1,106 @@
+#pragma once
+
+#include <glm/glm/glm.hpp>
+#include <shader/Shader.h>
+#include <Rendering/CommandBuffer.h>
+#include <Rendering/RingBuffer.h>
+
+enum class ShadowType
+{
+    None,
+    Directional,
+    Point
+};
+
+// Everything the shadow layers depend on besides the casters themselves. Any
+// change invalidates the cached static layer.
+struct ShadowSettings
+{
+    ShadowType type = ShadowType::None;
+    glm::vec3 lightPosition = glm::vec3(0.0f);
+    glm::vec3 lightDirection = glm::vec3(0.0f, -1.0f, 0.0f);
+    glm::vec3 center = glm::vec3(0.0f);
+    float extent = 20.0f;
+    float farPlane = 50.0f;
+    int resolution = 2048;
+    float strength = 0.6f;
+
+    bool operator==(const ShadowSettings& other) const = default;
+};
+
+// Shadow mapping split into two depth layers. Static casters are rendered once
+// into a cached layer that is only redrawn when the settings or the static
+// version change; dynamic casters go into a second layer that is redrawn every
+// frame. Receivers sample both layers and keep the darker result, so moving a
+// ball never costs a re-render of the hoop and floor.
+//
+// Directional lights use one orthographic map over a fixed region of the scene
+// (fitting it to the camera would invalidate the cache on every camera move);
+// point lights use cube maps storing the distance to the light.
+class ShadowMap
+{
+public:
+    static constexpr GLuint UNIFORM_BINDING = 2;
+    static constexpr GLint DIRECTIONAL_TEXTURE_UNIT = 2;
+    static constexpr GLint POINT_TEXTURE_UNIT = 4;
+
+    enum Layer
+    {
+        STATIC_LAYER,
+        DYNAMIC_LAYER
+    };
+
+    explicit ShadowMap(Shader* depthShader);
+    ~ShadowMap();
+
+    ShadowMap(const ShadowMap&) = delete;
+    ShadowMap& operator=(const ShadowMap&) = delete;
+
+    // Applies the settings for this frame. Returns true when the static layer is
+    // stale and its casters must be drawn again.
+    bool update(const ShadowSettings& settings, unsigned int staticVersion);
+
+    // A layer is drawn in getPassCount() passes (one per cube face for point
+    // lights); casters are drawn with drawCaster between beginPass and endPasses.
+    // beginPass records binding and clearing the face, endPasses binding
+    // framebuffer back with a width x height viewport.
+    int getPassCount() const;
+    void beginPass(Layer layer, int pass, CommandBuffer& commands);
+    void drawCaster(CommandBuffer& commands, const glm::mat4& model, GLuint VAO, GLsizei vertexCount);
+    void endPasses(CommandBuffer& commands, GLuint framebuffer, int width, int height);
+
+    // Records clearing the dynamic layer, and marks it as holding no casters,
+    // skipping its clear next time.
+    void clearDynamicLayer(CommandBuffer& commands, GLuint framebuffer, int width, int height);
+
+    // Records binding the layers, and streams the ShadowData uniform block for the receivers.
+    void upload(RingBuffer& ring, CommandBuffer& commands);
+
+    // Points the receiver's samplers and uniform block at the shadow bindings.
+    static void bindProgram(GLuint program);
+
+    bool isEnabled() const { return settings.type != ShadowType::None; }
+    long long getStaticRebuilds() const { return staticRebuilds; }
+
+private:
+    void createTextures();
+    void destroyTextures();
+    void bindPass(Layer layer, int pass, CommandBuffer& commands);
+    glm::mat4 getLightViewProjection(int pass) const;
+
+    Shader* depthShader;
+    GLint modelLoc = -1;
+    GLint lightViewProjectionLoc = -1;
+    GLint lightPositionLoc = -1;
+    GLint farPlaneLoc = -1;
+    GLint linearDepthLoc = -1;
+
+    ShadowSettings settings;
+    unsigned int staticVersion = 0;
+    bool staticValid = false;
+    bool dynamicEmpty = true;
+    long long staticRebuilds = 0;
+
+    GLuint framebuffer = 0;
+    GLuint textures[2] = {0, 0};
+};
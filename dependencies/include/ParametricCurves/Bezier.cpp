@@ -43,6 +43,14 @@ GLuint Bezier::generateCurve(int pointsPerSegment)
 }
 
 GLuint Bezier::generateQuadraticCurve(int pointsPerSegment)
+{
+    evaluateQuadraticCurve(pointsPerSegment);
+
+    GLuint VAO = generateBuffers();
+    return VAO;
+}
+
+void Bezier::evaluateQuadraticCurve(int pointsPerSegment)
 {
     curvePoints.clear();
 
@@ -62,28 +70,4 @@ GLuint Bezier::generateQuadraticCurve(int pointsPerSegment)
             curvePoints.push_back(p);
         }
     }
-
-    GLuint VAO = generateBuffers();
-    return VAO;
-}
-
-GLuint Bezier::generateBuffers()
-{
-    GLuint VBO, VAO;
-
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, curvePoints.size() * sizeof(glm::vec3), curvePoints.data(), GL_STATIC_DRAW);
-
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (GLvoid*)0);
-    glEnableVertexAttribArray(0);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-
-    this->VAO = VAO;
-    return VAO;
 }
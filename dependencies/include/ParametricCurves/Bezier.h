@@ -7,6 +7,7 @@ public:
     Bezier();
     GLuint generateCurve(int pointsPerSegment);
     GLuint generateQuadraticCurve(int pointsPerSegment);
-    GLuint generateBuffers();
+    // Only computes the points, without uploading them.
+    void evaluateQuadraticCurve(int pointsPerSegment);
 };
 
@@ -6,6 +6,5 @@ class CatmullRom :
 public:
     CatmullRom();
     GLuint generateCurve(int pointsPerSegment);
-    GLuint generateBuffers();
 };
 
@@ -1,19 +1,52 @@
 #include "Curve.h"
 
+#include <Rendering/VertexArrays.h>
+
 void Curve::setShader(Shader* shader)
 {
 	this->shader = shader;
 	shader->Use();
+	colorLoc = glGetUniformLocation(shader->ID, "finalColor");
 }
 
-void Curve::drawCurve(glm::vec4 color)
+void Curve::drawCurve(CommandBuffer& commands, glm::vec4 color)
 {
-	shader->setVec4("finalColor", color.r, color.g, color.b, color.a);
+	commands.setUniform(colorLoc, color);
 
-	glBindVertexArray(VAO);
+	commands.bindVertexArray(VAO);
 	// Chamada de desenho - drawcall
 	// CONTORNO e PONTOS - GL_LINE_LOOP e GL_POINTS
-	glDrawArrays(GL_LINE_STRIP, 0, curvePoints.size());
+	commands.drawArrays(GL_LINE_STRIP, firstVertex, drawCount);
 	//glDrawArrays(GL_POINTS, 0, curvePoints.size());
-	glBindVertexArray(0);
+	commands.bindVertexArray(0);
+}
+
+GLuint Curve::generateBuffers()
+{
+	if (streamBuffer)
+	{
+		// The VAO always points at the start of the ring; each upload is drawn from its own first vertex.
+		if (VAO == 0)
+		{
+			VAO = createVertexArray(streamBuffer->getBuffer(), sizeof(glm::vec3), {{0, 3, 0}});
+		}
+
+		RingAllocation allocation = streamBuffer->upload(curvePoints.data(), curvePoints.size() * sizeof(glm::vec3),
+		                                                 sizeof(glm::vec3));
+		firstVertex = allocation.valid() ? allocation.offset / sizeof(glm::vec3) : 0;
+		drawCount = allocation.valid() ? curvePoints.size() : 0;
+		return VAO;
+	}
+
+	if (VAO == 0)
+	{
+		VBO = createBuffer();
+		VAO = createVertexArray(VBO, sizeof(glm::vec3), {{0, 3, 0}});
+	}
+
+	uploadBuffer(VBO, curvePoints.data(), curvePoints.size() * sizeof(glm::vec3), GL_STATIC_DRAW);
+
+	firstVertex = 0;
+	drawCount = curvePoints.size();
+	return VAO;
 }
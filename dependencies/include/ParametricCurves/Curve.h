@@ -4,6 +4,8 @@
 #include <glm/glm/gtc/type_ptr.hpp>
 #include <vector>
 #include <shader/Shader.h>
+#include <Rendering/CommandBuffer.h>
+#include <Rendering/RingBuffer.h>
 
 using namespace std;
 
@@ -12,8 +14,13 @@ public:
     Curve() { }
     inline void setControlPoints(vector<glm::vec3> controlPoints) { this->controlPoints = controlPoints; }
     void setShader(Shader* shader);
+    // Curves regenerated every frame stream their points through the ring buffer
+    // instead of owning a VBO.
+    inline void setStreamBuffer(RingBuffer* streamBuffer) { this->streamBuffer = streamBuffer; }
     void generateCurve(int pointsPerSegment);
-    void drawCurve(glm::vec4 color);
+    // Records the draw; the curve shader must be in use.
+    void drawCurve(CommandBuffer& commands, glm::vec4 color);
+    GLuint generateBuffers();
     int getNbCurvePoints() { return curvePoints.size(); }
     glm::vec3 getPointOnCurve(int i) { return curvePoints[i]; }
 
@@ -21,6 +28,11 @@ protected:
     vector<glm::vec3> controlPoints;
     vector<glm::vec3> curvePoints;
     glm::mat4 M;
-    GLuint VAO;
-    Shader* shader;
+    GLuint VAO = 0;
+    GLuint VBO = 0;
+    GLint firstVertex = 0;
+    GLsizei drawCount = 0;
+    Shader* shader = nullptr;
+    GLint colorLoc = -1;
+    RingBuffer* streamBuffer = nullptr;
 };
@@ -11,6 +11,16 @@ Hermite::Hermite()
 
 GLuint Hermite::generateCurve(int pointsPerSegment)
 {
+    evaluateCurve(pointsPerSegment);
+
+    GLuint VAO = generateBuffers();
+    return VAO;
+}
+
+void Hermite::evaluateCurve(int pointsPerSegment)
+{
+    curvePoints.clear();
+
     float step = 1.0 / (float)pointsPerSegment;
 
     float t = 0;
@@ -37,28 +47,4 @@ GLuint Hermite::generateCurve(int pointsPerSegment)
             curvePoints.push_back(p);
         }
     }
-
-    GLuint VAO = generateBuffers();
-    return VAO;
-}
-
-GLuint Hermite::generateBuffers()
-{
-    GLuint VBO, VAO;
-
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, curvePoints.size() * sizeof(glm::vec3), curvePoints.data(), GL_STATIC_DRAW);
-
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (GLvoid*)0);
-    glEnableVertexAttribArray(0);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-
-    this->VAO = VAO;
-    return VAO;
 }
@@ -5,5 +5,6 @@ class Hermite : public Curve
 public:
     Hermite();
     GLuint generateCurve(int pointsPerSegment);
-    GLuint generateBuffers();
+    // Only computes the points, without uploading them.
+    void evaluateCurve(int pointsPerSegment);
 };
@@ -0,0 +1,158 @@
+#include "CPUProfiler.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+const size_t CHUNK_EVENTS = 1 << 14;
+// Caps a thread at about four million events; later ones are counted as dropped.
+const size_t MAX_CHUNKS = 256;
+
+struct ThreadBuffer
+{
+    int id = 0;
+    std::atomic<const char*> name{nullptr};
+    std::atomic<CPUProfiler::Event*> chunks[MAX_CHUNKS] = {};
+    std::atomic<size_t> count{0};
+    std::atomic<size_t> dropped{0};
+
+    ~ThreadBuffer()
+    {
+        for (std::atomic<CPUProfiler::Event*>& chunk : chunks)
+        {
+            delete[] chunk.load();
+        }
+    }
+};
+
+// Buffers stay registered after their thread exits, so its events still make it into the trace.
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> registry;
+const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+ThreadBuffer& getThreadBuffer()
+{
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer)
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.push_back(std::make_unique<ThreadBuffer>());
+        buffer = registry.back().get();
+        buffer->id = (int)registry.size();
+    }
+    return *buffer;
+}
+
+void writeEscaped(std::ostream& out, const char* text)
+{
+    for (; *text; ++text)
+    {
+        if (*text == '"' || *text == '\\')
+        {
+            out << '\\';
+        }
+        out << *text;
+    }
+}
+}
+
+int64_t CPUProfiler::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void CPUProfiler::record(const char* name, int64_t start, int64_t end)
+{
+    ThreadBuffer& buffer = getThreadBuffer();
+    size_t index = buffer.count.load(std::memory_order_relaxed);
+    size_t chunk = index / CHUNK_EVENTS;
+    if (chunk >= MAX_CHUNKS)
+    {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Event* events = buffer.chunks[chunk].load(std::memory_order_relaxed);
+    if (!events)
+    {
+        events = new Event[CHUNK_EVENTS];
+        buffer.chunks[chunk].store(events, std::memory_order_release);
+    }
+
+    events[index % CHUNK_EVENTS] = {name, start, end - start};
+    buffer.count.store(index + 1, std::memory_order_release);
+}
+
+void CPUProfiler::setThreadName(const char* name)
+{
+    getThreadBuffer().name.store(name, std::memory_order_release);
+}
+
+bool CPUProfiler::writeChromeTrace(const std::string& path)
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+
+    std::vector<ThreadBuffer*> buffers;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const std::unique_ptr<ThreadBuffer>& buffer : registry)
+        {
+            buffers.push_back(buffer.get());
+        }
+    }
+
+    // Timestamps are in microseconds; three decimals keep the nanoseconds.
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    bool first = true;
+    size_t eventCount = 0;
+    size_t droppedCount = 0;
+    for (ThreadBuffer* buffer : buffers)
+    {
+        const char* threadName = buffer->name.load(std::memory_order_acquire);
+        if (threadName)
+        {
+            file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id
+                << ",\"args\":{\"name\":\"";
+            writeEscaped(file, threadName);
+            file << "\"}}";
+            first = false;
+        }
+
+        size_t count = buffer->count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Event& event = buffer->chunks[i / CHUNK_EVENTS].load(std::memory_order_acquire)[i % CHUNK_EVENTS];
+            file << (first ? "" : ",") << "\n{\"name\":\"";
+            writeEscaped(file, event.name);
+            file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id << ",\"ts\":" << event.start / 1000.0
+                << ",\"dur\":" << event.duration / 1000.0 << "}";
+            first = false;
+        }
+
+        eventCount += count;
+        droppedCount += buffer->dropped.load(std::memory_order_relaxed);
+    }
+
+    file << "\n]}\n";
+
+    std::cout << "Trace: " << eventCount << " events written to " << path;
+    if (droppedCount > 0)
+    {
+        std::cout << " (" << droppedCount << " dropped)";
+    }
+    std::cout << std::endl;
+    return true;
+}
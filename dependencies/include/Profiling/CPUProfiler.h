@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// PROFILE_SCOPE records the enclosing scope when built with ENABLE_PROFILING
+// (every configuration but Release); otherwise it compiles to nothing.
+#ifdef ENABLE_PROFILING
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_THREAD_NAME(name) CPUProfiler::setThreadName(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_THREAD_NAME(name) ((void)0)
+#endif
+
+// Named CPU intervals from every thread, exported as a Chrome trace for
+// chrome://tracing or ui.perfetto.dev. Each thread appends to its own buffer, so
+// recording never takes a lock: the buffer is registered once per thread, after
+// which an event is written in place and published with a release store of the
+// count. Buffers grow in fixed chunks and are never moved, so the trace can be
+// written while other threads keep recording.
+//
+// Event names are stored as pointers and must outlive the profiler; pass string literals.
+class CPUProfiler
+{
+public:
+    struct Event
+    {
+        const char* name;
+        // Nanoseconds since the profiler started.
+        int64_t start;
+        int64_t duration;
+    };
+
+    static constexpr bool isEnabled()
+    {
+#ifdef ENABLE_PROFILING
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static int64_t now();
+    static void record(const char* name, int64_t start, int64_t end);
+    static void setThreadName(const char* name);
+    static bool writeChromeTrace(const std::string& path);
+};
+
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* name) : name(name), start(CPUProfiler::now()) {}
+    ~ProfileScope() { CPUProfiler::record(name, start, CPUProfiler::now()); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;
+    int64_t start;
+};
@@ -0,0 +1,647 @@
+#include "CommandBackend.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+
+void CommandBackend::count(const CommandBuffer& commands, const Command& command, RenderStats& stats)
+{
+    switch (command.type)
+    {
+    case CommandType::UseProgram:
+    case CommandType::BindVertexArray:
+    case CommandType::BindTexture:
+    case CommandType::BindSampler:
+    case CommandType::BindFramebuffer:
+        stats.stateChanges++;
+        break;
+    case CommandType::DrawArrays:
+        stats.countDraw(command.mode, command.count);
+        break;
+    case CommandType::DrawArraysInstanced:
+        stats.countInstancedDraw(RenderStats::getTriangleCount(command.mode, command.count),
+                                 commands.getInts(command)[0]);
+        break;
+    // The vertex counts stay on the GPU.
+    case CommandType::DrawArraysIndirect:
+    case CommandType::DrawTransformFeedback:
+        stats.countDraw(command.mode, 0);
+        break;
+    case CommandType::MultiDrawArrays:
+    {
+        const GLint* counts = commands.getInts(command) + command.count;
+        stats.countDraw(command.mode, std::max(std::accumulate(counts, counts + command.count, 0), 0));
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void GLCommandBackend::submit(const CommandBuffer& commands, size_t first, RenderStats& stats)
+{
+    GLint activeUnit = -1;
+    for (size_t i = first; i < commands.size(); ++i)
+    {
+        const Command& command = commands[i];
+        switch (command.type)
+        {
+        case CommandType::Clear:
+        {
+            const float* color = commands.getFloats(command);
+            glClearColor(color[0], color[1], color[2], color[3]);
+            glClear(command.mode);
+            break;
+        }
+        case CommandType::UseProgram:
+            glUseProgram(command.object);
+            break;
+        case CommandType::BindVertexArray:
+            glBindVertexArray(command.object);
+            break;
+        case CommandType::BindTexture:
+            if (activeUnit != command.location)
+            {
+                activeUnit = command.location;
+                glActiveTexture(GL_TEXTURE0 + command.location);
+            }
+            glBindTexture(command.mode, command.object);
+            break;
+        case CommandType::BindSampler:
+            glBindSampler(command.location, command.object);
+            break;
+        case CommandType::UniformInt:
+            glUniform1i(command.location, command.first);
+            break;
+        case CommandType::UniformFloat:
+            glUniform1fv(command.location, 1, commands.getFloats(command));
+            break;
+        case CommandType::UniformVec3:
+            glUniform3fv(command.location, 1, commands.getFloats(command));
+            break;
+        case CommandType::UniformVec4:
+            glUniform4fv(command.location, 1, commands.getFloats(command));
+            break;
+        case CommandType::UniformMat3:
+            glUniformMatrix3fv(command.location, 1, GL_FALSE, commands.getFloats(command));
+            break;
+        case CommandType::UniformMat4:
+            glUniformMatrix4fv(command.location, 1, GL_FALSE, commands.getFloats(command));
+            break;
+        case CommandType::DrawArrays:
+            glDrawArrays(command.mode, command.first, command.count);
+            break;
+        case CommandType::MultiDrawArrays:
+        {
+            const GLint* firsts = commands.getInts(command);
+            glMultiDrawArrays(command.mode, firsts, firsts + command.count, command.count);
+            break;
+        }
+        case CommandType::Enable:
+            glEnable(command.mode);
+            break;
+        case CommandType::Disable:
+            glDisable(command.mode);
+            break;
+        case CommandType::ColorMask:
+            glColorMask(command.first & 1, (command.first >> 1) & 1, (command.first >> 2) & 1,
+                        (command.first >> 3) & 1);
+            break;
+        case CommandType::DepthMask:
+            glDepthMask(command.first != 0);
+            break;
+        case CommandType::DepthFunc:
+            glDepthFunc(command.mode);
+            break;
+        case CommandType::StencilFunc:
+            glStencilFunc(command.mode, command.first, command.object);
+            break;
+        case CommandType::StencilOp:
+        {
+            const GLint* ops = commands.getInts(command);
+            glStencilOp(ops[0], ops[1], ops[2]);
+            break;
+        }
+        case CommandType::BlendFunc:
+            glBlendFunc(command.mode, command.first);
+            break;
+        case CommandType::LineWidth:
+            glLineWidth(commands.getFloats(command)[0]);
+            break;
+        case CommandType::PointSize:
+            glPointSize(commands.getFloats(command)[0]);
+            break;
+        case CommandType::PolygonOffset:
+        {
+            const float* values = commands.getFloats(command);
+            glPolygonOffset(values[0], values[1]);
+            break;
+        }
+        case CommandType::BindBufferRange:
+            if (command.count == 0)
+            {
+                glBindBufferBase(command.mode, command.location, command.object);
+            }
+            else
+            {
+                glBindBufferRange(command.mode, command.location, command.object, command.first, command.count);
+            }
+            break;
+        case CommandType::BindVertexBuffer:
+        {
+            const GLint* values = commands.getInts(command);
+            vertexAttributes.resize(values[1]);
+            for (size_t attribute = 0; attribute < vertexAttributes.size(); ++attribute)
+            {
+                const GLint* fields = values + 2 + 5 * attribute;
+                vertexAttributes[attribute] = {(GLuint)fields[0], fields[1], (GLuint)fields[2], (GLenum)fields[3],
+                                         (GLboolean)fields[4]};
+            }
+            setVertexBuffer(command.object, values[0], command.first, command.count, vertexAttributes.data(),
+                            vertexAttributes.size());
+            break;
+        }
+        case CommandType::BindFramebuffer:
+            glBindFramebuffer(command.mode, command.object);
+            break;
+        case CommandType::FramebufferTexture:
+            glFramebufferTexture2D(GL_FRAMEBUFFER, command.mode, command.first, command.object, command.location);
+            break;
+        case CommandType::Viewport:
+        {
+            const GLint* rectangle = commands.getInts(command);
+            glViewport(rectangle[0], rectangle[1], rectangle[2], rectangle[3]);
+            break;
+        }
+        case CommandType::BlitFramebuffer:
+        {
+            const GLint* rectangles = commands.getInts(command);
+            glBlitFramebuffer(rectangles[0], rectangles[1], rectangles[2], rectangles[3], rectangles[4],
+                              rectangles[5], rectangles[6], rectangles[7], command.mode, command.first);
+            break;
+        }
+        case CommandType::GenerateMipmap:
+            if (activeUnit != command.location)
+            {
+                activeUnit = command.location;
+                glActiveTexture(GL_TEXTURE0 + command.location);
+            }
+            glGenerateMipmap(command.mode);
+            break;
+        case CommandType::UniformVec2:
+            glUniform2fv(command.location, 1, commands.getFloats(command));
+            break;
+        case CommandType::DrawArraysInstanced:
+            glDrawArraysInstanced(command.mode, command.first, command.count, commands.getInts(command)[0]);
+            break;
+        case CommandType::DrawArraysIndirect:
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, command.object);
+            glDrawArraysIndirect(command.mode, (const void*)(uintptr_t)command.first);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+            break;
+        case CommandType::DrawTransformFeedback:
+            glDrawTransformFeedback(command.mode, command.object);
+            break;
+        }
+        count(commands, command, stats);
+    }
+
+    // Textures created outside the commands are bound on unit 0.
+    if (activeUnit > 0)
+    {
+        glActiveTexture(GL_TEXTURE0);
+    }
+}
+
+void NullCommandBackend::submit(const CommandBuffer& commands, size_t first, RenderStats& stats)
+{
+    program = 0;
+    vertexArray = 0;
+    drawFramebuffer = 0;
+    readFramebuffer = 0;
+    std::fill(std::begin(textures), std::end(textures), 0);
+    std::fill(std::begin(samplers), std::end(samplers), 0);
+
+    for (size_t i = first; i < commands.size(); ++i)
+    {
+        const Command& command = commands[i];
+        commandCount++;
+        switch (command.type)
+        {
+        case CommandType::Clear:
+            if (command.mode & ~(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT))
+            {
+                fail(i, command, "unknown buffer bits");
+            }
+            hasFloats(commands, i, command, 4);
+            break;
+        case CommandType::UseProgram:
+            redundantBinds += program == command.object;
+            program = command.object;
+            break;
+        case CommandType::BindVertexArray:
+            redundantBinds += vertexArray == command.object;
+            vertexArray = command.object;
+            break;
+        case CommandType::BindTexture:
+        case CommandType::BindSampler:
+        {
+            if (command.location < 0 || command.location >= TEXTURE_UNITS)
+            {
+                fail(i, command, "texture unit out of range");
+                break;
+            }
+            GLuint& bound = command.type == CommandType::BindTexture ? textures[command.location]
+                                                                     : samplers[command.location];
+            redundantBinds += bound == command.object;
+            bound = command.object;
+            break;
+        }
+        case CommandType::UniformInt:
+            checkUniform(i, command);
+            break;
+        case CommandType::UniformFloat:
+            checkUniform(i, command);
+            hasFloats(commands, i, command, 1);
+            break;
+        case CommandType::UniformVec3:
+            checkUniform(i, command);
+            hasFloats(commands, i, command, 3);
+            break;
+        case CommandType::UniformVec4:
+            checkUniform(i, command);
+            hasFloats(commands, i, command, 4);
+            break;
+        case CommandType::UniformMat3:
+            checkUniform(i, command);
+            hasFloats(commands, i, command, 9);
+            break;
+        case CommandType::UniformMat4:
+            checkUniform(i, command);
+            hasFloats(commands, i, command, 16);
+            break;
+        case CommandType::DrawArrays:
+            checkDraw(i, command);
+            if (command.first < 0 || command.count < 0)
+            {
+                fail(i, command, "negative vertex range");
+            }
+            break;
+        case CommandType::MultiDrawArrays:
+        {
+            checkDraw(i, command);
+            if (command.count < 0 || (size_t)command.data + 2 * (size_t)command.count > commands.getIntCount())
+            {
+                fail(i, command, "ranges outside the buffer");
+                // Counting would read past the ranges.
+                continue;
+            }
+            const GLint* firsts = commands.getInts(command);
+            for (GLsizei range = 0; range < command.count; ++range)
+            {
+                if (firsts[range] < 0 || firsts[command.count + range] < 0)
+                {
+                    fail(i, command, "negative vertex range");
+                    break;
+                }
+            }
+            break;
+        }
+        case CommandType::Enable:
+        case CommandType::Disable:
+            if (!isCapability(command.mode))
+            {
+                fail(i, command, "unknown capability");
+            }
+            break;
+        case CommandType::ColorMask:
+            if (command.first < 0 || command.first > 15)
+            {
+                fail(i, command, "unknown color channels");
+            }
+            break;
+        case CommandType::DepthMask:
+            break;
+        case CommandType::DepthFunc:
+        case CommandType::StencilFunc:
+            if (command.mode < GL_NEVER || command.mode > GL_ALWAYS)
+            {
+                fail(i, command, "unknown comparison function");
+            }
+            break;
+        case CommandType::StencilOp:
+        {
+            if (!hasInts(commands, i, command, 3))
+            {
+                continue;
+            }
+            const GLint* ops = commands.getInts(command);
+            for (int op = 0; op < 3; ++op)
+            {
+                if (!isStencilOp(ops[op]))
+                {
+                    fail(i, command, "unknown stencil operation");
+                    break;
+                }
+            }
+            break;
+        }
+        case CommandType::BlendFunc:
+            if (!isBlendFactor(command.mode) || !isBlendFactor(command.first))
+            {
+                fail(i, command, "unknown blend factor");
+            }
+            break;
+        case CommandType::LineWidth:
+        case CommandType::PointSize:
+            if (hasFloats(commands, i, command, 1) && !(commands.getFloats(command)[0] > 0.0f))
+            {
+                fail(i, command, "size not positive");
+            }
+            break;
+        case CommandType::PolygonOffset:
+            hasFloats(commands, i, command, 2);
+            break;
+        case CommandType::BindBufferRange:
+            if (command.mode != GL_UNIFORM_BUFFER && command.mode != GL_SHADER_STORAGE_BUFFER &&
+                command.mode != GL_TRANSFORM_FEEDBACK_BUFFER)
+            {
+                fail(i, command, "not an indexed buffer target");
+            }
+            if (command.object == 0)
+            {
+                fail(i, command, "no buffer");
+            }
+            if (command.location < 0 || command.first < 0 || command.count < 0)
+            {
+                fail(i, command, "negative index or range");
+            }
+            break;
+        case CommandType::BindVertexBuffer:
+        {
+            if (command.object == 0)
+            {
+                fail(i, command, "no vertex array");
+            }
+            if (command.first < 0 || command.count < 0)
+            {
+                fail(i, command, "negative offset or stride");
+            }
+            if (!hasInts(commands, i, command, 2))
+            {
+                break;
+            }
+            const GLint* values = commands.getInts(command);
+            if (values[0] == 0)
+            {
+                fail(i, command, "no buffer");
+            }
+            if (values[1] < 0)
+            {
+                fail(i, command, "negative attribute count");
+                break;
+            }
+            hasInts(commands, i, command, 2 + 5 * (size_t)values[1]);
+            break;
+        }
+        case CommandType::BindFramebuffer:
+            if (command.mode == GL_FRAMEBUFFER)
+            {
+                redundantBinds += drawFramebuffer == command.object && readFramebuffer == command.object;
+                drawFramebuffer = command.object;
+                readFramebuffer = command.object;
+            }
+            else if (command.mode == GL_DRAW_FRAMEBUFFER || command.mode == GL_READ_FRAMEBUFFER)
+            {
+                GLuint& bound = command.mode == GL_DRAW_FRAMEBUFFER ? drawFramebuffer : readFramebuffer;
+                redundantBinds += bound == command.object;
+                bound = command.object;
+            }
+            else
+            {
+                fail(i, command, "unknown framebuffer target");
+            }
+            break;
+        case CommandType::FramebufferTexture:
+            if (drawFramebuffer == 0)
+            {
+                fail(i, command, "attachment to the default framebuffer");
+            }
+            if (!(command.mode >= GL_COLOR_ATTACHMENT0 && command.mode <= GL_COLOR_ATTACHMENT15) &&
+                command.mode != GL_DEPTH_ATTACHMENT && command.mode != GL_STENCIL_ATTACHMENT &&
+                command.mode != GL_DEPTH_STENCIL_ATTACHMENT)
+            {
+                fail(i, command, "unknown attachment");
+            }
+            if (command.location < 0)
+            {
+                fail(i, command, "negative level");
+            }
+            break;
+        case CommandType::Viewport:
+            if (hasInts(commands, i, command, 4) &&
+                (commands.getInts(command)[2] < 0 || commands.getInts(command)[3] < 0))
+            {
+                fail(i, command, "negative size");
+            }
+            break;
+        case CommandType::BlitFramebuffer:
+            hasInts(commands, i, command, 8);
+            if (command.mode == 0 ||
+                command.mode & ~(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT))
+            {
+                fail(i, command, "unknown buffer bits");
+            }
+            if (command.first != GL_NEAREST && command.first != GL_LINEAR)
+            {
+                fail(i, command, "unknown filter");
+            }
+            // Depth and stencil can only be copied without filtering.
+            else if (command.first == GL_LINEAR && command.mode & (GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT))
+            {
+                fail(i, command, "linear filter on depth or stencil");
+            }
+            break;
+        case CommandType::GenerateMipmap:
+            if (command.location < 0 || command.location >= TEXTURE_UNITS)
+            {
+                fail(i, command, "texture unit out of range");
+            }
+            else if (textures[command.location] == 0)
+            {
+                fail(i, command, "no texture bound");
+            }
+            break;
+        case CommandType::UniformVec2:
+            checkUniform(i, command);
+            hasFloats(commands, i, command, 2);
+            break;
+        case CommandType::DrawArraysInstanced:
+            checkDraw(i, command);
+            if (command.first < 0 || command.count < 0)
+            {
+                fail(i, command, "negative vertex range");
+            }
+            if (!hasInts(commands, i, command, 1))
+            {
+                continue;
+            }
+            if (commands.getInts(command)[0] < 0)
+            {
+                fail(i, command, "negative instance count");
+            }
+            break;
+        case CommandType::DrawArraysIndirect:
+            checkDraw(i, command);
+            if (command.object == 0)
+            {
+                fail(i, command, "no indirect buffer");
+            }
+            if (command.first < 0 || command.first % 4 != 0)
+            {
+                fail(i, command, "misaligned offset");
+            }
+            break;
+        case CommandType::DrawTransformFeedback:
+            checkDraw(i, command);
+            if (command.object == 0)
+            {
+                fail(i, command, "no transform feedback object");
+            }
+            break;
+        default:
+            fail(i, command, "unknown command");
+            continue;
+        }
+        count(commands, command, stats);
+        count(commands, command, totals);
+    }
+}
+
+void NullCommandBackend::checkUniform(size_t index, const Command& command)
+{
+    if (program == 0)
+    {
+        fail(index, command, "uniform set without a program");
+    }
+    if (command.location == -1)
+    {
+        ignoredUniforms++;
+    }
+    else if (command.location < -1)
+    {
+        fail(index, command, "invalid uniform location");
+    }
+}
+
+void NullCommandBackend::checkDraw(size_t index, const Command& command)
+{
+    if (program == 0)
+    {
+        fail(index, command, "draw without a program");
+    }
+    // The core profile has no default vertex array.
+    if (vertexArray == 0)
+    {
+        fail(index, command, "draw without a vertex array");
+    }
+    if (command.mode > GL_TRIANGLE_STRIP_ADJACENCY)
+    {
+        fail(index, command, "unknown primitive mode");
+    }
+}
+
+bool NullCommandBackend::hasInts(const CommandBuffer& commands, size_t index, const Command& command, size_t count)
+{
+    if ((size_t)command.data + count > commands.getIntCount())
+    {
+        fail(index, command, "values outside the buffer");
+        return false;
+    }
+    return true;
+}
+
+bool NullCommandBackend::isCapability(GLenum capability)
+{
+    switch (capability)
+    {
+    case GL_BLEND:
+    case GL_CULL_FACE:
+    case GL_DEPTH_TEST:
+    case GL_STENCIL_TEST:
+    case GL_SCISSOR_TEST:
+    case GL_POLYGON_OFFSET_FILL:
+    case GL_PROGRAM_POINT_SIZE:
+    case GL_RASTERIZER_DISCARD:
+    case GL_MULTISAMPLE:
+    case GL_FRAMEBUFFER_SRGB:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool NullCommandBackend::isStencilOp(GLenum op)
+{
+    switch (op)
+    {
+    case GL_KEEP:
+    case GL_ZERO:
+    case GL_REPLACE:
+    case GL_INCR:
+    case GL_INCR_WRAP:
+    case GL_DECR:
+    case GL_DECR_WRAP:
+    case GL_INVERT:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool NullCommandBackend::isBlendFactor(GLenum factor)
+{
+    return factor == GL_ZERO || factor == GL_ONE || (factor >= GL_SRC_COLOR && factor <= GL_SRC_ALPHA_SATURATE) ||
+           (factor >= GL_CONSTANT_COLOR && factor <= GL_ONE_MINUS_CONSTANT_ALPHA);
+}
+
+bool NullCommandBackend::hasFloats(const CommandBuffer& commands, size_t index, const Command& command,
+                                   size_t count)
+{
+    if ((size_t)command.data + count > commands.getFloatCount())
+    {
+        fail(index, command, "values outside the buffer");
+        return false;
+    }
+    return true;
+}
+
+void NullCommandBackend::fail(size_t index, const Command& command, const char* message)
+{
+    errorCount++;
+    if (errors.size() < MAX_ERRORS)
+    {
+        errors.push_back("command " + std::to_string(index) + " (" + getCommandName(command.type) + "): " + message);
+    }
+}
+
+void NullCommandBackend::reset()
+{
+    *this = NullCommandBackend();
+}
+
+void NullCommandBackend::print(std::ostream& out) const
+{
+    out << "Null backend: " << commandCount << " commands, " << totals.drawCalls << " draws, " << totals.triangles
+        << " triangles, " << totals.stateChanges << " binds (" << redundantBinds << " redundant), "
+        << ignoredUniforms << " uniforms without a location, " << errorCount << " validation errors" << std::endl;
+    for (const std::string& error : errors)
+    {
+        out << "  " << error << std::endl;
+    }
+    if (errorCount > (long long)errors.size())
+    {
+        out << "  ... and " << errorCount - errors.size() << " more" << std::endl;
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "CommandBuffer.h"
+#include "RenderStats.h"
+
+// Replays recorded commands. Each submit starts from nothing known about the
+// bound state, since the passes between two submits may have changed any of it.
+class CommandBackend
+{
+public:
+    virtual ~CommandBackend() = default;
+
+    // Replays commands[first] to the end of the buffer and counts them into stats.
+    virtual void submit(const CommandBuffer& commands, size_t first, RenderStats& stats) = 0;
+
+protected:
+    // Binds, draws and triangles of one command, as the draw sites count them.
+    static void count(const CommandBuffer& commands, const Command& command, RenderStats& stats);
+};
+
+// Issues every command to the current GL context.
+class GLCommandBackend : public CommandBackend
+{
+public:
+    void submit(const CommandBuffer& commands, size_t first, RenderStats& stats) override;
+
+private:
+    // Unpacked from a vertex buffer command, kept to reuse the allocation.
+    std::vector<VertexAttribute> vertexAttributes;
+};
+
+// Issues nothing. Keeps the bound program, vertex array, framebuffers, textures
+// and samplers to check every command against them, and counts the commands, so
+// recording a frame can be timed and checked without a GPU.
+class NullCommandBackend : public CommandBackend
+{
+public:
+    void submit(const CommandBuffer& commands, size_t first, RenderStats& stats) override;
+
+    // Commands, draws and binds of every submit since the last reset.
+    long long getCommandCount() const { return commandCount; }
+    const RenderStats& getTotals() const { return totals; }
+    // Binds of what was already bound, which a state cache would have skipped.
+    long long getRedundantBinds() const { return redundantBinds; }
+    // Uniforms set at location -1, which GL silently ignores.
+    long long getIgnoredUniforms() const { return ignoredUniforms; }
+    long long getErrorCount() const { return errorCount; }
+    // The first MAX_ERRORS validation errors.
+    const std::vector<std::string>& getErrors() const { return errors; }
+
+    void reset();
+    void print(std::ostream& out) const;
+
+    static constexpr GLint TEXTURE_UNITS = 16;
+    static constexpr size_t MAX_ERRORS = 16;
+
+private:
+    void fail(size_t index, const Command& command, const char* message);
+    bool hasFloats(const CommandBuffer& commands, size_t index, const Command& command, size_t count);
+    bool hasInts(const CommandBuffer& commands, size_t index, const Command& command, size_t count);
+    static bool isCapability(GLenum capability);
+    static bool isStencilOp(GLenum op);
+    static bool isBlendFactor(GLenum factor);
+    void checkUniform(size_t index, const Command& command);
+    void checkDraw(size_t index, const Command& command);
+
+    GLuint program = 0;
+    GLuint vertexArray = 0;
+    GLuint drawFramebuffer = 0;
+    GLuint readFramebuffer = 0;
+    GLuint textures[TEXTURE_UNITS] = {};
+    GLuint samplers[TEXTURE_UNITS] = {};
+
+    long long commandCount = 0;
+    RenderStats totals;
+    long long redundantBinds = 0;
+    long long ignoredUniforms = 0;
+    long long errorCount = 0;
+    std::vector<std::string> errors;
+};
@@ -0,0 +1,481 @@
+#include "CommandBuffer.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <glm/glm/gtc/type_ptr.hpp>
+
+namespace
+{
+const char MAGIC[4] = {'B', 'C', 'M', 'D'};
+// Version 2 added the state, buffer, framebuffer and instanced draw commands;
+// version 1 streams are a subset and still load.
+const uint32_t VERSION = 2;
+
+void writeUnsigned(std::ostream& out, uint32_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+    {
+        out.put((char)((value >> (8 * i)) & 0xFF));
+    }
+}
+
+uint32_t readUnsigned(std::istream& in, int bytes)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < bytes; ++i)
+    {
+        value |= (uint32_t)(unsigned char)in.get() << (8 * i);
+    }
+    return value;
+}
+}
+
+const char* getCommandName(CommandType type)
+{
+    switch (type)
+    {
+    case CommandType::Clear:
+        return "clear";
+    case CommandType::UseProgram:
+        return "use program";
+    case CommandType::BindVertexArray:
+        return "bind vertex array";
+    case CommandType::BindTexture:
+        return "bind texture";
+    case CommandType::BindSampler:
+        return "bind sampler";
+    case CommandType::UniformInt:
+        return "uniform int";
+    case CommandType::UniformFloat:
+        return "uniform float";
+    case CommandType::UniformVec3:
+        return "uniform vec3";
+    case CommandType::UniformVec4:
+        return "uniform vec4";
+    case CommandType::UniformMat3:
+        return "uniform mat3";
+    case CommandType::UniformMat4:
+        return "uniform mat4";
+    case CommandType::DrawArrays:
+        return "draw arrays";
+    case CommandType::MultiDrawArrays:
+        return "multi draw arrays";
+    case CommandType::Enable:
+        return "enable";
+    case CommandType::Disable:
+        return "disable";
+    case CommandType::ColorMask:
+        return "color mask";
+    case CommandType::DepthMask:
+        return "depth mask";
+    case CommandType::DepthFunc:
+        return "depth func";
+    case CommandType::StencilFunc:
+        return "stencil func";
+    case CommandType::StencilOp:
+        return "stencil op";
+    case CommandType::BlendFunc:
+        return "blend func";
+    case CommandType::LineWidth:
+        return "line width";
+    case CommandType::PointSize:
+        return "point size";
+    case CommandType::PolygonOffset:
+        return "polygon offset";
+    case CommandType::BindBufferRange:
+        return "bind buffer range";
+    case CommandType::BindVertexBuffer:
+        return "bind vertex buffer";
+    case CommandType::BindFramebuffer:
+        return "bind framebuffer";
+    case CommandType::FramebufferTexture:
+        return "framebuffer texture";
+    case CommandType::Viewport:
+        return "viewport";
+    case CommandType::BlitFramebuffer:
+        return "blit framebuffer";
+    case CommandType::GenerateMipmap:
+        return "generate mipmap";
+    case CommandType::UniformVec2:
+        return "uniform vec2";
+    case CommandType::DrawArraysInstanced:
+        return "draw arrays instanced";
+    case CommandType::DrawArraysIndirect:
+        return "draw arrays indirect";
+    case CommandType::DrawTransformFeedback:
+        return "draw transform feedback";
+    }
+    return "unknown";
+}
+
+void CommandBuffer::reset()
+{
+    commands.clear();
+    floats.clear();
+    ints.clear();
+}
+
+Command& CommandBuffer::add(CommandType type)
+{
+    Command& command = commands.emplace_back();
+    command.type = type;
+    return command;
+}
+
+void CommandBuffer::addFloats(Command& command, const float* values, size_t count)
+{
+    command.data = (uint32_t)floats.size();
+    floats.insert(floats.end(), values, values + count);
+}
+
+void CommandBuffer::addInts(Command& command, std::initializer_list<GLint> values)
+{
+    command.data = (uint32_t)ints.size();
+    ints.insert(ints.end(), values);
+}
+
+void CommandBuffer::clear(GLbitfield mask, const glm::vec4& color)
+{
+    Command& command = add(CommandType::Clear);
+    command.mode = mask;
+    addFloats(command, glm::value_ptr(color), 4);
+}
+
+void CommandBuffer::useProgram(GLuint program)
+{
+    add(CommandType::UseProgram).object = program;
+}
+
+void CommandBuffer::bindVertexArray(GLuint vertexArray)
+{
+    add(CommandType::BindVertexArray).object = vertexArray;
+}
+
+void CommandBuffer::bindTexture(GLuint unit, GLenum target, GLuint texture)
+{
+    Command& command = add(CommandType::BindTexture);
+    command.mode = target;
+    command.location = (GLint)unit;
+    command.object = texture;
+}
+
+void CommandBuffer::bindSampler(GLuint unit, GLuint sampler)
+{
+    Command& command = add(CommandType::BindSampler);
+    command.location = (GLint)unit;
+    command.object = sampler;
+}
+
+void CommandBuffer::setUniform(GLint location, int value)
+{
+    Command& command = add(CommandType::UniformInt);
+    command.location = location;
+    command.first = value;
+}
+
+void CommandBuffer::setUniform(GLint location, float value)
+{
+    Command& command = add(CommandType::UniformFloat);
+    command.location = location;
+    addFloats(command, &value, 1);
+}
+
+void CommandBuffer::setUniform(GLint location, const glm::vec2& value)
+{
+    Command& command = add(CommandType::UniformVec2);
+    command.location = location;
+    addFloats(command, glm::value_ptr(value), 2);
+}
+
+void CommandBuffer::setUniform(GLint location, const glm::vec3& value)
+{
+    Command& command = add(CommandType::UniformVec3);
+    command.location = location;
+    addFloats(command, glm::value_ptr(value), 3);
+}
+
+void CommandBuffer::setUniform(GLint location, const glm::vec4& value)
+{
+    Command& command = add(CommandType::UniformVec4);
+    command.location = location;
+    addFloats(command, glm::value_ptr(value), 4);
+}
+
+void CommandBuffer::setUniform(GLint location, const glm::mat3& value)
+{
+    Command& command = add(CommandType::UniformMat3);
+    command.location = location;
+    addFloats(command, glm::value_ptr(value), 9);
+}
+
+void CommandBuffer::setUniform(GLint location, const glm::mat4& value)
+{
+    Command& command = add(CommandType::UniformMat4);
+    command.location = location;
+    addFloats(command, glm::value_ptr(value), 16);
+}
+
+void CommandBuffer::drawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    Command& command = add(CommandType::DrawArrays);
+    command.mode = mode;
+    command.first = first;
+    command.count = count;
+}
+
+void CommandBuffer::multiDrawArrays(GLenum mode, const GLint* firsts, const GLsizei* counts, GLsizei drawCount)
+{
+    // The firsts, then the counts.
+    Command& command = add(CommandType::MultiDrawArrays);
+    command.mode = mode;
+    command.count = drawCount;
+    command.data = (uint32_t)ints.size();
+    ints.insert(ints.end(), firsts, firsts + drawCount);
+    ints.insert(ints.end(), counts, counts + drawCount);
+}
+
+void CommandBuffer::drawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount)
+{
+    Command& command = add(CommandType::DrawArraysInstanced);
+    command.mode = mode;
+    command.first = first;
+    command.count = count;
+    addInts(command, {instanceCount});
+}
+
+void CommandBuffer::drawArraysIndirect(GLenum mode, GLuint buffer, GLintptr offset)
+{
+    Command& command = add(CommandType::DrawArraysIndirect);
+    command.mode = mode;
+    command.object = buffer;
+    command.first = (GLint)offset;
+}
+
+void CommandBuffer::drawTransformFeedback(GLenum mode, GLuint feedback)
+{
+    Command& command = add(CommandType::DrawTransformFeedback);
+    command.mode = mode;
+    command.object = feedback;
+}
+
+void CommandBuffer::enable(GLenum capability)
+{
+    add(CommandType::Enable).mode = capability;
+}
+
+void CommandBuffer::disable(GLenum capability)
+{
+    add(CommandType::Disable).mode = capability;
+}
+
+void CommandBuffer::colorMask(bool red, bool green, bool blue, bool alpha)
+{
+    // One bit per channel, red first.
+    add(CommandType::ColorMask).first = (int)red | (int)green << 1 | (int)blue << 2 | (int)alpha << 3;
+}
+
+void CommandBuffer::depthMask(bool write)
+{
+    add(CommandType::DepthMask).first = write;
+}
+
+void CommandBuffer::depthFunc(GLenum func)
+{
+    add(CommandType::DepthFunc).mode = func;
+}
+
+void CommandBuffer::stencilFunc(GLenum func, GLint reference, GLuint mask)
+{
+    Command& command = add(CommandType::StencilFunc);
+    command.mode = func;
+    command.first = reference;
+    command.object = mask;
+}
+
+void CommandBuffer::stencilOp(GLenum stencilFail, GLenum depthFail, GLenum depthPass)
+{
+    addInts(add(CommandType::StencilOp), {(GLint)stencilFail, (GLint)depthFail, (GLint)depthPass});
+}
+
+void CommandBuffer::blendFunc(GLenum source, GLenum destination)
+{
+    Command& command = add(CommandType::BlendFunc);
+    command.mode = source;
+    command.first = (GLint)destination;
+}
+
+void CommandBuffer::lineWidth(float width)
+{
+    addFloats(add(CommandType::LineWidth), &width, 1);
+}
+
+void CommandBuffer::pointSize(float size)
+{
+    addFloats(add(CommandType::PointSize), &size, 1);
+}
+
+void CommandBuffer::polygonOffset(float factor, float units)
+{
+    const float values[2] = {factor, units};
+    addFloats(add(CommandType::PolygonOffset), values, 2);
+}
+
+void CommandBuffer::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+    Command& command = add(CommandType::BindBufferRange);
+    command.mode = target;
+    command.location = (GLint)index;
+    command.object = buffer;
+    command.first = (GLint)offset;
+    command.count = (GLsizei)size;
+}
+
+void CommandBuffer::bindVertexBuffer(GLuint vertexArray, GLuint buffer, GLintptr offset, GLsizei stride,
+                                     std::initializer_list<VertexAttribute> attributes)
+{
+    // The buffer and the attribute count, then location, size, offset, type and
+    // normalized of every attribute.
+    Command& command = add(CommandType::BindVertexBuffer);
+    command.object = vertexArray;
+    command.first = (GLint)offset;
+    command.count = stride;
+    addInts(command, {(GLint)buffer, (GLint)attributes.size()});
+    for (const VertexAttribute& attribute : attributes)
+    {
+        ints.insert(ints.end(), {(GLint)attribute.location, attribute.size, (GLint)attribute.offset,
+                                 (GLint)attribute.type, (GLint)attribute.normalized});
+    }
+}
+
+void CommandBuffer::bindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    Command& command = add(CommandType::BindFramebuffer);
+    command.mode = target;
+    command.object = framebuffer;
+}
+
+void CommandBuffer::framebufferTexture(GLenum attachment, GLenum textureTarget, GLuint texture, GLint level)
+{
+    // The texture target goes into first, the level into location.
+    Command& command = add(CommandType::FramebufferTexture);
+    command.mode = attachment;
+    command.first = (GLint)textureTarget;
+    command.object = texture;
+    command.location = level;
+}
+
+void CommandBuffer::viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    addInts(add(CommandType::Viewport), {x, y, width, height});
+}
+
+void CommandBuffer::blitFramebuffer(const glm::ivec4& source, const glm::ivec4& destination, GLbitfield mask,
+                                    GLenum filter)
+{
+    // The source rectangle, then the destination one, as x0, y0, x1, y1.
+    Command& command = add(CommandType::BlitFramebuffer);
+    command.mode = mask;
+    command.first = (GLint)filter;
+    addInts(command, {source.x, source.y, source.z, source.w, destination.x, destination.y, destination.z,
+                      destination.w});
+}
+
+void CommandBuffer::generateMipmap(GLuint unit, GLenum target)
+{
+    Command& command = add(CommandType::GenerateMipmap);
+    command.mode = target;
+    command.location = (GLint)unit;
+}
+
+bool CommandBuffer::save(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+
+    file.write(MAGIC, sizeof(MAGIC));
+    writeUnsigned(file, VERSION, 4);
+    writeUnsigned(file, (uint32_t)commands.size(), 4);
+    writeUnsigned(file, (uint32_t)floats.size(), 4);
+    writeUnsigned(file, (uint32_t)ints.size(), 4);
+
+    for (const Command& command : commands)
+    {
+        writeUnsigned(file, (uint8_t)command.type, 1);
+        writeUnsigned(file, command.mode, 4);
+        writeUnsigned(file, (uint32_t)command.location, 4);
+        writeUnsigned(file, command.object, 4);
+        writeUnsigned(file, (uint32_t)command.first, 4);
+        writeUnsigned(file, (uint32_t)command.count, 4);
+        writeUnsigned(file, command.data, 4);
+    }
+    for (float value : floats)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        writeUnsigned(file, bits, 4);
+    }
+    for (GLint value : ints)
+    {
+        writeUnsigned(file, (uint32_t)value, 4);
+    }
+
+    return (bool)file;
+}
+
+bool CommandBuffer::load(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(MAGIC)] = {};
+    if (!file || !file.read(magic, sizeof(magic)) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+    {
+        std::cerr << "Not a command stream: " << path << std::endl;
+        return false;
+    }
+
+    uint32_t version = readUnsigned(file, 4);
+    if (version == 0 || version > VERSION)
+    {
+        std::cerr << "Unsupported command stream version " << version << ": " << path << std::endl;
+        return false;
+    }
+
+    uint32_t commandCount = readUnsigned(file, 4);
+    uint32_t floatCount = readUnsigned(file, 4);
+    uint32_t intCount = readUnsigned(file, 4);
+    reset();
+
+    for (uint32_t i = 0; i < commandCount && file; ++i)
+    {
+        Command& command = commands.emplace_back();
+        command.type = (CommandType)readUnsigned(file, 1);
+        command.mode = readUnsigned(file, 4);
+        command.location = (GLint)readUnsigned(file, 4);
+        command.object = readUnsigned(file, 4);
+        command.first = (GLint)readUnsigned(file, 4);
+        command.count = (GLsizei)readUnsigned(file, 4);
+        command.data = readUnsigned(file, 4);
+    }
+    for (uint32_t i = 0; i < floatCount && file; ++i)
+    {
+        uint32_t bits = readUnsigned(file, 4);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        floats.push_back(value);
+    }
+    for (uint32_t i = 0; i < intCount && file; ++i)
+    {
+        ints.push_back((GLint)readUnsigned(file, 4));
+    }
+
+    if (!file)
+    {
+        std::cerr << "Truncated command stream: " << path << std::endl;
+        reset();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <GLAD/glad.h>
+#include <glm/glm/glm.hpp>
+#include "VertexArrays.h"
+
+enum class CommandType : uint8_t
+{
+    Clear,
+    UseProgram,
+    BindVertexArray,
+    BindTexture,
+    BindSampler,
+    UniformInt,
+    UniformFloat,
+    UniformVec3,
+    UniformVec4,
+    UniformMat3,
+    UniformMat4,
+    DrawArrays,
+    MultiDrawArrays,
+    Enable,
+    Disable,
+    ColorMask,
+    DepthMask,
+    DepthFunc,
+    StencilFunc,
+    StencilOp,
+    BlendFunc,
+    LineWidth,
+    PointSize,
+    PolygonOffset,
+    BindBufferRange,
+    BindVertexBuffer,
+    BindFramebuffer,
+    FramebufferTexture,
+    Viewport,
+    BlitFramebuffer,
+    GenerateMipmap,
+    UniformVec2,
+    DrawArraysInstanced,
+    DrawArraysIndirect,
+    DrawTransformFeedback
+};
+
+const char* getCommandName(CommandType type);
+
+// One recorded call. Arguments that do not fit, such as clear colors, uniform
+// values, multi-draw ranges and rectangles, are stored in the buffer's floats or
+// ints, starting at data.
+struct Command
+{
+    CommandType type = CommandType::Clear;
+    // Draw mode, texture or buffer target, clear mask, capability or comparison function.
+    GLenum mode = 0;
+    // Uniform location, texture unit or buffer binding index.
+    GLint location = -1;
+    // Program, vertex array, texture, sampler, buffer, framebuffer or transform feedback.
+    GLuint object = 0;
+    // First vertex, buffer offset, or the value of an int uniform or flag.
+    GLint first = 0;
+    // Vertex count, buffer size or stride, or the number of ranges of a multi-draw.
+    GLsizei count = 0;
+    uint32_t data = 0;
+};
+
+// Rendering work recorded as plain data instead of issued to GL directly. The
+// frame loop records its passes here, and a CommandBackend replays them: to GL,
+// or to the null backend, which only counts and validates, so the CPU cost of
+// building a frame can be measured without a GPU. A buffer can be saved and
+// loaded again to replay a captured frame offline. Object names are those of
+// the context that recorded it, so a loaded buffer is for the null backend.
+class CommandBuffer
+{
+public:
+    // Drops the recorded commands, keeping the memory for the next frame.
+    void reset();
+
+    void clear(GLbitfield mask, const glm::vec4& color);
+    void useProgram(GLuint program);
+    void bindVertexArray(GLuint vertexArray);
+    void bindTexture(GLuint unit, GLenum target, GLuint texture);
+    void bindSampler(GLuint unit, GLuint sampler);
+    void setUniform(GLint location, int value);
+    void setUniform(GLint location, float value);
+    void setUniform(GLint location, const glm::vec2& value);
+    void setUniform(GLint location, const glm::vec3& value);
+    void setUniform(GLint location, const glm::vec4& value);
+    void setUniform(GLint location, const glm::mat3& value);
+    void setUniform(GLint location, const glm::mat4& value);
+    void drawArrays(GLenum mode, GLint first, GLsizei count);
+    // Copies the ranges, so the arrays may change once it returns.
+    void multiDrawArrays(GLenum mode, const GLint* firsts, const GLsizei* counts, GLsizei drawCount);
+    void drawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount);
+    // Reads the arguments at offset bytes into buffer, bound as the draw indirect buffer for the draw only.
+    void drawArraysIndirect(GLenum mode, GLuint buffer, GLintptr offset);
+    void drawTransformFeedback(GLenum mode, GLuint feedback);
+
+    // Render state. The passes leave it as they found it: depth test and writes
+    // on with LESS, color writes on, stencil test and blending off.
+    void enable(GLenum capability);
+    void disable(GLenum capability);
+    void colorMask(bool red, bool green, bool blue, bool alpha);
+    void depthMask(bool write);
+    void depthFunc(GLenum func);
+    void stencilFunc(GLenum func, GLint reference, GLuint mask);
+    void stencilOp(GLenum stencilFail, GLenum depthFail, GLenum depthPass);
+    void blendFunc(GLenum source, GLenum destination);
+    void lineWidth(float width);
+    void pointSize(float size);
+    void polygonOffset(float factor, float units);
+
+    // A size of 0 binds the whole buffer.
+    void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+    // Points a vertex array made by createVertexArray at offset bytes into buffer;
+    // copies the attributes for contexts without direct state access.
+    void bindVertexBuffer(GLuint vertexArray, GLuint buffer, GLintptr offset, GLsizei stride,
+                          std::initializer_list<VertexAttribute> attributes);
+
+    void bindFramebuffer(GLenum target, GLuint framebuffer);
+    // Attaches a level of texture to the framebuffer bound to GL_FRAMEBUFFER.
+    void framebufferTexture(GLenum attachment, GLenum textureTarget, GLuint texture, GLint level);
+    void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+    // From the GL_READ_FRAMEBUFFER to the GL_DRAW_FRAMEBUFFER binding.
+    void blitFramebuffer(const glm::ivec4& source, const glm::ivec4& destination, GLbitfield mask, GLenum filter);
+    // Of the texture bound to target on unit.
+    void generateMipmap(GLuint unit, GLenum target);
+
+    size_t size() const { return commands.size(); }
+    bool empty() const { return commands.empty(); }
+    const Command& operator[](size_t index) const { return commands[index]; }
+    const float* getFloats(const Command& command) const { return floats.data() + command.data; }
+    const GLint* getInts(const Command& command) const { return ints.data() + command.data; }
+    size_t getFloatCount() const { return floats.size(); }
+    size_t getIntCount() const { return ints.size(); }
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+private:
+    Command& add(CommandType type);
+    void addFloats(Command& command, const float* values, size_t count);
+    void addInts(Command& command, std::initializer_list<GLint> values);
+
+    std::vector<Command> commands;
+    std::vector<float> floats;
+    std::vector<GLint> ints;
+};
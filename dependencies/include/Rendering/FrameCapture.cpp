@@ -0,0 +1,275 @@
+#include "FrameCapture.h"
+
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+FrameCapture::FrameCapture(const CaptureSettings& settings, int ringSize)
+    : settings(settings), slots(ringSize)
+{
+    this->settings.stride = std::max(1, settings.stride);
+
+    std::filesystem::path directory = std::filesystem::path(settings.pathPrefix).parent_path();
+    if (settings.format != CaptureFormat::Pipe && !directory.empty())
+    {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+    }
+
+    worker = std::thread(&FrameCapture::workerMain, this);
+}
+
+FrameCapture::~FrameCapture()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    queueChanged.notify_all();
+    worker.join();
+
+    if (pipe)
+    {
+        pclose(pipe);
+    }
+
+    for (Slot& slot : slots)
+    {
+        if (slot.fence)
+        {
+            glDeleteSync(slot.fence);
+        }
+        glDeleteBuffers(1, &slot.buffer);
+    }
+}
+
+void FrameCapture::endFrame(bool capturing, int width, int height)
+{
+    // Oldest first; stop at the first copy the GPU has not finished yet.
+    while (pendingCount > 0)
+    {
+        Slot& slot = slots[oldestSlot];
+        GLenum status = glClientWaitSync(slot.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        {
+            break;
+        }
+        retire(slot);
+    }
+
+    long long frame = frameIndex++;
+    if (!capturing || frame % settings.stride != 0 || width <= 0 || height <= 0)
+    {
+        return;
+    }
+
+    if (width != this->width || height != this->height)
+    {
+        finish();
+        resize(width, height);
+    }
+
+    if (pendingCount == (int)slots.size())
+    {
+        droppedFrames++;
+        return;
+    }
+
+    Slot& slot = slots[(oldestSlot + pendingCount) % slots.size()];
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.frame = frame;
+    pendingCount++;
+}
+
+void FrameCapture::finish()
+{
+    while (pendingCount > 0)
+    {
+        Slot& slot = slots[oldestSlot];
+        while (glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED)
+        {
+        }
+        retire(slot);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    queueChanged.wait(lock, [this] { return queue.empty() && !busy; });
+}
+
+void FrameCapture::resize(int width, int height)
+{
+    this->width = width;
+    this->height = height;
+
+    for (Slot& slot : slots)
+    {
+        if (!slot.buffer)
+        {
+            glGenBuffers(1, &slot.buffer);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)width * height * 4, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void FrameCapture::retire(Slot& slot)
+{
+    size_t size = (size_t)width * height * 4;
+
+    CapturedFrame captured;
+    captured.frame = slot.frame;
+    captured.width = width;
+    captured.height = height;
+
+    bool queueFull;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queueFull = queue.size() >= MAX_QUEUED_FRAMES;
+        if (!queueFull && !freeBuffers.empty())
+        {
+            captured.pixels = std::move(freeBuffers.back());
+            freeBuffers.pop_back();
+        }
+    }
+
+    if (queueFull)
+    {
+        droppedFrames++;
+    }
+    else
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)size, GL_MAP_READ_BIT);
+        if (data)
+        {
+            captured.pixels.resize(size);
+            memcpy(captured.pixels.data(), data, size);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                queue.push_back(std::move(captured));
+            }
+            queueChanged.notify_all();
+            capturedFrames++;
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    oldestSlot = (oldestSlot + 1) % (int)slots.size();
+    pendingCount--;
+}
+
+void FrameCapture::workerMain()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        queueChanged.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (queue.empty())
+        {
+            return;
+        }
+
+        CapturedFrame frame = std::move(queue.front());
+        queue.pop_front();
+        busy = true;
+
+        lock.unlock();
+        write(frame);
+        lock.lock();
+
+        freeBuffers.push_back(std::move(frame.pixels));
+        busy = false;
+        queueChanged.notify_all();
+    }
+}
+
+void FrameCapture::write(CapturedFrame& frame)
+{
+    size_t rowSize = (size_t)frame.width * 4;
+
+    if (settings.format == CaptureFormat::Pipe)
+    {
+        if (!pipe)
+        {
+            std::string command = settings.command;
+            auto substitute = [&](const std::string& key, int value)
+            {
+                for (size_t at = command.find(key); at != std::string::npos; at = command.find(key))
+                {
+                    command.replace(at, key.size(), std::to_string(value));
+                }
+            };
+            substitute("{width}", frame.width);
+            substitute("{height}", frame.height);
+
+            pipe = popen(command.c_str(), "w");
+            if (!pipe)
+            {
+                std::cerr << "Capture: failed to start encoder: " << command << std::endl;
+                settings.format = CaptureFormat::Raw;
+            }
+        }
+
+        if (pipe)
+        {
+            // GL rows start at the bottom of the image.
+            for (int row = frame.height - 1; row >= 0; --row)
+            {
+                fwrite(&frame.pixels[row * rowSize], 1, rowSize, pipe);
+            }
+            return;
+        }
+    }
+
+    char number[16];
+    snprintf(number, sizeof(number), "%06lld", frame.frame);
+    bool ppm = settings.format == CaptureFormat::PPM;
+    std::string path = settings.pathPrefix + number + (ppm ? ".ppm" : ".rgba");
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        std::cerr << "Capture: failed to write " << path << std::endl;
+        return;
+    }
+
+    if (ppm)
+    {
+        fprintf(file, "P6\n%d %d\n255\n", frame.width, frame.height);
+        std::vector<unsigned char> rgb((size_t)frame.width * 3);
+        for (int row = frame.height - 1; row >= 0; --row)
+        {
+            const unsigned char* rgba = &frame.pixels[row * rowSize];
+            for (int x = 0; x < frame.width; ++x)
+            {
+                rgb[x * 3 + 0] = rgba[x * 4 + 0];
+                rgb[x * 3 + 1] = rgba[x * 4 + 1];
+                rgb[x * 3 + 2] = rgba[x * 4 + 2];
+            }
+            fwrite(rgb.data(), 1, rgb.size(), file);
+        }
+    }
+    else
+    {
+        for (int row = frame.height - 1; row >= 0; --row)
+        {
+            fwrite(&frame.pixels[row * rowSize], 1, rowSize, file);
+        }
+    }
+
+    fclose(file);
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "GLExtensions.h"
+
+enum class CaptureFormat
+{
+    // One binary PPM file per frame.
+    PPM,
+    // One file per frame of tightly packed RGBA rows, top row first.
+    Raw,
+    // The same RGBA frames written to the stdin of an external encoder.
+    Pipe
+};
+
+struct CaptureSettings
+{
+    // Captures every stride-th frame.
+    int stride = 1;
+    CaptureFormat format = CaptureFormat::PPM;
+    // File name prefix; the frame number and extension are appended.
+    std::string pathPrefix = "capture/frame_";
+    // Encoder command for CaptureFormat::Pipe. {width} and {height} are replaced
+    // with the framebuffer size.
+    std::string command;
+};
+
+// Records rendered frames without stalling the pipeline. glReadPixels goes into
+// a ring of pixel buffer objects, so the copy runs asynchronously on the GPU; a
+// fence marks when each copy is done, and only then is the buffer mapped, some
+// frames later. Mapped pixels are handed to a worker thread that writes them out.
+//
+// When the ring or the worker queue is full the frame is dropped instead of
+// waiting, so capturing never adds a stall to the frame it runs in.
+class FrameCapture
+{
+public:
+    explicit FrameCapture(const CaptureSettings& settings, int ringSize = 4);
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // Call once per frame after drawing and before the buffer swap, with the
+    // context current. Collects finished readbacks and, if capturing and the
+    // frame is due by the stride, starts reading back the current one.
+    void endFrame(bool capturing, int width, int height);
+
+    // Waits for every readback in flight and for the worker to write them.
+    void finish();
+
+    long long getCapturedFrames() const { return capturedFrames; }
+    long long getDroppedFrames() const { return droppedFrames; }
+
+private:
+    struct Slot
+    {
+        GLuint buffer = 0;
+        GLsync fence = nullptr;
+        long long frame = 0;
+    };
+
+    struct CapturedFrame
+    {
+        std::vector<unsigned char> pixels;
+        long long frame = 0;
+        int width = 0;
+        int height = 0;
+    };
+
+    void resize(int width, int height);
+    // Maps the buffer of a finished slot and queues its pixels for the worker.
+    void retire(Slot& slot);
+    void workerMain();
+    void write(CapturedFrame& frame);
+
+    static const size_t MAX_QUEUED_FRAMES = 8;
+
+    CaptureSettings settings;
+    std::vector<Slot> slots;
+    // Slots are filled and retired in order; pendingCount counts from oldestSlot.
+    int oldestSlot = 0;
+    int pendingCount = 0;
+    int width = 0;
+    int height = 0;
+    long long frameIndex = 0;
+    long long capturedFrames = 0;
+    long long droppedFrames = 0;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable queueChanged;
+    std::deque<CapturedFrame> queue;
+    // Written frames go back here, so steady capture allocates nothing.
+    std::vector<std::vector<unsigned char>> freeBuffers;
+    bool busy = false;
+    bool stopping = false;
+    FILE* pipe = nullptr;
+};
@@ -0,0 +1,118 @@
+#include "GLExtensions.h"
+
+#include <cstring>
+
+#ifndef GL_VERSION_4_0
+PFNGLDRAWARRAYSINDIRECTPROC glad_glDrawArraysIndirect = nullptr;
+PFNGLBINDTRANSFORMFEEDBACKPROC glad_glBindTransformFeedback = nullptr;
+PFNGLDELETETRANSFORMFEEDBACKSPROC glad_glDeleteTransformFeedbacks = nullptr;
+PFNGLGENTRANSFORMFEEDBACKSPROC glad_glGenTransformFeedbacks = nullptr;
+PFNGLDRAWTRANSFORMFEEDBACKPROC glad_glDrawTransformFeedback = nullptr;
+#endif
+
+#ifndef GL_VERSION_4_2
+PFNGLMEMORYBARRIERPROC glad_glMemoryBarrier = nullptr;
+#endif
+
+#ifndef GL_VERSION_4_3
+PFNGLDISPATCHCOMPUTEPROC glad_glDispatchCompute = nullptr;
+#endif
+
+#ifndef GL_VERSION_4_4
+PFNGLBUFFERSTORAGEPROC glad_glBufferStorage = nullptr;
+#endif
+
+#ifndef GL_VERSION_4_5
+PFNGLCREATEBUFFERSPROC glad_glCreateBuffers = nullptr;
+PFNGLNAMEDBUFFERSTORAGEPROC glad_glNamedBufferStorage = nullptr;
+PFNGLNAMEDBUFFERDATAPROC glad_glNamedBufferData = nullptr;
+PFNGLCREATEVERTEXARRAYSPROC glad_glCreateVertexArrays = nullptr;
+PFNGLVERTEXARRAYVERTEXBUFFERPROC glad_glVertexArrayVertexBuffer = nullptr;
+PFNGLVERTEXARRAYATTRIBFORMATPROC glad_glVertexArrayAttribFormat = nullptr;
+PFNGLVERTEXARRAYATTRIBBINDINGPROC glad_glVertexArrayAttribBinding = nullptr;
+PFNGLENABLEVERTEXARRAYATTRIBPROC glad_glEnableVertexArrayAttrib = nullptr;
+PFNGLVERTEXARRAYBINDINGDIVISORPROC glad_glVertexArrayBindingDivisor = nullptr;
+#endif
+
+#ifndef GL_KHR_parallel_shader_compile
+PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glad_glMaxShaderCompilerThreadsKHR = nullptr;
+#endif
+
+GLCapabilities glCapabilities;
+
+bool hasGLVersion(int major, int minor)
+{
+    return GLVersion.major > major || (GLVersion.major == major && GLVersion.minor >= minor);
+}
+
+bool hasGLExtension(const char* name)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+    for (GLint i = 0; i < count; ++i)
+    {
+        const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+        if (extension && strcmp(extension, name) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void loadGLExtensions(GLADloadproc load)
+{
+#ifndef GL_VERSION_4_0
+    glad_glDrawArraysIndirect = (PFNGLDRAWARRAYSINDIRECTPROC)load("glDrawArraysIndirect");
+    glad_glBindTransformFeedback = (PFNGLBINDTRANSFORMFEEDBACKPROC)load("glBindTransformFeedback");
+    glad_glDeleteTransformFeedbacks = (PFNGLDELETETRANSFORMFEEDBACKSPROC)load("glDeleteTransformFeedbacks");
+    glad_glGenTransformFeedbacks = (PFNGLGENTRANSFORMFEEDBACKSPROC)load("glGenTransformFeedbacks");
+    glad_glDrawTransformFeedback = (PFNGLDRAWTRANSFORMFEEDBACKPROC)load("glDrawTransformFeedback");
+#endif
+#ifndef GL_VERSION_4_2
+    glad_glMemoryBarrier = (PFNGLMEMORYBARRIERPROC)load("glMemoryBarrier");
+#endif
+#ifndef GL_VERSION_4_3
+    glad_glDispatchCompute = (PFNGLDISPATCHCOMPUTEPROC)load("glDispatchCompute");
+#endif
+#ifndef GL_VERSION_4_4
+    glad_glBufferStorage = (PFNGLBUFFERSTORAGEPROC)load("glBufferStorage");
+#endif
+#ifndef GL_VERSION_4_5
+    glad_glCreateBuffers = (PFNGLCREATEBUFFERSPROC)load("glCreateBuffers");
+    glad_glNamedBufferStorage = (PFNGLNAMEDBUFFERSTORAGEPROC)load("glNamedBufferStorage");
+    glad_glNamedBufferData = (PFNGLNAMEDBUFFERDATAPROC)load("glNamedBufferData");
+    glad_glCreateVertexArrays = (PFNGLCREATEVERTEXARRAYSPROC)load("glCreateVertexArrays");
+    glad_glVertexArrayVertexBuffer = (PFNGLVERTEXARRAYVERTEXBUFFERPROC)load("glVertexArrayVertexBuffer");
+    glad_glVertexArrayAttribFormat = (PFNGLVERTEXARRAYATTRIBFORMATPROC)load("glVertexArrayAttribFormat");
+    glad_glVertexArrayAttribBinding = (PFNGLVERTEXARRAYATTRIBBINDINGPROC)load("glVertexArrayAttribBinding");
+    glad_glEnableVertexArrayAttrib = (PFNGLENABLEVERTEXARRAYATTRIBPROC)load("glEnableVertexArrayAttrib");
+    glad_glVertexArrayBindingDivisor = (PFNGLVERTEXARRAYBINDINGDIVISORPROC)load("glVertexArrayBindingDivisor");
+#endif
+#ifndef GL_KHR_parallel_shader_compile
+    // The ARB extension has the same entry point and tokens under another suffix.
+    glad_glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsKHR");
+    if (!glad_glMaxShaderCompilerThreadsKHR)
+    {
+        glad_glMaxShaderCompilerThreadsKHR =
+            (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsARB");
+    }
+#endif
+
+    glCapabilities = GLCapabilities();
+    glCapabilities.bufferStorage = glBufferStorage &&
+        (hasGLVersion(4, 4) || hasGLExtension("GL_ARB_buffer_storage"));
+    glCapabilities.shaderStorageBuffers =
+        hasGLVersion(4, 3) || hasGLExtension("GL_ARB_shader_storage_buffer_object");
+    glCapabilities.computeShaders = glDispatchCompute && glMemoryBarrier && glDrawArraysIndirect &&
+        glCapabilities.shaderStorageBuffers && (hasGLVersion(4, 3) || hasGLExtension("GL_ARB_compute_shader"));
+    glCapabilities.transformFeedbackDraw = glGenTransformFeedbacks && glBindTransformFeedback &&
+        glDrawTransformFeedback && (hasGLVersion(4, 0) || hasGLExtension("GL_ARB_transform_feedback2"));
+    glCapabilities.directStateAccess = glCreateBuffers && glNamedBufferStorage && glNamedBufferData &&
+        glCreateVertexArrays && glVertexArrayVertexBuffer && glVertexArrayAttribFormat && glVertexArrayAttribBinding &&
+        glEnableVertexArrayAttrib && glVertexArrayBindingDivisor && (hasGLVersion(4, 5) || hasGLExtension("GL_ARB_direct_state_access"));
+    glCapabilities.parallelShaderCompile = glMaxShaderCompilerThreadsKHR &&
+        (hasGLExtension("GL_KHR_parallel_shader_compile") || hasGLExtension("GL_ARB_parallel_shader_compile"));
+}
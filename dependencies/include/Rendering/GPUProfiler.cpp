@@ -0,0 +1,229 @@
+#include "GPUProfiler.h"
+
+#include <fstream>
+#include <iomanip>
+
+GPUProfiler::GPUProfiler(int latency, size_t window, bool gpuTimers)
+    : frames(std::max(latency, 1)), window(window), gpuTimers(gpuTimers)
+{
+}
+
+GPUProfiler::~GPUProfiler()
+{
+    for (Frame& frame : frames)
+    {
+        if (!frame.queries.empty())
+        {
+            glDeleteQueries((GLsizei)frame.queries.size(), frame.queries.data());
+        }
+    }
+}
+
+void GPUProfiler::beginFrame()
+{
+    Frame& frame = frames[frameIndex];
+    collect(frame);
+    frame.usedQueries = 0;
+    frame.intervals.clear();
+
+    std::fill(cpuFrameSums.begin(), cpuFrameSums.end(), 0.0);
+    std::fill(cpuFramePasses.begin(), cpuFramePasses.end(), false);
+}
+
+void GPUProfiler::endFrame()
+{
+    for (size_t pass = 0; pass < passes.size(); ++pass)
+    {
+        if (cpuFramePasses[pass])
+        {
+            passes[pass].cpu.add(cpuFrameSums[pass]);
+        }
+    }
+
+    frameIndex = (frameIndex + 1) % (int)frames.size();
+}
+
+void GPUProfiler::beginPass(const char* name)
+{
+    Frame& frame = frames[frameIndex];
+    int pass = findOrAddPass(name);
+
+    GLuint begin = 0;
+    if (gpuTimers)
+    {
+        begin = nextQuery(frame);
+        glQueryCounter(begin, GL_TIMESTAMP);
+    }
+    frame.intervals.push_back({pass, passes[pass].generation, begin, 0});
+    openPasses.push_back({(int)frame.intervals.size() - 1, std::chrono::steady_clock::now()});
+}
+
+void GPUProfiler::endPass()
+{
+    if (openPasses.empty())
+    {
+        return;
+    }
+
+    OpenPass open = openPasses.back();
+    openPasses.pop_back();
+
+    Frame& frame = frames[frameIndex];
+    Interval& interval = frame.intervals[open.interval];
+    if (gpuTimers)
+    {
+        interval.end = nextQuery(frame);
+        glQueryCounter(interval.end, GL_TIMESTAMP);
+    }
+
+    std::chrono::duration<double, std::milli> cpuTime = std::chrono::steady_clock::now() - open.cpuStart;
+    cpuFrameSums[interval.pass] += cpuTime.count();
+    cpuFramePasses[interval.pass] = true;
+}
+
+const GPUProfiler::PassTimes* GPUProfiler::findPass(const char* name) const
+{
+    for (const PassTimes& pass : passes)
+    {
+        if (pass.name == name)
+        {
+            return &pass;
+        }
+    }
+    return nullptr;
+}
+
+void GPUProfiler::resetPass(const char* name)
+{
+    PassTimes& pass = passes[findOrAddPass(name)];
+    pass.gpu.clear();
+    pass.cpu.clear();
+    pass.generation++;
+}
+
+void GPUProfiler::print(std::ostream& out) const
+{
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::left << std::setw(15) << "Pass" << std::right;
+    for (const char* column : {"GPU avg", "p50", "p95", "p99", "CPU avg", "p50", "p95", "p99"})
+    {
+        out << std::setw(9) << column;
+    }
+    out << "  (ms, last " << window << " frames)" << std::endl;
+
+    out << std::fixed << std::setprecision(3);
+    for (const PassTimes& pass : passes)
+    {
+        out << std::left << std::setw(15) << pass.name << std::right;
+        for (const RollingStats* stats : {&pass.gpu, &pass.cpu})
+        {
+            out << std::setw(9) << stats->getAverage() << std::setw(9) << stats->getPercentile(50.0)
+                << std::setw(9) << stats->getPercentile(95.0) << std::setw(9) << stats->getPercentile(99.0);
+        }
+        out << std::endl;
+    }
+    out.flags(flags);
+    out.precision(precision);
+
+    if (droppedFrames > 0)
+    {
+        out << droppedFrames << " frames dropped, results not ready after " << frames.size() << " frames"
+            << std::endl;
+    }
+}
+
+bool GPUProfiler::exportCSV(const std::string& path) const
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+
+    file << "pass,samples,gpu_avg_ms,gpu_p50_ms,gpu_p95_ms,gpu_p99_ms,gpu_max_ms,"
+            "cpu_avg_ms,cpu_p50_ms,cpu_p95_ms,cpu_p99_ms,cpu_max_ms\n";
+    for (const PassTimes& pass : passes)
+    {
+        file << pass.name << "," << pass.gpu.getCount();
+        for (const RollingStats* stats : {&pass.gpu, &pass.cpu})
+        {
+            file << "," << stats->getAverage() << "," << stats->getPercentile(50.0) << ","
+                << stats->getPercentile(95.0) << "," << stats->getPercentile(99.0) << "," << stats->getMax();
+        }
+        file << "\n";
+    }
+    return true;
+}
+
+int GPUProfiler::findOrAddPass(const char* name)
+{
+    for (size_t pass = 0; pass < passes.size(); ++pass)
+    {
+        if (passes[pass].name == name)
+        {
+            return (int)pass;
+        }
+    }
+
+    passes.push_back({name, RollingStats(window), RollingStats(window)});
+    frameSums.push_back(0.0);
+    gpuFramePasses.push_back(false);
+    cpuFrameSums.push_back(0.0);
+    cpuFramePasses.push_back(false);
+    return (int)passes.size() - 1;
+}
+
+GLuint GPUProfiler::nextQuery(Frame& frame)
+{
+    if (frame.usedQueries == (int)frame.queries.size())
+    {
+        GLuint query = 0;
+        glGenQueries(1, &query);
+        frame.queries.push_back(query);
+    }
+    return frame.queries[frame.usedQueries++];
+}
+
+void GPUProfiler::collect(Frame& frame)
+{
+    if (frame.intervals.empty() || !gpuTimers)
+    {
+        return;
+    }
+
+    // Queries finish in order, so the last one being ready means all of them are.
+    GLint available = 0;
+    glGetQueryObjectiv(frame.queries[frame.usedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+    {
+        droppedFrames++;
+        return;
+    }
+
+    std::fill(frameSums.begin(), frameSums.end(), 0.0);
+    std::fill(gpuFramePasses.begin(), gpuFramePasses.end(), false);
+    for (const Interval& interval : frame.intervals)
+    {
+        if (interval.end == 0 || interval.generation != passes[interval.pass].generation)
+        {
+            continue;
+        }
+
+        GLuint64 begin = 0;
+        GLuint64 end = 0;
+        glGetQueryObjectui64v(interval.begin, GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(interval.end, GL_QUERY_RESULT, &end);
+        frameSums[interval.pass] += (end - begin) / 1e6;
+        gpuFramePasses[interval.pass] = true;
+    }
+
+    for (size_t pass = 0; pass < passes.size(); ++pass)
+    {
+        if (gpuFramePasses[pass])
+        {
+            passes[pass].gpu.add(frameSums[pass]);
+        }
+    }
+    collectedFrames++;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "GLExtensions.h"
+#include "RollingStats.h"
+
+// GPU and CPU time of named render passes. Each pass is bracketed by two
+// GL_TIMESTAMP queries (which, unlike GL_TIME_ELAPSED, may nest and overlap
+// other timer queries). The queries of a frame are only read back `latency`
+// frames later, when the GPU has long finished them; if they are still not
+// available the frame's results are dropped rather than waited for, so the
+// profiler never stalls the pipeline.
+//
+// Passes with the same name in one frame are summed. Every pass keeps rolling
+// windows of its GPU and CPU times for averages and percentiles. Without GPU
+// timers no query is issued and only the CPU times are kept.
+class GPUProfiler
+{
+public:
+    struct PassTimes
+    {
+        std::string name;
+        RollingStats gpu;
+        RollingStats cpu;
+        // Bumped by resetPass, so results still in flight are not mixed in.
+        int generation = 0;
+    };
+
+    explicit GPUProfiler(int latency = 4, size_t window = 240, bool gpuTimers = true);
+    ~GPUProfiler();
+
+    GPUProfiler(const GPUProfiler&) = delete;
+    GPUProfiler& operator=(const GPUProfiler&) = delete;
+
+    // Collects the frame that is `latency` frames old, then starts a new one.
+    void beginFrame();
+    void endFrame();
+
+    void beginPass(const char* name);
+    void endPass();
+
+    const std::vector<PassTimes>& getPasses() const { return passes; }
+    const PassTimes* findPass(const char* name) const;
+    void resetPass(const char* name);
+    long long getDroppedFrames() const { return droppedFrames; }
+    // Frames whose results have been read back; changes when new samples arrived.
+    long long getCollectedFrames() const { return collectedFrames; }
+
+    // Table of averages and percentiles, in milliseconds.
+    void print(std::ostream& out) const;
+    bool exportCSV(const std::string& path) const;
+
+private:
+    struct Interval
+    {
+        int pass;
+        int generation;
+        GLuint begin;
+        GLuint end;
+    };
+
+    struct OpenPass
+    {
+        int interval;
+        std::chrono::steady_clock::time_point cpuStart;
+    };
+
+    struct Frame
+    {
+        std::vector<GLuint> queries;
+        int usedQueries = 0;
+        std::vector<Interval> intervals;
+    };
+
+    int findOrAddPass(const char* name);
+    GLuint nextQuery(Frame& frame);
+    void collect(Frame& frame);
+
+    std::vector<Frame> frames;
+    int frameIndex = 0;
+    size_t window;
+    bool gpuTimers;
+    std::vector<PassTimes> passes;
+    std::vector<OpenPass> openPasses;
+    // Per pass sums of the current frame, added to the windows once per frame.
+    std::vector<double> frameSums;
+    std::vector<bool> gpuFramePasses;
+    std::vector<double> cpuFrameSums;
+    std::vector<bool> cpuFramePasses;
+    long long droppedFrames = 0;
+    long long collectedFrames = 0;
+};
@@ -0,0 +1,148 @@
+#include "HeadlessContext.h"
+
+#include <cstring>
+#include <iostream>
+
+#ifdef HEADLESS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+HeadlessContext::~HeadlessContext()
+{
+#ifdef HEADLESS_EGL
+    if (display)
+    {
+        if (context)
+        {
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+            if (framebuffer)
+            {
+                glDeleteFramebuffers(1, &framebuffer);
+                glDeleteRenderbuffers(1, &colorBuffer);
+                glDeleteRenderbuffers(1, &depthStencilBuffer);
+            }
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            eglDestroyContext(display, context);
+        }
+        eglTerminate(display);
+    }
+#endif
+}
+
+bool HeadlessContext::create(int width, int height)
+{
+    this->width = width;
+    this->height = height;
+
+#ifdef HEADLESS_EGL
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (clientExtensions && strstr(clientExtensions, "EGL_MESA_platform_surfaceless") && getPlatformDisplay)
+    {
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    else
+    {
+        // Other vendors' default display can usually run without a surface as well.
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLint major = 0;
+    EGLint minor = 0;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+    {
+        std::cerr << "Headless: failed to initialize an EGL display" << std::endl;
+        display = nullptr;
+        return false;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        std::cerr << "Headless: EGL display has no desktop OpenGL support" << std::endl;
+        return false;
+    }
+
+    EGLint configAttributes[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+    EGLConfig config = nullptr;
+    EGLint configCount = 0;
+    eglChooseConfig(display, configAttributes, &config, 1, &configCount);
+
+    EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 6,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    context = eglCreateContext(display, configCount > 0 ? config : EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT,
+                               contextAttributes);
+    if (context == EGL_NO_CONTEXT)
+    {
+        std::cerr << "Headless: failed to create an OpenGL 4.6 core context (EGL error 0x" << std::hex
+            << eglGetError() << std::dec << ")" << std::endl;
+        context = nullptr;
+        return false;
+    }
+
+    std::cout << "Headless: EGL " << major << "." << minor << ", " << width << "x" << height << " framebuffer"
+        << std::endl;
+    return true;
+#else
+    std::cerr << "Headless: built without EGL support (HEADLESS_EGL)" << std::endl;
+    return false;
+#endif
+}
+
+void HeadlessContext::makeCurrent()
+{
+#ifdef HEADLESS_EGL
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+#endif
+}
+
+void HeadlessContext::releaseCurrent()
+{
+#ifdef HEADLESS_EGL
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+#endif
+}
+
+void HeadlessContext::createFramebuffer()
+{
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    // The overdraw view counts fragments in the stencil buffer, so keep one like a window would.
+    glGenRenderbuffers(1, &depthStencilBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthStencilBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthStencilBuffer);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cerr << "Headless: offscreen framebuffer is incomplete" << std::endl;
+    }
+}
+
+void HeadlessContext::readPixels(std::vector<unsigned char>& pixels) const
+{
+    pixels.resize((size_t)width * height * 3);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+}
+
+void* HeadlessContext::getProcAddress(const char* name)
+{
+#ifdef HEADLESS_EGL
+    return (void*)eglGetProcAddress(name);
+#else
+    return nullptr;
+#endif
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include "GLExtensions.h"
+
+// Offscreen OpenGL context for machines without a display server. The context is
+// created on EGL's surfaceless platform (EGL_MESA_platform_surfaceless, which Mesa's
+// llvmpipe provides without a GPU) and has no default framebuffer, so everything is
+// drawn into a framebuffer object of the requested size instead.
+//
+// Only available when built with HEADLESS_EGL; otherwise create() reports the
+// missing backend and fails.
+class HeadlessContext
+{
+public:
+    HeadlessContext() = default;
+    ~HeadlessContext();
+
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    // Creates a GL 4.6 core context. Prints the reason and returns false on failure.
+    bool create(int width, int height);
+    void makeCurrent();
+    void releaseCurrent();
+
+    // Needs the context current and GLAD loaded. Leaves the framebuffer bound,
+    // where it stays as the target of every frame.
+    void createFramebuffer();
+    // Color attachment as tightly packed RGB rows, bottom row first.
+    void readPixels(std::vector<unsigned char>& pixels) const;
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    GLuint getFramebuffer() const { return framebuffer; }
+
+    // Loader for gladLoadGLLoader and loadGLExtensions.
+    static void* getProcAddress(const char* name);
+
+private:
+    // EGLDisplay and EGLContext, kept opaque so users don't pull in the EGL headers.
+    void* display = nullptr;
+    void* context = nullptr;
+    GLuint framebuffer = 0;
+    GLuint colorBuffer = 0;
+    GLuint depthStencilBuffer = 0;
+    int width = 0;
+    int height = 0;
+};
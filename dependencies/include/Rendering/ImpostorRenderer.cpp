@@ -0,0 +1,251 @@
+#include "ImpostorRenderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <glm/glm/gtc/matrix_transform.hpp>
+#include "GLExtensions.h"
+
+ImpostorRenderer::ImpostorRenderer(Shader* bakeShader, Shader* drawShader, const ImpostorSettings& settings)
+    : bakeShader(bakeShader), drawShader(drawShader), settings(settings)
+{
+    this->settings.views = std::max(this->settings.views, 2);
+    this->settings.viewSize = std::max(this->settings.viewSize, 16);
+    int atlasSize = this->settings.views * this->settings.viewSize;
+
+    glUseProgram(bakeShader->ID);
+    glUniform1i(glGetUniformLocation(bakeShader->ID, "colorBuffer"), 0);
+    viewProjectionLoc = glGetUniformLocation(bakeShader->ID, "viewProjection");
+
+    glUseProgram(drawShader->ID);
+    glUniform1i(glGetUniformLocation(drawShader->ID, "impostorAlbedo"), ALBEDO_TEXTURE_UNIT);
+    glUniform1i(glGetUniformLocation(drawShader->ID, "impostorNormals"), NORMAL_TEXTURE_UNIT);
+    glUniform1i(glGetUniformLocation(drawShader->ID, "impostorViews"), this->settings.views);
+    modelLoc = glGetUniformLocation(drawShader->ID, "model");
+    normalMatrixLoc = glGetUniformLocation(drawShader->ID, "normalMatrix");
+    boundsCenterLoc = glGetUniformLocation(drawShader->ID, "boundsCenter");
+    boundsRadiusLoc = glGetUniformLocation(drawShader->ID, "boundsRadius");
+    modelCameraLoc = glGetUniformLocation(drawShader->ID, "modelCamera");
+    fadeLoc = glGetUniformLocation(drawShader->ID, "impostorFade");
+    materialIndexLoc = glGetUniformLocation(drawShader->ID, "materialIndex");
+    cameraPosLoc = glGetUniformLocation(drawShader->ID, "cameraPos");
+    glUseProgram(0);
+
+    // One depth buffer for every bake; the color attachments are the atlas textures.
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, atlasSize, atlasSize);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    GLint boundFramebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &boundFramebuffer);
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    const GLenum drawBuffers[2] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+    glDrawBuffers(2, drawBuffers);
+    glBindFramebuffer(GL_FRAMEBUFFER, boundFramebuffer);
+
+    // The quad's corners come from gl_VertexID.
+    glGenVertexArrays(1, &quadVAO);
+}
+
+ImpostorRenderer::~ImpostorRenderer()
+{
+    for (Atlas& atlas : atlases)
+    {
+        glDeleteTextures(1, &atlas.albedoTexture);
+        glDeleteTextures(1, &atlas.normalTexture);
+    }
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &depthBuffer);
+    glDeleteVertexArrays(1, &quadVAO);
+}
+
+float ImpostorRenderer::getFade(float distance, float radius, float projectionScale) const
+{
+    if (settings.distance <= 0.0f)
+    {
+        return 0.0f;
+    }
+    // Closer than this, the atlas would be magnified.
+    float start = std::max(settings.distance, 2.0f * radius * projectionScale / (float)settings.viewSize);
+    if (settings.fadeRange <= 0.0f)
+    {
+        return distance >= start ? 1.0f : 0.0f;
+    }
+    return std::clamp((distance - start) / settings.fadeRange, 0.0f, 1.0f);
+}
+
+void ImpostorRenderer::getViewBasis(const glm::vec3& direction, glm::vec3& right, glm::vec3& up)
+{
+    glm::vec3 reference = std::abs(direction.y) > 0.999f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    right = glm::normalize(glm::cross(reference, direction));
+    up = glm::cross(direction, right);
+}
+
+glm::vec3 ImpostorRenderer::getViewDirection(int x, int y, int views)
+{
+    // Octahedral decoding with +y at the center of the atlas, as in fragment_impostor.glsl.
+    glm::vec2 p = (glm::vec2((float)x, (float)y) + 0.5f) / (float)views * 2.0f - 1.0f;
+    glm::vec3 direction(p.x, 1.0f - std::abs(p.x) - std::abs(p.y), p.y);
+    float fold = std::max(-direction.y, 0.0f);
+    direction.x += direction.x >= 0.0f ? -fold : fold;
+    direction.z += direction.z >= 0.0f ? -fold : fold;
+    return glm::normalize(direction);
+}
+
+ImpostorRenderer::Atlas* ImpostorRenderer::findAtlas(GLuint VAO)
+{
+    for (Atlas& atlas : atlases)
+    {
+        if (atlas.VAO == VAO)
+        {
+            return &atlas;
+        }
+    }
+    return nullptr;
+}
+
+int ImpostorRenderer::prepare(const std::vector<DrawItem>& items, const std::vector<float>& fades,
+                              CommandBuffer& commands, GLuint framebuffer, int width, int height)
+{
+    int baked = 0;
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        const DrawItem& item = items[i];
+        if (fades[i] <= 0.0f || item.boundsRadius <= 0.0f)
+        {
+            continue;
+        }
+
+        Atlas* atlas = findAtlas(item.VAO);
+        if (atlas && atlas->sourceTexture == item.textureID)
+        {
+            continue;
+        }
+        if (!atlas)
+        {
+            atlases.push_back(Atlas());
+            atlas = &atlases.back();
+            atlas->VAO = item.VAO;
+            createTextures(*atlas);
+        }
+        bake(commands, *atlas, item);
+        baked++;
+    }
+
+    if (baked > 0)
+    {
+        commands.bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        commands.viewport(0, 0, width, height);
+    }
+    return baked;
+}
+
+void ImpostorRenderer::createTextures(Atlas& atlas)
+{
+    int atlasSize = settings.views * settings.viewSize;
+    // Mip levels down to 4x4 texels per view, so views never bleed into each other.
+    int maxLevel = std::max((int)std::log2((float)settings.viewSize) - 2, 0);
+    for (GLuint* texture : {&atlas.albedoTexture, &atlas.normalTexture})
+    {
+        glGenTextures(1, texture);
+        glBindTexture(GL_TEXTURE_2D, *texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, atlasSize, atlasSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, maxLevel);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // Bakes attach the textures through the commands; they are checked once here.
+    GLint boundFramebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &boundFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, atlas.albedoTexture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, atlas.normalTexture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cerr << "ImpostorRenderer: atlas framebuffer is incomplete" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, boundFramebuffer);
+}
+
+void ImpostorRenderer::bake(CommandBuffer& commands, Atlas& atlas, const DrawItem& item)
+{
+    int atlasSize = settings.views * settings.viewSize;
+    atlas.sourceTexture = item.textureID;
+
+    commands.bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    commands.framebufferTexture(GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, atlas.albedoTexture, 0);
+    commands.framebufferTexture(GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, atlas.normalTexture, 0);
+    commands.viewport(0, 0, atlasSize, atlasSize);
+    commands.clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, glm::vec4(0.0f));
+
+    commands.useProgram(bakeShader->ID);
+    commands.bindTexture(0, GL_TEXTURE_2D, item.textureID);
+    commands.bindVertexArray(item.VAO);
+
+    // Every view looks at the bounding sphere from two radii away and fits it exactly.
+    float radius = item.boundsRadius;
+    glm::mat4 projection = glm::ortho(-radius, radius, -radius, radius, radius * 0.5f, radius * 3.5f);
+    for (int y = 0; y < settings.views; ++y)
+    {
+        for (int x = 0; x < settings.views; ++x)
+        {
+            glm::vec3 direction = getViewDirection(x, y, settings.views);
+            glm::vec3 right;
+            glm::vec3 up;
+            getViewBasis(direction, right, up);
+            glm::mat4 view = glm::lookAt(item.boundsCenter + direction * radius * 2.0f, item.boundsCenter, up);
+            glm::mat4 viewProjection = projection * view;
+
+            commands.viewport(x * settings.viewSize, y * settings.viewSize, settings.viewSize, settings.viewSize);
+            commands.setUniform(viewProjectionLoc, viewProjection);
+            commands.drawArrays(GL_TRIANGLES, 0, item.vertexCount);
+        }
+    }
+
+    for (GLuint texture : {atlas.albedoTexture, atlas.normalTexture})
+    {
+        commands.bindTexture(0, GL_TEXTURE_2D, texture);
+        commands.generateMipmap(0, GL_TEXTURE_2D);
+    }
+    commands.bindTexture(0, GL_TEXTURE_2D, 0);
+    commands.bindVertexArray(0);
+}
+
+void ImpostorRenderer::begin(CommandBuffer& commands, const glm::vec3& cameraPosition)
+{
+    this->cameraPosition = cameraPosition;
+    commands.useProgram(drawShader->ID);
+    commands.setUniform(cameraPosLoc, cameraPosition);
+    commands.bindVertexArray(quadVAO);
+}
+
+bool ImpostorRenderer::draw(CommandBuffer& commands, const DrawItem& item, const glm::mat4& model,
+                            const glm::mat3& normalMatrix, float fade)
+{
+    Atlas* atlas = findAtlas(item.VAO);
+    if (!atlas)
+    {
+        return false;
+    }
+
+    glm::vec3 modelCamera = glm::vec3(glm::inverse(model) * glm::vec4(cameraPosition, 1.0f));
+    commands.setUniform(modelLoc, model);
+    commands.setUniform(normalMatrixLoc, normalMatrix);
+    commands.setUniform(boundsCenterLoc, item.boundsCenter);
+    commands.setUniform(boundsRadiusLoc, item.boundsRadius);
+    commands.setUniform(modelCameraLoc, modelCamera);
+    commands.setUniform(fadeLoc, fade);
+    commands.setUniform(materialIndexLoc, (int)item.materialIndex);
+
+    commands.bindTexture(ALBEDO_TEXTURE_UNIT, GL_TEXTURE_2D, atlas->albedoTexture);
+    commands.bindTexture(NORMAL_TEXTURE_UNIT, GL_TEXTURE_2D, atlas->normalTexture);
+    commands.drawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    return true;
+}
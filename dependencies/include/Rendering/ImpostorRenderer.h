@@ -0,0 +1,105 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm/glm.hpp>
+#include <shader/Shader.h>
+#include <Simulation/FrameSnapshot.h>
+#include "CommandBuffer.h"
+
+struct ImpostorSettings
+{
+    // Camera distance at which a mesh starts handing its pixels over to its impostor.
+    float distance = 30.0f;
+    // Length of the crossfade; beyond distance + fadeRange only the impostor is drawn.
+    float fadeRange = 6.0f;
+    // Views per side of the octahedral atlas, and pixels per side of each view.
+    int views = 8;
+    int viewSize = 128;
+};
+
+// Camera-facing quads standing in for distant meshes.
+//
+// The first time a mesh is far enough away, it is rendered into an atlas of
+// views x views orthographic views of its bounding sphere, one per cell of an
+// octahedral map of the directions around it: albedo in one texture, model
+// space normals and depth in another. The quad then blends the four views
+// closest to the camera direction, writes the baked depth, and lights the result
+// with the object shader's lighting, so lights, shadows and material
+// coefficients still apply. Only the texture is baked into the atlas; a mesh
+// drawn with a different one is baked again.
+//
+// Over the fade range the mesh (drawn with the object shader built with
+// IMPOSTOR_FADE) and the impostor each cover the complementary part of an
+// ordered dither pattern, so the two crossfade without sorting or blending.
+class ImpostorRenderer
+{
+public:
+    ImpostorRenderer(Shader* bakeShader, Shader* drawShader, const ImpostorSettings& settings);
+    ~ImpostorRenderer();
+
+    ImpostorRenderer(const ImpostorRenderer&) = delete;
+    ImpostorRenderer& operator=(const ImpostorRenderer&) = delete;
+
+    // 0 while only the mesh is drawn, 1 once only the impostor is. The fade
+    // starts at the configured distance, or later for a mesh whose bounding
+    // sphere (of world radius radius) would still look larger than one view of
+    // the atlas; projectionScale is the pixels per world unit at distance one.
+    float getFade(float distance, float radius, float projectionScale) const;
+
+    // Records baking the atlases missing for the items with a fade above zero,
+    // then binding framebuffer back with a width x height viewport. Bakes rely
+    // on the default depth and stencil state. Returns the number baked.
+    int prepare(const std::vector<DrawItem>& items, const std::vector<float>& fades, CommandBuffer& commands,
+                GLuint framebuffer, int width, int height);
+
+    // Records binding the draw program and the quad's vertex array.
+    void begin(CommandBuffer& commands, const glm::vec3& cameraPosition);
+    // Records the draw of the impostor of a prepared item. Returns false if it has no atlas.
+    bool draw(CommandBuffer& commands, const DrawItem& item, const glm::mat4& model, const glm::mat3& normalMatrix,
+              float fade);
+
+    int getAtlasCount() const { return (int)atlases.size(); }
+    const ImpostorSettings& getSettings() const { return settings; }
+
+    // Axes of the view looking back along direction; the shaders use the same.
+    static void getViewBasis(const glm::vec3& direction, glm::vec3& right, glm::vec3& up);
+    // Direction of the center of an octahedral atlas cell.
+    static glm::vec3 getViewDirection(int x, int y, int views);
+
+    static constexpr GLint ALBEDO_TEXTURE_UNIT = 0;
+    static constexpr GLint NORMAL_TEXTURE_UNIT = 1;
+
+private:
+    struct Atlas
+    {
+        GLuint VAO = 0;
+        // Texture the atlas was baked with.
+        GLuint sourceTexture = 0;
+        GLuint albedoTexture = 0;
+        GLuint normalTexture = 0;
+    };
+
+    Atlas* findAtlas(GLuint VAO);
+    void createTextures(Atlas& atlas);
+    void bake(CommandBuffer& commands, Atlas& atlas, const DrawItem& item);
+
+    Shader* bakeShader;
+    Shader* drawShader;
+    ImpostorSettings settings;
+    GLuint framebuffer = 0;
+    GLuint depthBuffer = 0;
+    GLuint quadVAO = 0;
+    // A few meshes at most, so a linear search is enough.
+    std::vector<Atlas> atlases;
+
+    GLint viewProjectionLoc = -1;
+    GLint modelLoc = -1;
+    GLint normalMatrixLoc = -1;
+    GLint boundsCenterLoc = -1;
+    GLint boundsRadiusLoc = -1;
+    GLint modelCameraLoc = -1;
+    GLint fadeLoc = -1;
+    GLint materialIndexLoc = -1;
+    GLint cameraPosLoc = -1;
+    glm::vec3 cameraPosition = glm::vec3(0.0f);
+};
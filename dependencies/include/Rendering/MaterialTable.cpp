@@ -0,0 +1,52 @@
+#include "MaterialTable.h"
+
+#include <algorithm>
+#include "GLExtensions.h"
+#include "VertexArrays.h"
+
+MaterialTable::~MaterialTable()
+{
+    glDeleteBuffers(1, &buffer);
+}
+
+MaterialIndex MaterialTable::add(const Material& material)
+{
+    // A handful of materials per model, so a linear search is enough.
+    auto found = std::find(materials.begin(), materials.end(), material);
+    if (found != materials.end())
+    {
+        return (MaterialIndex)(found - materials.begin());
+    }
+
+    materials.push_back(material);
+    return (MaterialIndex)materials.size() - 1;
+}
+
+void MaterialTable::upload()
+{
+    if (materials.empty())
+    {
+        materials.push_back(Material());
+    }
+
+    std::vector<MaterialData> data;
+    data.reserve(materials.size());
+    for (const Material& material : materials)
+    {
+        MaterialData entry = {};
+        entry.ka = material.ka;
+        entry.shininess = material.shininess;
+        entry.kd = material.kd;
+        entry.ks = material.ks;
+        entry.ke = material.ke;
+        data.push_back(entry);
+    }
+
+    glDeleteBuffers(1, &buffer);
+    buffer = createStaticBuffer(data.data(), data.size() * sizeof(MaterialData));
+}
+
+void MaterialTable::bind(CommandBuffer& commands) const
+{
+    commands.bindBufferRange(GL_SHADER_STORAGE_BUFFER, BINDING, buffer, 0, 0);
+}
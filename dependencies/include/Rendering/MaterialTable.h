@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+#include <GLAD/glad.h>
+#include <glm/glm/glm.hpp>
+#include <Scene/Components.h>
+#include "CommandBuffer.h"
+
+// Matches the std430 layout of MaterialData in the object and impostor fragment shaders.
+struct MaterialData
+{
+    glm::vec3 ka;
+    float shininess;
+    glm::vec3 kd;
+    float padding0;
+    glm::vec3 ks;
+    float padding1;
+    glm::vec3 ke;
+    float padding2;
+};
+
+// Every material of the loaded models, deduplicated, packed into one shader
+// storage buffer. A draw selects its material with a single index uniform
+// instead of setting each coefficient, so draws of different materials can
+// share a program without any other uniform change in between.
+class MaterialTable
+{
+public:
+    MaterialTable() = default;
+    ~MaterialTable();
+
+    MaterialTable(const MaterialTable&) = delete;
+    MaterialTable& operator=(const MaterialTable&) = delete;
+
+    // Index of an identical material already in the table, or of the added one.
+    MaterialIndex add(const Material& material);
+
+    // Creates the buffer from the materials added so far. An empty table
+    // uploads the default material, so index 0 is always valid.
+    void upload();
+    // Records binding the buffer to BINDING for the shaders that read it.
+    void bind(CommandBuffer& commands) const;
+
+    int getCount() const { return (int)materials.size(); }
+
+    static constexpr GLuint BINDING = 6;
+
+private:
+    std::vector<Material> materials;
+    GLuint buffer = 0;
+};
@@ -0,0 +1,136 @@
+#include "ObjLoader.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+bool loadObject(
+    const char* path,
+    std::vector<glm::vec3>& out_vertices,
+    std::vector<glm::vec2>& out_uvs,
+    std::vector<glm::vec3>& out_normals,
+    std::string* materialLibrary)
+{
+    std::ifstream file(path);
+
+    if (!file)
+    {
+        std::cerr << "Failed to open file: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<unsigned int> vertexIndices, uvIndices, normalIndices;
+    std::vector<glm::vec3> temp_vertices;
+    std::vector<glm::vec2> temp_uvs;
+    std::vector<glm::vec3> temp_normals;
+
+    std::string line;
+
+    while (std::getline(file, line))
+    {
+        std::istringstream iss(line);
+        std::string type;
+        iss >> type;
+
+        if (type == "v")
+        {
+            glm::vec3 vertex;
+            iss >> vertex.x >> vertex.y >> vertex.z;
+            temp_vertices.push_back(vertex);
+        }
+        else if (type == "vt")
+        {
+            glm::vec2 uv;
+            iss >> uv.x >> uv.y;
+            temp_uvs.push_back(uv);
+        }
+        else if (type == "vn")
+        {
+            glm::vec3 normal;
+            iss >> normal.x >> normal.y >> normal.z;
+            temp_normals.push_back(normal);
+        }
+        else if (type == "f")
+        {
+            unsigned int vertexIndex[3], uvIndex[3], normalIndex[3];
+            char slash;
+
+            for (int i = 0; i < 3; ++i)
+            {
+                iss >> vertexIndex[i] >> slash >> uvIndex[i] >> slash >> normalIndex[i];
+                vertexIndices.push_back(vertexIndex[i]);
+                uvIndices.push_back(uvIndex[i]);
+                normalIndices.push_back(normalIndex[i]);
+            }
+        }
+        else if (type == "mtllib" && materialLibrary)
+        {
+            iss >> *materialLibrary;
+        }
+    }
+
+    // Populate output vectors
+    for (unsigned int i = 0; i < vertexIndices.size(); ++i)
+    {
+        unsigned int vertexIndex = vertexIndices[i];
+        unsigned int uvIndex = uvIndices[i];
+        unsigned int normalIndex = normalIndices[i];
+
+        glm::vec3 vertex = temp_vertices[vertexIndex - 1];
+        glm::vec2 uv = temp_uvs[uvIndex - 1];
+        glm::vec3 normal = temp_normals[normalIndex - 1];
+
+        out_vertices.push_back(vertex);
+        out_uvs.push_back(uv);
+        out_normals.push_back(normal);
+    }
+
+    file.close();
+
+    return true;
+}
+
+MTLMaterial loadMTL(const std::string& path)
+{
+    MTLMaterial mat;
+    std::ifstream mtlFile(path);
+    if (!mtlFile)
+    {
+        std::cerr << "Failed to open MTL file: " << path << std::endl;
+        return mat;
+    }
+
+    std::string line;
+    while (std::getline(mtlFile, line))
+    {
+        std::istringstream iss(line);
+        std::string keyword;
+        iss >> keyword;
+
+        if (keyword == "map_Kd")
+        {
+            iss >> mat.texturePath;
+        }
+        else if (keyword == "Ka")
+        {
+            iss >> mat.ka.r >> mat.ka.g >> mat.ka.b;
+        }
+        else if (keyword == "Kd")
+        {
+            iss >> mat.kd.r >> mat.kd.g >> mat.kd.b;
+        }
+        else if (keyword == "Ks")
+        {
+            iss >> mat.ks.r >> mat.ks.g >> mat.ks.b;
+        }
+        else if (keyword == "Ke")
+        {
+            iss >> mat.ke.r >> mat.ke.g >> mat.ke.b;
+        }
+        else if (keyword == "Ns")
+        {
+            iss >> mat.shininess;
+        }
+    }
+    return mat;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glm/glm/glm.hpp>
+
+struct MTLMaterial
+{
+    glm::vec3 ka;
+    glm::vec3 kd;
+    glm::vec3 ks;
+    glm::vec3 ke;
+    float shininess;
+    std::string texturePath;
+};
+
+// Reads a triangulated OBJ with v/vt/vn faces into one vertex per face corner.
+// The material library named by its mtllib line is returned in materialLibrary.
+bool loadObject(const char* path,
+                std::vector<glm::vec3>& out_vertices,
+                std::vector<glm::vec2>& out_uvs,
+                std::vector<glm::vec3>& out_normals,
+                std::string* materialLibrary = nullptr);
+MTLMaterial loadMTL(const std::string& path);
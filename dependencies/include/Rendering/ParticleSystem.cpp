@@ -0,0 +1,497 @@
+#include "ParticleSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include "GLExtensions.h"
+#include "VertexArrays.h"
+
+namespace
+{
+    const std::initializer_list<VertexAttribute> PARTICLE_ATTRIBUTES = {
+        {0, 4, offsetof(Particle, position)}, {1, 4, offsetof(Particle, velocity)}, {2, 4, offsetof(Particle, color)}
+    };
+
+    GLuint compileStage(GLenum type, const std::string& path, const char* stageName)
+    {
+        std::ifstream file(path);
+        std::stringstream stream;
+        stream << file.rdbuf();
+        std::string code = stream.str();
+        if (code.empty())
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+            return 0;
+        }
+
+        const GLchar* source = code.c_str();
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, NULL);
+        glCompileShader(shader);
+
+        GLint success;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success)
+        {
+            GLchar infoLog[512];
+            glGetShaderInfoLog(shader, 512, NULL, infoLog);
+            std::cout << "ERROR::SHADER::" << stageName << "::COMPILATION_FAILED\n" << infoLog << std::endl;
+            glDeleteShader(shader);
+            return 0;
+        }
+        return shader;
+    }
+
+    // Links the stages, capturing the given outputs with transform feedback. Returns 0 on failure.
+    GLuint linkProgram(const std::vector<GLuint>& stages, const std::vector<const GLchar*>& feedbackVaryings)
+    {
+        bool compiled = std::all_of(stages.begin(), stages.end(), [](GLuint stage) { return stage != 0; });
+        GLuint program = 0;
+        if (compiled)
+        {
+            program = glCreateProgram();
+            for (GLuint stage : stages)
+            {
+                glAttachShader(program, stage);
+            }
+            if (!feedbackVaryings.empty())
+            {
+                glTransformFeedbackVaryings(program, (GLsizei)feedbackVaryings.size(), feedbackVaryings.data(),
+                                            GL_INTERLEAVED_ATTRIBS);
+            }
+            glLinkProgram(program);
+
+            GLint success;
+            glGetProgramiv(program, GL_LINK_STATUS, &success);
+            if (!success)
+            {
+                GLchar infoLog[512];
+                glGetProgramInfoLog(program, 512, NULL, infoLog);
+                std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+                glDeleteProgram(program);
+                program = 0;
+            }
+        }
+
+        for (GLuint stage : stages)
+        {
+            if (stage)
+            {
+                glDeleteShader(stage);
+            }
+        }
+        return program;
+    }
+
+    GLuint getGroupCount(int items)
+    {
+        return (GLuint)((items + ParticleSystem::WORK_GROUP_SIZE - 1) / ParticleSystem::WORK_GROUP_SIZE);
+    }
+}
+
+const char* getParticleBackendName(ParticleBackend backend)
+{
+    switch (backend)
+    {
+    case ParticleBackend::Compute:
+        return "compute";
+    case ParticleBackend::TransformFeedback:
+        return "transformFeedback";
+    default:
+        return "cpu";
+    }
+}
+
+void ParticleUniforms::find(GLuint program)
+{
+    emitting = glGetUniformLocation(program, "emitting");
+    sourceIndex = glGetUniformLocation(program, "sourceIndex");
+    destinationIndex = glGetUniformLocation(program, "destinationIndex");
+    capacity = glGetUniformLocation(program, "capacity");
+    dt = glGetUniformLocation(program, "dt");
+    gravity = glGetUniformLocation(program, "gravity");
+    drag = glGetUniformLocation(program, "drag");
+    floorHeight = glGetUniformLocation(program, "floorHeight");
+    restitution = glGetUniformLocation(program, "restitution");
+    burstOrigin = glGetUniformLocation(program, "burstOrigin");
+    burstSeed = glGetUniformLocation(program, "burstSeed");
+    burstCount = glGetUniformLocation(program, "burstCount");
+    cosSpread = glGetUniformLocation(program, "cosSpread");
+    minSpeed = glGetUniformLocation(program, "minSpeed");
+    maxSpeed = glGetUniformLocation(program, "maxSpeed");
+    minLifetime = glGetUniformLocation(program, "minLifetime");
+    maxLifetime = glGetUniformLocation(program, "maxLifetime");
+    colorA = glGetUniformLocation(program, "colorA");
+    colorB = glGetUniformLocation(program, "colorB");
+}
+
+ParticlePrograms::ParticlePrograms(Shader* renderShader, const std::string& computePath,
+                                   const std::string& feedbackVertexPath, const std::string& feedbackGeometryPath)
+    : renderShader(renderShader)
+{
+    particleSizeLoc = glGetUniformLocation(renderShader->ID, "particleSize");
+
+    if (glCapabilities.computeShaders)
+    {
+        computeProgram = linkProgram({compileStage(GL_COMPUTE_SHADER, computePath, "COMPUTE")}, {});
+        computeUniforms.find(computeProgram);
+    }
+
+    if (glCapabilities.transformFeedbackDraw)
+    {
+        feedbackProgram = linkProgram({compileStage(GL_VERTEX_SHADER, feedbackVertexPath, "VERTEX"),
+                                       compileStage(GL_GEOMETRY_SHADER, feedbackGeometryPath, "GEOMETRY")},
+                                      {"outPositionLife", "outVelocityLifetime", "outColor"});
+        feedbackUniforms.find(feedbackProgram);
+    }
+}
+
+ParticlePrograms::~ParticlePrograms()
+{
+    if (computeProgram)
+    {
+        glDeleteProgram(computeProgram);
+    }
+    if (feedbackProgram)
+    {
+        glDeleteProgram(feedbackProgram);
+    }
+}
+
+bool ParticlePrograms::supports(ParticleBackend backend) const
+{
+    switch (backend)
+    {
+    case ParticleBackend::Compute:
+        return computeProgram != 0;
+    case ParticleBackend::TransformFeedback:
+        return feedbackProgram != 0;
+    default:
+        return true;
+    }
+}
+
+ParticleBackend ParticlePrograms::choose(const std::string& name) const
+{
+    for (ParticleBackend backend : {ParticleBackend::Compute, ParticleBackend::TransformFeedback, ParticleBackend::CPU})
+    {
+        if (name == getParticleBackendName(backend))
+        {
+            if (supports(backend))
+            {
+                return backend;
+            }
+            std::cerr << "Particle backend " << name << " unavailable on this context" << std::endl;
+        }
+    }
+
+    if (supports(ParticleBackend::Compute))
+    {
+        return ParticleBackend::Compute;
+    }
+    return supports(ParticleBackend::TransformFeedback) ? ParticleBackend::TransformFeedback : ParticleBackend::CPU;
+}
+
+ParticleSystem::ParticleSystem(ParticleBackend backend, int capacity, const ParticleSettings& settings,
+                               ParticlePrograms* programs, RingBuffer* streamBuffer)
+    : backend(backend),
+      capacity(capacity),
+      settings(settings),
+      programs(programs),
+      streamBuffer(streamBuffer),
+      simulation(backend == ParticleBackend::CPU ? capacity : 0)
+{
+    if (backend == ParticleBackend::CPU)
+    {
+        // The buffer binding is pointed at the ring allocation of every draw.
+        VAOs[0] = createVertexArray(streamBuffer->getBuffer(), sizeof(Particle), PARTICLE_ATTRIBUTES);
+        return;
+    }
+
+    for (int i = 0; i < 2; ++i)
+    {
+        particleBuffers[i] = createBuffer();
+        uploadBuffer(particleBuffers[i], nullptr, (GLsizeiptr)capacity * sizeof(Particle), GL_DYNAMIC_COPY);
+        VAOs[i] = createVertexArray(particleBuffers[i], sizeof(Particle), PARTICLE_ATTRIBUTES);
+    }
+
+    if (backend == ParticleBackend::Compute)
+    {
+        DrawCommand commands[2] = {{0, 1, 0, 0}, {0, 1, 0, 0}};
+        glGenBuffers(1, &commandBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(commands), commands, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+    else
+    {
+        glGenTransformFeedbacks(2, feedbackObjects);
+        for (int i = 0; i < 2; ++i)
+        {
+            glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, feedbackObjects[i]);
+            glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, particleBuffers[i]);
+        }
+        glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
+        glGenQueries(1, &feedbackQuery);
+        glGenVertexArrays(1, &emptyVAO);
+    }
+}
+
+ParticleSystem::~ParticleSystem()
+{
+    glDeleteVertexArrays(backend == ParticleBackend::CPU ? 1 : 2, VAOs);
+    if (backend == ParticleBackend::CPU)
+    {
+        return;
+    }
+
+    glDeleteBuffers(2, particleBuffers);
+    if (commandBuffer)
+    {
+        glDeleteBuffers(1, &commandBuffer);
+    }
+    if (feedbackObjects[0])
+    {
+        glDeleteTransformFeedbacks(2, feedbackObjects);
+        glDeleteQueries(1, &feedbackQuery);
+        glDeleteVertexArrays(1, &emptyVAO);
+    }
+}
+
+GLsizeiptr ParticleSystem::getMaxUploadSize(ParticleBackend backend, int capacity)
+{
+    return backend == ParticleBackend::CPU ? (GLsizeiptr)capacity * sizeof(Particle) + 16 : 0;
+}
+
+void ParticleSystem::emit(const ParticleBurst& burst)
+{
+    if (burst.count > 0)
+    {
+        pendingBursts.push_back(burst);
+    }
+}
+
+void ParticleSystem::update(float dt)
+{
+    if (maxAlive == 0 && pendingBursts.empty())
+    {
+        return;
+    }
+
+    bool simulate = maxAlive > 0;
+    idleTime += dt;
+
+    switch (backend)
+    {
+    case ParticleBackend::Compute:
+        updateCompute(dt, simulate);
+        break;
+    case ParticleBackend::TransformFeedback:
+        updateFeedback(dt, simulate);
+        break;
+    default:
+        if (simulate)
+        {
+            simulation.update(settings, dt);
+        }
+        for (const ParticleBurst& burst : pendingBursts)
+        {
+            simulation.emit(settings, burst);
+        }
+        break;
+    }
+
+    for (const ParticleBurst& burst : pendingBursts)
+    {
+        maxAlive = std::min(maxAlive + burst.count, capacity);
+        idleTime = 0.0f;
+    }
+    pendingBursts.clear();
+
+    if (backend == ParticleBackend::CPU)
+    {
+        maxAlive = simulation.getCount();
+    }
+    else if (idleTime > settings.maxLifetime)
+    {
+        maxAlive = 0;
+    }
+}
+
+void ParticleSystem::setUniforms(const ParticleUniforms& uniforms, float dt)
+{
+    glUniform1ui(uniforms.capacity, (GLuint)capacity);
+    glUniform1f(uniforms.dt, dt);
+    glUniform3f(uniforms.gravity, settings.gravity.x, settings.gravity.y, settings.gravity.z);
+    glUniform1f(uniforms.drag, settings.drag);
+    glUniform1f(uniforms.floorHeight, settings.floorHeight);
+    glUniform1f(uniforms.restitution, settings.restitution);
+}
+
+void ParticleSystem::setBurstUniforms(const ParticleUniforms& uniforms, const ParticleBurst& burst)
+{
+    glUniform3f(uniforms.burstOrigin, burst.origin.x, burst.origin.y, burst.origin.z);
+    glUniform1ui(uniforms.burstSeed, burst.seed);
+    glUniform1ui(uniforms.burstCount, (GLuint)burst.count);
+    glUniform1f(uniforms.cosSpread, std::cos(glm::radians(settings.spreadDegrees)));
+    glUniform1f(uniforms.minSpeed, settings.minSpeed);
+    glUniform1f(uniforms.maxSpeed, settings.maxSpeed);
+    glUniform1f(uniforms.minLifetime, settings.minLifetime);
+    glUniform1f(uniforms.maxLifetime, settings.maxLifetime);
+    glUniform4f(uniforms.colorA, settings.colorA.r, settings.colorA.g, settings.colorA.b, settings.colorA.a);
+    glUniform4f(uniforms.colorB, settings.colorB.r, settings.colorB.g, settings.colorB.b, settings.colorB.a);
+}
+
+void ParticleSystem::updateCompute(float dt, bool simulate)
+{
+    const ParticleUniforms& uniforms = programs->computeUniforms;
+    int destination = 1 - current;
+
+    // The destination starts empty; the barrier at the end of the last update
+    // ordered this write after the shader's atomics.
+    DrawCommand empty = {0, 1, 0, 0};
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, destination * sizeof(DrawCommand), sizeof(DrawCommand), &empty);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    glUseProgram(programs->computeProgram);
+    setUniforms(uniforms, dt);
+    glUniform1ui(uniforms.sourceIndex, (GLuint)current);
+    glUniform1ui(uniforms.destinationIndex, (GLuint)destination);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SOURCE_BINDING, particleBuffers[current]);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DESTINATION_BINDING, particleBuffers[destination]);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COMMANDS_BINDING, commandBuffer);
+
+    if (simulate)
+    {
+        glUniform1i(uniforms.emitting, GL_FALSE);
+        glDispatchCompute(getGroupCount(maxAlive), 1, 1);
+    }
+
+    glUniform1i(uniforms.emitting, GL_TRUE);
+    for (const ParticleBurst& burst : pendingBursts)
+    {
+        // Bursts append behind the survivors.
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        setBurstUniforms(uniforms, burst);
+        glDispatchCompute(getGroupCount(std::min(burst.count, capacity)), 1, 1);
+    }
+
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_COMMAND_BARRIER_BIT |
+                    GL_BUFFER_UPDATE_BARRIER_BIT);
+    current = destination;
+}
+
+void ParticleSystem::updateFeedback(float dt, bool simulate)
+{
+    const ParticleUniforms& uniforms = programs->feedbackUniforms;
+    int destination = 1 - current;
+
+    glUseProgram(programs->feedbackProgram);
+    setUniforms(uniforms, dt);
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, feedbackObjects[destination]);
+    glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, feedbackQuery);
+    glBeginTransformFeedback(GL_POINTS);
+
+    // Draws within one capture append to each other: survivors first, then the
+    // bursts. Points that no longer fit the buffer are not written.
+    if (simulate && captured[current])
+    {
+        glUniform1i(uniforms.emitting, GL_FALSE);
+        glBindVertexArray(VAOs[current]);
+        glDrawTransformFeedback(GL_POINTS, feedbackObjects[current]);
+    }
+
+    glUniform1i(uniforms.emitting, GL_TRUE);
+    glBindVertexArray(emptyVAO);
+    for (const ParticleBurst& burst : pendingBursts)
+    {
+        setBurstUniforms(uniforms, burst);
+        glDrawArrays(GL_POINTS, 0, std::min(burst.count, capacity));
+    }
+
+    glEndTransformFeedback();
+    glEndQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN);
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
+    glBindVertexArray(0);
+    glDisable(GL_RASTERIZER_DISCARD);
+
+    captured[destination] = true;
+    current = destination;
+}
+
+int ParticleSystem::draw(CommandBuffer& commands)
+{
+    if (maxAlive == 0)
+    {
+        return 0;
+    }
+
+    RingAllocation allocation;
+    if (backend == ParticleBackend::CPU)
+    {
+        simulation.gather(uploadParticles);
+        allocation = streamBuffer->upload(uploadParticles.data(), uploadParticles.size() * sizeof(Particle), 16);
+        if (!allocation.valid())
+        {
+            return 0;
+        }
+    }
+
+    commands.useProgram(programs->renderShader->ID);
+    commands.setUniform(programs->particleSizeLoc, settings.size);
+    commands.enable(GL_BLEND);
+    commands.blendFunc(GL_ONE, GL_ONE);
+
+    switch (backend)
+    {
+    case ParticleBackend::Compute:
+        commands.bindVertexArray(VAOs[current]);
+        commands.drawArraysIndirect(GL_POINTS, commandBuffer, current * sizeof(DrawCommand));
+        break;
+    case ParticleBackend::TransformFeedback:
+        commands.bindVertexArray(VAOs[current]);
+        commands.drawTransformFeedback(GL_POINTS, feedbackObjects[current]);
+        break;
+    default:
+        commands.bindVertexBuffer(VAOs[0], allocation.buffer, allocation.offset, sizeof(Particle),
+                                  PARTICLE_ATTRIBUTES);
+        commands.bindVertexArray(VAOs[0]);
+        commands.drawArrays(GL_POINTS, 0, (GLsizei)uploadParticles.size());
+        break;
+    }
+
+    commands.bindVertexArray(0);
+    commands.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    commands.disable(GL_BLEND);
+    return maxAlive;
+}
+
+int ParticleSystem::readCount()
+{
+    if (maxAlive == 0)
+    {
+        return 0;
+    }
+
+    switch (backend)
+    {
+    case ParticleBackend::Compute:
+    {
+        DrawCommand command;
+        glBindBuffer(GL_COPY_READ_BUFFER, commandBuffer);
+        glGetBufferSubData(GL_COPY_READ_BUFFER, current * sizeof(DrawCommand), sizeof(DrawCommand), &command);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        return (int)command.count;
+    }
+    case ParticleBackend::TransformFeedback:
+    {
+        GLuint written = 0;
+        glGetQueryObjectuiv(feedbackQuery, GL_QUERY_RESULT, &written);
+        return (int)written;
+    }
+    default:
+        return simulation.getCount();
+    }
+}
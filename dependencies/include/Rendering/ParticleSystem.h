@@ -0,0 +1,153 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <shader/Shader.h>
+#include <Simulation/ParticleSimulation.h>
+#include "CommandBuffer.h"
+#include "RingBuffer.h"
+
+enum class ParticleBackend
+{
+    // Compute shader emission, simulation and compaction; drawn indirectly.
+    Compute,
+    // Vertex shader simulation captured with transform feedback, compacted by a geometry shader.
+    TransformFeedback,
+    // The SIMD reference simulation, streamed through the frame ring every frame.
+    CPU
+};
+
+const char* getParticleBackendName(ParticleBackend backend);
+
+// Uniform locations of the compute and transform feedback update programs.
+struct ParticleUniforms
+{
+    GLint emitting = -1;
+    GLint sourceIndex = -1;
+    GLint destinationIndex = -1;
+    GLint capacity = -1;
+    GLint dt = -1;
+    GLint gravity = -1;
+    GLint drag = -1;
+    GLint floorHeight = -1;
+    GLint restitution = -1;
+    GLint burstOrigin = -1;
+    GLint burstSeed = -1;
+    GLint burstCount = -1;
+    GLint cosSpread = -1;
+    GLint minSpeed = -1;
+    GLint maxSpeed = -1;
+    GLint minLifetime = -1;
+    GLint maxLifetime = -1;
+    GLint colorA = -1;
+    GLint colorB = -1;
+
+    void find(GLuint program);
+};
+
+// Programs shared by every particle system: the billboard shader, and the update
+// program of each GPU backend the context can build.
+class ParticlePrograms
+{
+public:
+    ParticlePrograms(Shader* renderShader, const std::string& computePath, const std::string& feedbackVertexPath,
+                     const std::string& feedbackGeometryPath);
+    ~ParticlePrograms();
+
+    ParticlePrograms(const ParticlePrograms&) = delete;
+    ParticlePrograms& operator=(const ParticlePrograms&) = delete;
+
+    bool supports(ParticleBackend backend) const;
+    // The backend named in the config ("auto", "compute", "transformFeedback" or
+    // "cpu"), or the fastest supported one when it is unavailable.
+    ParticleBackend choose(const std::string& name) const;
+
+    Shader* renderShader;
+    GLint particleSizeLoc = -1;
+    GLuint computeProgram = 0;
+    GLuint feedbackProgram = 0;
+    ParticleUniforms computeUniforms;
+    ParticleUniforms feedbackUniforms;
+};
+
+// Particle bursts simulated without touching the CPU per particle. Particles
+// live in two GPU buffers: each update reads one, writes the survivors to the
+// other, compacted, and appends the queued bursts behind them. The live count
+// stays on the GPU as indirect draw arguments (compute) or in the transform
+// feedback object, so nothing is read back. Particles are drawn as points that
+// a geometry shader expands into camera-facing billboards, blended additively.
+class ParticleSystem
+{
+public:
+    ParticleSystem(ParticleBackend backend, int capacity, const ParticleSettings& settings,
+                   ParticlePrograms* programs, RingBuffer* streamBuffer);
+    ~ParticleSystem();
+
+    ParticleSystem(const ParticleSystem&) = delete;
+    ParticleSystem& operator=(const ParticleSystem&) = delete;
+
+    // Queues a burst for the next update.
+    void emit(const ParticleBurst& burst);
+    // Moves the live particles by dt seconds, drops the dead ones and emits the queued bursts.
+    void update(float dt);
+    // Records the draw of the live particles. Returns their number, or an upper bound of it on the GPU backends.
+    int draw(CommandBuffer& commands);
+
+    // Reads the exact live count back, waiting for the GPU. For checks only.
+    int readCount();
+
+    // True while particles may be alive or a burst is queued.
+    bool isActive() const { return maxAlive > 0 || !pendingBursts.empty(); }
+    // Live particles at most, known without asking the GPU.
+    int getMaxAlive() const { return maxAlive; }
+    int getCapacity() const { return capacity; }
+    ParticleBackend getBackend() const { return backend; }
+
+    // Largest ring allocation draw() can need in one frame.
+    static GLsizeiptr getMaxUploadSize(ParticleBackend backend, int capacity);
+
+    static constexpr GLuint SOURCE_BINDING = 3;
+    static constexpr GLuint DESTINATION_BINDING = 4;
+    static constexpr GLuint COMMANDS_BINDING = 5;
+    static constexpr int WORK_GROUP_SIZE = 256;
+
+private:
+    // Matches DrawCommand in compute_particles.glsl: glDrawArraysIndirect arguments.
+    struct DrawCommand
+    {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint first;
+        GLuint baseInstance;
+    };
+
+    void setUniforms(const ParticleUniforms& uniforms, float dt);
+    void setBurstUniforms(const ParticleUniforms& uniforms, const ParticleBurst& burst);
+    void updateCompute(float dt, bool simulate);
+    void updateFeedback(float dt, bool simulate);
+
+    ParticleBackend backend;
+    int capacity;
+    ParticleSettings settings;
+    ParticlePrograms* programs;
+    RingBuffer* streamBuffer;
+
+    std::vector<ParticleBurst> pendingBursts;
+    int maxAlive = 0;
+    // Time since the last burst; once it exceeds the longest lifetime every particle is dead.
+    float idleTime = 0.0f;
+
+    // Index of the buffer holding the live particles.
+    int current = 0;
+    GLuint particleBuffers[2] = {0, 0};
+    GLuint VAOs[2] = {0, 0};
+    GLuint commandBuffer = 0;
+    GLuint feedbackObjects[2] = {0, 0};
+    // A feedback object can only be drawn once something was captured into it.
+    bool captured[2] = {false, false};
+    GLuint feedbackQuery = 0;
+    GLuint emptyVAO = 0;
+
+    ParticleSimulation simulation;
+    std::vector<Particle> uploadParticles;
+};
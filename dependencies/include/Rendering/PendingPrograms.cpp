@@ -0,0 +1,31 @@
+#include "PendingPrograms.h"
+
+#include <algorithm>
+
+void PendingPrograms::add(std::vector<Shader*> shaders, std::function<void()> onReady)
+{
+    groups.push_back({std::move(shaders), std::move(onReady)});
+}
+
+void PendingPrograms::poll()
+{
+    for (size_t i = 0; i < groups.size();)
+    {
+        Group& group = groups[i];
+        bool ready = std::all_of(group.shaders.begin(), group.shaders.end(),
+                                 [](const Shader* shader) { return shader->isReady(); });
+        if (!ready)
+        {
+            ++i;
+            continue;
+        }
+
+        for (Shader* shader : group.shaders)
+        {
+            shader->finish();
+        }
+        std::function<void()> onReady = std::move(group.onReady);
+        groups.erase(groups.begin() + i);
+        onReady();
+    }
+}
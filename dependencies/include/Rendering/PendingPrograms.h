@@ -0,0 +1,31 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+#include <shader/Shader.h>
+
+// Setup waiting on programs that are still compiling. The render thread polls
+// it every frame and keeps drawing with what stands in for them meanwhile, so
+// programs not needed for the first frames do not hold up startup.
+class PendingPrograms
+{
+public:
+    // onReady runs on the polling thread, with its context current, once every
+    // one of shaders has finished compiling and linking.
+    void add(std::vector<Shader*> shaders, std::function<void()> onReady);
+
+    // Runs the setup of the groups whose programs are all ready. Never waits for
+    // the compiler while parallel compilation is available.
+    void poll();
+
+    bool empty() const { return groups.empty(); }
+
+private:
+    struct Group
+    {
+        std::vector<Shader*> shaders;
+        std::function<void()> onReady;
+    };
+
+    std::vector<Group> groups;
+};
@@ -0,0 +1,326 @@
+#include "PerfHUD.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include "GLExtensions.h"
+#include "VertexArrays.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+namespace
+{
+// GL_NVX_gpu_memory_info, reported in kilobytes.
+const GLenum GPU_MEMORY_TOTAL_AVAILABLE_NVX = 0x9048;
+const GLenum GPU_MEMORY_CURRENT_AVAILABLE_NVX = 0x9049;
+
+const int TEXT_REFRESH_FRAMES = 15;
+const int FRAME_INTERVAL_WINDOW = 1000;
+
+const float MARGIN = 8.0f;
+const float PADDING = 6.0f;
+const float GLYPH_SCALE = 2.0f;
+const float LINE_HEIGHT = 18.0f;
+const float GRAPH_WIDTH = 240.0f;
+const float GRAPH_HEIGHT = 64.0f;
+// Frame time at the top of the graph; a line marks the 60 Hz budget.
+const float GRAPH_MILLISECONDS = 33.3f;
+const float BUDGET_MILLISECONDS = 1000.0f / 60.0f;
+const float PANEL_WIDTH = 460.0f;
+
+const unsigned int PANEL_COLOR = 0x000000B0;
+const unsigned int TEXT_COLOR = 0xFFFFFFFF;
+const unsigned int BUDGET_COLOR = 0xFFFFFF60;
+const unsigned int GPU_COLOR = 0xFF8C1AFF;
+const unsigned int CPU_COLOR = 0x33D94DB0;
+
+// 5x7 glyphs, one row per byte with the leftmost pixel in bit 4. Characters
+// missing from the table are drawn as spaces.
+const char GLYPHS[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ.%:/-";
+const int GLYPH_COUNT = sizeof(GLYPHS) - 1;
+const int GLYPH_WIDTH = 5;
+const int GLYPH_HEIGHT = 7;
+// Atlas cells leave one empty column and row around each glyph; the cell after
+// the last glyph is solid and used for the panel and the graph bars.
+const int CELL_WIDTH = GLYPH_WIDTH + 1;
+const int CELL_HEIGHT = GLYPH_HEIGHT + 1;
+const int ATLAS_WIDTH = CELL_WIDTH * (GLYPH_COUNT + 1);
+const unsigned char GLYPH_ROWS[GLYPH_COUNT][GLYPH_HEIGHT] = {
+    {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E}, // 0
+    {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E}, // 1
+    {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F}, // 2
+    {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E}, // 3
+    {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02}, // 4
+    {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E}, // 5
+    {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E}, // 6
+    {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08}, // 7
+    {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E}, // 8
+    {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C}, // 9
+    {0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11}, // A
+    {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E}, // B
+    {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}, // C
+    {0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C}, // D
+    {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}, // E
+    {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10}, // F
+    {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F}, // G
+    {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}, // H
+    {0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}, // I
+    {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C}, // J
+    {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}, // K
+    {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F}, // L
+    {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11}, // M
+    {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11}, // N
+    {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}, // O
+    {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10}, // P
+    {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D}, // Q
+    {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11}, // R
+    {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E}, // S
+    {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}, // T
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}, // U
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04}, // V
+    {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A}, // W
+    {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11}, // X
+    {0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04}, // Y
+    {0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F}, // Z
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C}, // .
+    {0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03}, // %
+    {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00}, // :
+    {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00}, // /
+    {0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00}, // -
+};
+
+// Resident set of the process in megabytes, or a negative value where unsupported.
+double getResidentMegabytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return counters.WorkingSetSize / (1024.0 * 1024.0);
+    }
+#elif defined(__linux__)
+    FILE* file = fopen("/proc/self/statm", "r");
+    if (file)
+    {
+        long size = 0;
+        long resident = 0;
+        int read = fscanf(file, "%ld %ld", &size, &resident);
+        fclose(file);
+        if (read == 2)
+        {
+            return (double)resident * sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0);
+        }
+    }
+#endif
+    return -1.0;
+}
+}
+
+PerfHUD::PerfHUD(Shader* shader, RingBuffer* streamBuffer, bool gpuMemory)
+    : shader(shader), streamBuffer(streamBuffer), frameIntervals(FRAME_INTERVAL_WINDOW)
+{
+    viewportSizeLoc = glGetUniformLocation(shader->ID, "viewportSize");
+    gpuMemoryInfo = gpuMemory && hasGLExtension("GL_NVX_gpu_memory_info");
+
+    // Like the curves, the vertex array points at the start of the ring and each
+    // frame draws from the first vertex of its own upload.
+    VAO = createVertexArray(streamBuffer->getBuffer(), sizeof(Vertex),
+                            {{0, 2, offsetof(Vertex, x)}, {1, 2, offsetof(Vertex, u)},
+                             {2, 4, offsetof(Vertex, color), GL_UNSIGNED_BYTE, GL_TRUE}});
+
+    createFontTexture();
+}
+
+PerfHUD::~PerfHUD()
+{
+    glDeleteTextures(1, &fontTexture);
+    glDeleteVertexArrays(1, &VAO);
+}
+
+void PerfHUD::createFontTexture()
+{
+    std::vector<unsigned char> pixels(ATLAS_WIDTH * CELL_HEIGHT, 0);
+    for (int glyph = 0; glyph < GLYPH_COUNT; ++glyph)
+    {
+        for (int row = 0; row < GLYPH_HEIGHT; ++row)
+        {
+            for (int column = 0; column < GLYPH_WIDTH; ++column)
+            {
+                if (GLYPH_ROWS[glyph][row] & (0x10 >> column))
+                {
+                    pixels[row * ATLAS_WIDTH + glyph * CELL_WIDTH + column] = 255;
+                }
+            }
+        }
+    }
+    for (int row = 0; row < CELL_HEIGHT; ++row)
+    {
+        memset(&pixels[row * ATLAS_WIDTH + GLYPH_COUNT * CELL_WIDTH], 255, CELL_WIDTH);
+    }
+
+    glGenTextures(1, &fontTexture);
+    glBindTexture(GL_TEXTURE_2D, fontTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, ATLAS_WIDTH, CELL_HEIGHT, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void PerfHUD::addFrame(double cpuMilliseconds, double intervalMilliseconds)
+{
+    cpuTimes.add(cpuMilliseconds);
+    frameIntervals.add(intervalMilliseconds);
+}
+
+void PerfHUD::formatText(const RenderStats& stats, const RollingStats* gpuTimes)
+{
+    char line[64];
+    lines.clear();
+
+    double interval = frameIntervals.getAverage();
+    snprintf(line, sizeof(line), "FRAME %5.2f MS  %4.0f FPS", interval, interval > 0.0 ? 1000.0 / interval : 0.0);
+    lines.push_back(line);
+
+    snprintf(line, sizeof(line), "CPU %5.2f MS  GPU %5.2f MS", cpuTimes.getAverage(),
+             gpuTimes ? gpuTimes->getAverage() : 0.0);
+    lines.push_back(line);
+
+    // The lows are the frame intervals that only 1% and 0.1% of frames exceed.
+    snprintf(line, sizeof(line), "1%% LOW %5.2f MS  0.1%% LOW %5.2f MS", frameIntervals.getPercentile(99.0),
+             frameIntervals.getPercentile(99.9));
+    lines.push_back(line);
+
+    snprintf(line, sizeof(line), "DRAWS %d  TRIS %lld", stats.drawCalls, stats.triangles);
+    lines.push_back(line);
+
+    snprintf(line, sizeof(line), "STATE %d  UPLOAD %.1f KB", stats.stateChanges, stats.uploadedBytes / 1024.0);
+    lines.push_back(line);
+
+    double resident = getResidentMegabytes();
+    int length = resident >= 0.0 ? snprintf(line, sizeof(line), "MEM %.1f MB", resident)
+                                 : snprintf(line, sizeof(line), "MEM N/A");
+    if (gpuMemoryInfo)
+    {
+        GLint total = 0;
+        GLint available = 0;
+        glGetIntegerv(GPU_MEMORY_TOTAL_AVAILABLE_NVX, &total);
+        glGetIntegerv(GPU_MEMORY_CURRENT_AVAILABLE_NVX, &available);
+        snprintf(line + length, sizeof(line) - length, "  GPU MEM %d/%d MB", (total - available) / 1024,
+                 total / 1024);
+    }
+    lines.push_back(line);
+}
+
+void PerfHUD::addQuad(float x, float y, float width, float height, float u0, float v0, float u1, float v1,
+                      unsigned int color)
+{
+    auto corner = [color](float cornerX, float cornerY, float u, float v)
+    {
+        return Vertex{cornerX, cornerY, u, v,
+                      {(unsigned char)(color >> 24), (unsigned char)(color >> 16), (unsigned char)(color >> 8),
+                       (unsigned char)color}};
+    };
+    Vertex corners[4] = {
+        corner(x, y, u0, v0), corner(x + width, y, u1, v0), corner(x + width, y + height, u1, v1),
+        corner(x, y + height, u0, v1)
+    };
+
+    const int order[6] = {0, 1, 2, 0, 2, 3};
+    for (int index : order)
+    {
+        vertices.push_back(corners[index]);
+    }
+}
+
+void PerfHUD::addRect(float x, float y, float width, float height, unsigned int color)
+{
+    float u = (GLYPH_COUNT * CELL_WIDTH + CELL_WIDTH * 0.5f) / ATLAS_WIDTH;
+    addQuad(x, y, width, height, u, 0.5f, u, 0.5f, color);
+}
+
+void PerfHUD::addText(float x, float y, const std::string& text, unsigned int color)
+{
+    for (char character : text)
+    {
+        const char* glyph = character != '\0' ? strchr(GLYPHS, character) : nullptr;
+        if (glyph)
+        {
+            float u0 = (float)((glyph - GLYPHS) * CELL_WIDTH) / ATLAS_WIDTH;
+            float u1 = u0 + (float)GLYPH_WIDTH / ATLAS_WIDTH;
+            float v1 = (float)GLYPH_HEIGHT / CELL_HEIGHT;
+            addQuad(x, y, GLYPH_WIDTH * GLYPH_SCALE, GLYPH_HEIGHT * GLYPH_SCALE, u0, 0.0f, u1, v1, color);
+        }
+        x += CELL_WIDTH * GLYPH_SCALE;
+    }
+}
+
+void PerfHUD::addGraph(float x, float y, const RollingStats& times, unsigned int color)
+{
+    // Newest sample on the right; one pixel wide bar per frame.
+    size_t count = std::min(times.getCount(), (size_t)GRAPH_WIDTH);
+    float left = x + GRAPH_WIDTH - count;
+    for (size_t i = 0; i < count; ++i)
+    {
+        double milliseconds = times.getSample(times.getCount() - count + i);
+        float height = std::min((float)milliseconds / GRAPH_MILLISECONDS, 1.0f) * GRAPH_HEIGHT;
+        addRect(left + i, y + GRAPH_HEIGHT - height, 1.0f, height, color);
+    }
+}
+
+void PerfHUD::draw(CommandBuffer& commands, const RenderStats& stats, const RollingStats* gpuTimes, int width,
+                   int height)
+{
+    if (lines.empty() || ++framesSinceText >= TEXT_REFRESH_FRAMES)
+    {
+        formatText(stats, gpuTimes);
+        framesSinceText = 0;
+    }
+
+    vertices.clear();
+    float panelHeight = PADDING * 3.0f + GRAPH_HEIGHT + LINE_HEIGHT * lines.size();
+    addRect(MARGIN, MARGIN, PANEL_WIDTH, panelHeight, PANEL_COLOR);
+
+    float graphX = MARGIN + PADDING;
+    float graphY = MARGIN + PADDING;
+    if (gpuTimes)
+    {
+        addGraph(graphX, graphY, *gpuTimes, GPU_COLOR);
+    }
+    addGraph(graphX, graphY, cpuTimes, CPU_COLOR);
+    float budgetY = graphY + GRAPH_HEIGHT * (1.0f - BUDGET_MILLISECONDS / GRAPH_MILLISECONDS);
+    addRect(graphX, budgetY, GRAPH_WIDTH, 1.0f, BUDGET_COLOR);
+
+    float textY = graphY + GRAPH_HEIGHT + PADDING;
+    for (const std::string& line : lines)
+    {
+        addText(graphX, textY, line, TEXT_COLOR);
+        textY += LINE_HEIGHT;
+    }
+
+    RingAllocation allocation = streamBuffer->upload(vertices.data(), vertices.size() * sizeof(Vertex), sizeof(Vertex));
+    if (!allocation.valid())
+    {
+        return;
+    }
+
+    commands.useProgram(shader->ID);
+    commands.setUniform(viewportSizeLoc, glm::vec2((float)width, (float)height));
+    commands.enable(GL_BLEND);
+    commands.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    commands.bindTexture(0, GL_TEXTURE_2D, fontTexture);
+    commands.bindVertexArray(VAO);
+    commands.drawArrays(GL_TRIANGLES, (GLint)(allocation.offset / sizeof(Vertex)), (GLsizei)vertices.size());
+    commands.bindVertexArray(0);
+    commands.disable(GL_BLEND);
+}
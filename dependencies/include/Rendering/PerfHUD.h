@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <shader/Shader.h>
+#include "CommandBuffer.h"
+#include "RenderStats.h"
+#include "RingBuffer.h"
+#include "RollingStats.h"
+
+// Overlay with the CPU and GPU frame-time history as a bar graph, the 1% and
+// 0.1% lows of the frame interval, and the draw statistics of the frame.
+//
+// Text uses a built-in 5x7 bitmap font. The glyphs and a solid cell for the
+// graph bars share one small texture, so the whole overlay is a single list of
+// textured quads streamed through the frame ring and drawn with one call. The
+// text is only reformatted a few times per second; the graph every frame.
+// Without gpuMemory the GPU memory line is left out even where the driver
+// reports it, as querying it is a GL call outside the recorded commands.
+class PerfHUD
+{
+public:
+    PerfHUD(Shader* shader, RingBuffer* streamBuffer, bool gpuMemory = true);
+    ~PerfHUD();
+
+    PerfHUD(const PerfHUD&) = delete;
+    PerfHUD& operator=(const PerfHUD&) = delete;
+
+    // CPU time of the frame and the time since the previous frame started, in milliseconds.
+    void addFrame(double cpuMilliseconds, double intervalMilliseconds);
+    // Records the overlay's draw. gpuTimes is the rolling window of whole-frame GPU times, if known.
+    void draw(CommandBuffer& commands, const RenderStats& stats, const RollingStats* gpuTimes, int width,
+              int height);
+
+private:
+    struct Vertex
+    {
+        float x, y;
+        float u, v;
+        unsigned char color[4];
+    };
+
+    void formatText(const RenderStats& stats, const RollingStats* gpuTimes);
+    void addQuad(float x, float y, float width, float height, float u0, float v0, float u1, float v1,
+                 unsigned int color);
+    void addRect(float x, float y, float width, float height, unsigned int color);
+    void addText(float x, float y, const std::string& text, unsigned int color);
+    void addGraph(float x, float y, const RollingStats& times, unsigned int color);
+    void createFontTexture();
+
+    Shader* shader;
+    RingBuffer* streamBuffer;
+    GLuint VAO = 0;
+    GLuint fontTexture = 0;
+    GLint viewportSizeLoc = -1;
+    bool gpuMemoryInfo = false;
+
+    RollingStats cpuTimes;
+    // Long enough for a 0.1% low to mean one frame in a thousand.
+    RollingStats frameIntervals;
+    int framesSinceText = 0;
+    std::vector<std::string> lines;
+    std::vector<Vertex> vertices;
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <GLAD/glad.h>
+
+// Work the renderer submitted in one frame, counted at the draw sites.
+struct RenderStats
+{
+    int drawCalls = 0;
+    long long triangles = 0;
+    // Program, vertex array, texture and framebuffer binds.
+    int stateChanges = 0;
+    // Bytes streamed to the GPU through the frame ring.
+    long long uploadedBytes = 0;
+
+    void countDraw(GLenum mode, GLsizei vertexCount)
+    {
+        drawCalls++;
+        triangles += getTriangleCount(mode, vertexCount);
+    }
+
+    void countInstancedDraw(GLsizei trianglesPerInstance, GLsizei instanceCount)
+    {
+        drawCalls++;
+        triangles += (long long)trianglesPerInstance * instanceCount;
+    }
+
+    // Triangles of vertexCount vertices drawn as mode; none for points and lines.
+    static GLsizei getTriangleCount(GLenum mode, GLsizei vertexCount)
+    {
+        switch (mode)
+        {
+        case GL_TRIANGLES:
+            return vertexCount / 3;
+        case GL_TRIANGLE_STRIP:
+        case GL_TRIANGLE_FAN:
+            return vertexCount > 2 ? vertexCount - 2 : 0;
+        default:
+            return 0;
+        }
+    }
+};
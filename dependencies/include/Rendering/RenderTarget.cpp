@@ -0,0 +1,72 @@
+#include "RenderTarget.h"
+
+#include <iostream>
+
+RenderTarget::~RenderTarget()
+{
+    destroy();
+}
+
+void RenderTarget::resize(int width, int height)
+{
+    if (width == this->width && height == this->height && framebuffer != 0)
+    {
+        return;
+    }
+
+    destroy();
+    this->width = width;
+    this->height = height;
+
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &depthStencilBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthStencilBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    GLint boundFramebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &boundFramebuffer);
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthStencilBuffer);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cerr << "RenderTarget: framebuffer is incomplete" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, boundFramebuffer);
+}
+
+void RenderTarget::bind(CommandBuffer& commands)
+{
+    commands.bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    commands.viewport(0, 0, width, height);
+}
+
+void RenderTarget::resolve(CommandBuffer& commands, GLuint outputFramebuffer, int outputWidth, int outputHeight)
+{
+    commands.bindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    commands.bindFramebuffer(GL_DRAW_FRAMEBUFFER, outputFramebuffer);
+    commands.blitFramebuffer(glm::ivec4(0, 0, width, height), glm::ivec4(0, 0, outputWidth, outputHeight),
+                             GL_COLOR_BUFFER_BIT, GL_LINEAR);
+
+    commands.bindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer);
+    commands.viewport(0, 0, outputWidth, outputHeight);
+}
+
+void RenderTarget::destroy()
+{
+    if (framebuffer != 0)
+    {
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(1, &colorBuffer);
+        glDeleteRenderbuffers(1, &depthStencilBuffer);
+    }
+    framebuffer = 0;
+    colorBuffer = 0;
+    depthStencilBuffer = 0;
+}
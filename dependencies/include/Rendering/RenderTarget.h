@@ -0,0 +1,39 @@
+#pragma once
+
+#include "CommandBuffer.h"
+#include "GLExtensions.h"
+
+// Offscreen color and depth-stencil buffers for rendering the scene below the
+// output resolution. bind() redirects drawing into it; resolve() upscales the
+// color onto the output framebuffer, with a linear blit.
+class RenderTarget
+{
+public:
+    RenderTarget() = default;
+    ~RenderTarget();
+
+    RenderTarget(const RenderTarget&) = delete;
+    RenderTarget& operator=(const RenderTarget&) = delete;
+
+    // Reallocates the buffers when the size changed.
+    void resize(int width, int height);
+    // Records binding the target and its viewport.
+    void bind(CommandBuffer& commands);
+    // Records stretching the color over outputWidth x outputHeight of
+    // outputFramebuffer, and binding that with its viewport.
+    void resolve(CommandBuffer& commands, GLuint outputFramebuffer, int outputWidth, int outputHeight);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    GLuint getFramebuffer() const { return framebuffer; }
+
+private:
+    void destroy();
+
+    GLuint framebuffer = 0;
+    GLuint colorBuffer = 0;
+    // The overdraw view counts fragments in the stencil, so the target keeps one.
+    GLuint depthStencilBuffer = 0;
+    int width = 0;
+    int height = 0;
+};
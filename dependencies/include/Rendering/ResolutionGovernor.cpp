@@ -0,0 +1,83 @@
+#include "ResolutionGovernor.h"
+
+#include <algorithm>
+#include <cmath>
+
+ResolutionGovernor::ResolutionGovernor(const ResolutionGovernorSettings& settings)
+    : settings(settings), gpuTimes((size_t)std::max(settings.sampleFrames, 1))
+{
+    ResolutionGovernorSettings& s = this->settings;
+    s.maxScale = std::clamp(s.maxScale, 0.1f, 1.0f);
+    s.minScale = std::clamp(s.minScale, 0.1f, s.maxScale);
+    s.scaleStep = std::max(s.scaleStep, 0.01f);
+    levelCount = 1 + (int)std::ceil((s.maxScale - s.minScale) / s.scaleStep - 0.001f);
+}
+
+bool ResolutionGovernor::update(double gpuMilliseconds)
+{
+    if (cooldown > 0)
+    {
+        cooldown--;
+        return false;
+    }
+
+    gpuTimes.add(gpuMilliseconds);
+    if (gpuTimes.getCount() < gpuTimes.getCapacity())
+    {
+        return false;
+    }
+
+    double average = gpuTimes.getAverage();
+    double budget = settings.targetMilliseconds;
+    if (average > budget * settings.upperThreshold && level < levelCount - 1)
+    {
+        setLevel(level + 1);
+        return true;
+    }
+
+    if (average < budget * settings.lowerThreshold && level > 0)
+    {
+        float ratio = getScale(level - 1) / getScale(level);
+        if (average * ratio * ratio < budget * settings.upperThreshold)
+        {
+            setLevel(level - 1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ResolutionGovernor::reset()
+{
+    level = 0;
+    cooldown = 0;
+    gpuTimes.clear();
+}
+
+QualityLevel ResolutionGovernor::getQuality() const
+{
+    // How far down the ladder, from 0 at full quality to 1 at the last level.
+    float f = levelCount > 1 ? (float)level / (levelCount - 1) : 0.0f;
+
+    QualityLevel quality;
+    quality.resolutionScale = getScale(level);
+    quality.curveDetail = 1.0f - 0.6f * f;
+    quality.textureLodBias = 1.5f * f;
+    // Changing the shadow resolution rebuilds the cached static layer, so it only
+    // happens twice over the whole range.
+    quality.shadowResolutionShift = (int)(f * 2.0f + 0.5f);
+    return quality;
+}
+
+float ResolutionGovernor::getScale(int level) const
+{
+    return std::max(settings.maxScale - level * settings.scaleStep, settings.minScale);
+}
+
+void ResolutionGovernor::setLevel(int level)
+{
+    this->level = level;
+    cooldown = settings.cooldownFrames;
+    gpuTimes.clear();
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "RollingStats.h"
+
+struct ResolutionGovernorSettings
+{
+    // GPU time budget of a frame, in milliseconds.
+    double targetMilliseconds = 16.0;
+    // Bounds of the render resolution, as a fraction of the output size.
+    float minScale = 0.5f;
+    float maxScale = 1.0f;
+    float scaleStep = 0.1f;
+    // Quality drops when the average GPU time goes over upperThreshold of the
+    // budget and rises again only below lowerThreshold; in between it holds.
+    double upperThreshold = 0.95;
+    double lowerThreshold = 0.75;
+    // Frames averaged before a decision.
+    int sampleFrames = 20;
+    // Frames ignored after a change, so timings still in flight from the old
+    // level, and the cost of reallocating the targets, are not judged.
+    int cooldownFrames = 30;
+};
+
+// The quality knobs at one level of the governor.
+struct QualityLevel
+{
+    float resolutionScale = 1.0f;
+    // Multiplier of the curve tessellation density.
+    float curveDetail = 1.0f;
+    // Added to the mip level of texture lookups; blurrier but less memory traffic.
+    float textureLodBias = 0.0f;
+    // The shadow map resolution is shifted right by this much.
+    int shadowResolutionShift = 0;
+};
+
+// Picks a quality level from the measured GPU frame time. Level 0 is full
+// quality; every level lowers the render resolution by one scaleStep and eases
+// the secondary knobs along with it, down to minScale at the last level.
+//
+// Oscillation is avoided three ways: the thresholds leave a band where nothing
+// changes, every change is followed by a cooldown with a fresh average, and
+// quality only rises when the frame would still fit the budget at the higher
+// resolution, assuming its cost grows with the pixel count.
+class ResolutionGovernor
+{
+public:
+    explicit ResolutionGovernor(const ResolutionGovernorSettings& settings);
+
+    // Feeds the GPU time of one frame. Returns true when the level changed.
+    bool update(double gpuMilliseconds);
+    // Back to full quality, e.g. when the governor is switched off.
+    void reset();
+
+    int getLevel() const { return level; }
+    int getLevelCount() const { return levelCount; }
+    QualityLevel getQuality() const;
+    const ResolutionGovernorSettings& getSettings() const { return settings; }
+    double getAverageMilliseconds() const { return gpuTimes.getAverage(); }
+
+private:
+    float getScale(int level) const;
+    void setLevel(int level);
+
+    ResolutionGovernorSettings settings;
+    int levelCount = 1;
+    int level = 0;
+    int cooldown = 0;
+    RollingStats gpuTimes;
+};
@@ -0,0 +1,147 @@
+#include "RingBuffer.h"
+
+#include <cstring>
+#include <iostream>
+
+RingBuffer::RingBuffer(GLsizeiptr frameSize, int framesInFlight, bool hostOnly)
+    : frameSize(frameSize), framesInFlight(framesInFlight), fences(framesInFlight, nullptr)
+{
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    if (alignment > 0)
+    {
+        uniformAlignment = alignment;
+    }
+
+    GLsizeiptr totalSize = frameSize * framesInFlight;
+
+    glGenBuffers(1, &buffer);
+    if (hostOnly)
+    {
+        hostStorage.resize(totalSize);
+        mapped = hostStorage.data();
+        return;
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+
+    if (glCapabilities.bufferStorage)
+    {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_WRITE_BUFFER, totalSize, nullptr, flags);
+        mapped = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, totalSize, flags);
+    }
+
+    if (!mapped)
+    {
+        glBufferData(GL_COPY_WRITE_BUFFER, totalSize, nullptr, GL_STREAM_DRAW);
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+RingBuffer::~RingBuffer()
+{
+    for (GLsync& fence : fences)
+    {
+        if (fence)
+        {
+            glDeleteSync(fence);
+        }
+    }
+
+    if (mapped && hostStorage.empty())
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    glDeleteBuffers(1, &buffer);
+}
+
+void RingBuffer::waitForRegion(int region)
+{
+    GLsync& fence = fences[region];
+    if (!fence)
+    {
+        return;
+    }
+
+    // Only flush on the first attempt; afterwards the commands are already queued.
+    GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (true)
+    {
+        GLenum result = glClientWaitSync(fence, waitFlags, 1000000);
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED)
+        {
+            break;
+        }
+        waitFlags = 0;
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void RingBuffer::beginFrame()
+{
+    waitForRegion(frameIndex);
+    head = 0;
+}
+
+void RingBuffer::endFrame()
+{
+    if (hostStorage.empty())
+    {
+        fences[frameIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    frameIndex = (frameIndex + 1) % framesInFlight;
+}
+
+RingAllocation RingBuffer::allocate(GLsizeiptr size, GLsizeiptr alignment)
+{
+    GLsizeiptr regionStart = frameIndex * frameSize;
+    GLsizeiptr offset = regionStart + head;
+    offset = ((offset + alignment - 1) / alignment) * alignment;
+
+    if (offset + size > regionStart + frameSize)
+    {
+        if (!overflowReported)
+        {
+            std::cerr << "Ring buffer frame region exhausted (" << frameSize << " bytes)" << std::endl;
+            overflowReported = true;
+        }
+        return RingAllocation();
+    }
+
+    head = offset + size - regionStart;
+
+    RingAllocation allocation;
+    allocation.buffer = buffer;
+    allocation.offset = offset;
+    allocation.size = size;
+    return allocation;
+}
+
+RingAllocation RingBuffer::upload(const void* data, GLsizeiptr size, GLsizeiptr alignment)
+{
+    RingAllocation allocation = allocate(size, alignment);
+    if (!allocation.valid())
+    {
+        return allocation;
+    }
+
+    if (mapped)
+    {
+        memcpy(mapped + allocation.offset, data, size);
+    }
+    else
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.offset, size, data);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    return allocation;
+}
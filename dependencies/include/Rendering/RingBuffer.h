@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+#include "GLExtensions.h"
+
+struct RingAllocation
+{
+    GLuint buffer = 0;
+    GLintptr offset = 0;
+    GLsizeiptr size = 0;
+
+    bool valid() const { return buffer != 0; }
+};
+
+// Streaming buffer for data that changes every frame (curve vertices, per-frame
+// uniforms, indirect commands). The storage is split into one region per frame in
+// flight; a region is only rewritten after the fence placed at the end of the frame
+// that last used it has signalled, so no GL object is created per frame and the
+// driver never has to orphan or synchronize the buffer.
+//
+// When GL 4.4 buffer storage is available the buffer is persistently and coherently
+// mapped and uploads are plain memcpys. Otherwise uploads fall back to
+// glBufferSubData into the fenced region.
+//
+// A host-only ring still names a buffer for the allocations to point at, but
+// keeps the data in CPU memory and places no fences: for the null command
+// backend, where nothing reads it on the GPU.
+class RingBuffer
+{
+public:
+    RingBuffer(GLsizeiptr frameSize, int framesInFlight = 3, bool hostOnly = false);
+    ~RingBuffer();
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    void beginFrame();
+    void endFrame();
+
+    // Reserves space in the current frame region without writing to it.
+    RingAllocation allocate(GLsizeiptr size, GLsizeiptr alignment = 16);
+    RingAllocation upload(const void* data, GLsizeiptr size, GLsizeiptr alignment = 16);
+
+    GLuint getBuffer() const { return buffer; }
+    GLsizeiptr getUniformAlignment() const { return uniformAlignment; }
+    bool isPersistent() const { return mapped != nullptr; }
+    // Bytes allocated in the current frame region so far, alignment included.
+    GLsizeiptr getFrameUsage() const { return head; }
+
+private:
+    void waitForRegion(int region);
+
+    GLuint buffer = 0;
+    GLsizeiptr frameSize;
+    int framesInFlight;
+    int frameIndex = 0;
+    GLsizeiptr head = 0;
+    GLsizeiptr uniformAlignment = 256;
+    unsigned char* mapped = nullptr;
+    std::vector<unsigned char> hostStorage;
+    bool overflowReported = false;
+    std::vector<GLsync> fences;
+};
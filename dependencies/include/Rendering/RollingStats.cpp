@@ -0,0 +1,73 @@
+#include "RollingStats.h"
+
+#include <algorithm>
+#include <cmath>
+
+RollingStats::RollingStats(size_t capacity)
+    : samples(std::max(capacity, (size_t)1), 0.0)
+{
+}
+
+void RollingStats::add(double value)
+{
+    samples[next] = value;
+    next = (next + 1) % samples.size();
+    count = std::min(count + 1, samples.size());
+}
+
+void RollingStats::clear()
+{
+    next = 0;
+    count = 0;
+}
+
+double RollingStats::getLatest() const
+{
+    return count > 0 ? samples[(next + samples.size() - 1) % samples.size()] : 0.0;
+}
+
+double RollingStats::getAverage() const
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        sum += getSample(i);
+    }
+    return count > 0 ? sum / count : 0.0;
+}
+
+double RollingStats::getMax() const
+{
+    double maximum = 0.0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        maximum = std::max(maximum, getSample(i));
+    }
+    return maximum;
+}
+
+double RollingStats::getPercentile(double percentile) const
+{
+    if (count == 0)
+    {
+        return 0.0;
+    }
+
+    sorted.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        sorted[i] = getSample(i);
+    }
+
+    size_t rank = (size_t)std::ceil(percentile / 100.0 * count);
+    size_t index = std::clamp(rank, (size_t)1, count) - 1;
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted[index];
+}
+
+double RollingStats::getSample(size_t i) const
+{
+    // While the ring is not full yet, the oldest sample is still at index 0.
+    size_t oldest = count < samples.size() ? 0 : next;
+    return samples[(oldest + i) % samples.size()];
+}
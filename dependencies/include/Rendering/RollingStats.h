@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// The most recent samples of a measurement, kept in a fixed size ring for rolling
+// averages and percentiles. Older samples are overwritten once the ring is full.
+class RollingStats
+{
+public:
+    explicit RollingStats(size_t capacity = 240);
+
+    void add(double value);
+    void clear();
+
+    size_t getCount() const { return count; }
+    size_t getCapacity() const { return samples.size(); }
+    double getLatest() const;
+    double getAverage() const;
+    double getMax() const;
+    // Nearest rank percentile of the current window, percentile in [0, 100].
+    double getPercentile(double percentile) const;
+    // Sample i of the window, oldest first.
+    double getSample(size_t i) const;
+
+private:
+    std::vector<double> samples;
+    size_t next = 0;
+    size_t count = 0;
+    mutable std::vector<double> sorted;
+};
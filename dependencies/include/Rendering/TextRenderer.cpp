@@ -0,0 +1,292 @@
+#include "TextRenderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include "GLExtensions.h"
+
+namespace
+{
+// Strokes of every glyph on a grid 4 units wide and 6 high, baseline at y = 0.
+// Polylines are separated by ';' and their points by ','; a polyline of one
+// repeated point is a dot.
+struct StrokeGlyph
+{
+    char character;
+    const char* strokes;
+};
+
+const StrokeGlyph STROKE_GLYPHS[] = {
+    {'0', "1 0,0 1,0 5,1 6,3 6,4 5,4 1,3 0,1 0;0.5 1.5,3.5 4.5"},
+    {'1', "1 5,2 6,2 0;1 0,3 0"},
+    {'2', "0 5,1 6,3 6,4 5,4 4,0 0,4 0"},
+    {'3', "0 5,1 6,3 6,4 5,4 4,3 3,1.5 3;3 3,4 2,4 1,3 0,1 0,0 1"},
+    {'4', "3 0,3 6,0 2,4 2"},
+    {'5', "4 6,0 6,0 3.5,3 3.5,4 2.5,4 1,3 0,1 0,0 1"},
+    {'6', "4 5,3 6,1 6,0 5,0 1,1 0,3 0,4 1,4 2.5,3 3.5,0 3.5"},
+    {'7', "0 6,4 6,1.5 0"},
+    {'8', "1 3,0 4,0 5,1 6,3 6,4 5,4 4,3 3,1 3,0 2,0 1,1 0,3 0,4 1,4 2,3 3"},
+    {'9', "4 2.5,1 2.5,0 3.5,0 5,1 6,3 6,4 5,4 1,3 0,1 0,0 1"},
+    {'A', "0 0,0 4,2 6,4 4,4 0;0 2.5,4 2.5"},
+    {'B', "0 0,0 6,3 6,4 5,4 4,3 3,0 3;3 3,4 2,4 1,3 0,0 0"},
+    {'C', "4 5,3 6,1 6,0 5,0 1,1 0,3 0,4 1"},
+    {'D', "0 0,0 6,2 6,4 4,4 2,2 0,0 0"},
+    {'E', "4 6,0 6,0 0,4 0;0 3,3 3"},
+    {'F', "4 6,0 6,0 0;0 3,3 3"},
+    {'G', "4 5,3 6,1 6,0 5,0 1,1 0,3 0,4 1,4 3,2 3"},
+    {'H', "0 0,0 6;4 0,4 6;0 3,4 3"},
+    {'I', "1 6,3 6;2 6,2 0;1 0,3 0"},
+    {'J', "4 6,4 1,3 0,1 0,0 1"},
+    {'K', "0 0,0 6;4 6,0 2;1.3 3.3,4 0"},
+    {'L', "0 6,0 0,4 0"},
+    {'M', "0 0,0 6,2 3,4 6,4 0"},
+    {'N', "0 0,0 6,4 0,4 6"},
+    {'O', "1 0,0 1,0 5,1 6,3 6,4 5,4 1,3 0,1 0"},
+    {'P', "0 0,0 6,3 6,4 5,4 4,3 3,0 3"},
+    {'Q', "1 0,0 1,0 5,1 6,3 6,4 5,4 1,3 0,1 0;2.5 1.5,4 0"},
+    {'R', "0 0,0 6,3 6,4 5,4 4,3 3,0 3;2 3,4 0"},
+    {'S', "4 5,3 6,1 6,0 5,0 4,1 3,3 3,4 2,4 1,3 0,1 0,0 1"},
+    {'T', "0 6,4 6;2 6,2 0"},
+    {'U', "0 6,0 1,1 0,3 0,4 1,4 6"},
+    {'V', "0 6,2 0,4 6"},
+    {'W', "0 6,1 0,2 3,3 0,4 6"},
+    {'X', "0 6,4 0;0 0,4 6"},
+    {'Y', "0 6,2 3,4 6;2 3,2 0"},
+    {'Z', "0 6,4 6,0 0,4 0"},
+    {':', "2 1,2 1;2 4,2 4"},
+    {'.', "2 0,2 0"},
+    {'-', "1 3,3 3"},
+    {'+', "2 1,2 5;0 3,4 3"},
+    {'/', "0 0,4 6"},
+    {'!', "2 6,2 2;2 0,2 0"},
+    {'%', "0 6,0 6;4 0,4 0;0 0,4 6"},
+};
+const int GLYPH_COUNT = sizeof(STROKE_GLYPHS) / sizeof(STROKE_GLYPHS[0]);
+
+const float GLYPH_WIDTH = 4.0f;
+const float GLYPH_HEIGHT = 6.0f;
+const float STROKE_RADIUS = 0.45f;
+// Empty grid units around each glyph; also the distance range stored in the field.
+const float PADDING = 1.5f;
+const float ADVANCE = GLYPH_WIDTH + 1.5f;
+const int TEXELS_PER_UNIT = 8;
+
+const float CELL_WIDTH = GLYPH_WIDTH + 2.0f * PADDING;
+const float CELL_HEIGHT = GLYPH_HEIGHT + 2.0f * PADDING;
+const int CELL_TEXELS_X = (int)(CELL_WIDTH * TEXELS_PER_UNIT);
+const int CELL_TEXELS_Y = (int)(CELL_HEIGHT * TEXELS_PER_UNIT);
+const int ATLAS_COLUMNS = 16;
+const int ATLAS_ROWS = (GLYPH_COUNT + ATLAS_COLUMNS - 1) / ATLAS_COLUMNS;
+const int ATLAS_WIDTH = ATLAS_COLUMNS * CELL_TEXELS_X;
+const int ATLAS_HEIGHT = ATLAS_ROWS * CELL_TEXELS_Y;
+
+struct Segment
+{
+    glm::vec2 a;
+    glm::vec2 b;
+};
+
+std::vector<Segment> parseStrokes(const char* strokes)
+{
+    std::vector<Segment> segments;
+    const char* cursor = strokes;
+    while (*cursor)
+    {
+        std::vector<glm::vec2> points;
+        while (*cursor && *cursor != ';')
+        {
+            char* end = nullptr;
+            float x = std::strtof(cursor, &end);
+            float y = std::strtof(end, &end);
+            if (end == cursor)
+            {
+                return segments;
+            }
+            points.push_back(glm::vec2(x, y));
+            cursor = *end == ',' ? end + 1 : end;
+        }
+        for (size_t i = 1; i < points.size(); ++i)
+        {
+            segments.push_back({points[i - 1], points[i]});
+        }
+        if (*cursor == ';')
+        {
+            cursor++;
+        }
+    }
+    return segments;
+}
+
+float distanceToSegment(const glm::vec2& p, const Segment& segment)
+{
+    glm::vec2 ab = segment.b - segment.a;
+    float lengthSquared = glm::dot(ab, ab);
+    float t = lengthSquared > 0.0f ? glm::clamp(glm::dot(p - segment.a, ab) / lengthSquared, 0.0f, 1.0f) : 0.0f;
+    return glm::length(p - (segment.a + ab * t));
+}
+}
+
+const std::initializer_list<VertexAttribute> TextRenderer::GLYPH_ATTRIBUTES = {
+    {0, 3, offsetof(Glyph, origin)}, {1, 3, offsetof(Glyph, right)}, {2, 3, offsetof(Glyph, up)},
+    {3, 4, offsetof(Glyph, uvRect)}, {4, 4, offsetof(Glyph, color)}
+};
+
+TextRenderer::TextRenderer(Shader* shader, RingBuffer* streamBuffer)
+    : shader(shader), streamBuffer(streamBuffer)
+{
+    screenSpaceLoc = glGetUniformLocation(shader->ID, "screenSpace");
+    viewportSizeLoc = glGetUniformLocation(shader->ID, "viewportSize");
+    glUseProgram(shader->ID);
+    glUniform1i(glGetUniformLocation(shader->ID, "glyphAtlas"), 0);
+
+    // One instance per glyph. The buffer binding is pointed at each batch's
+    // upload when it is drawn.
+    VAO = createVertexArray(streamBuffer->getBuffer(), sizeof(Glyph), GLYPH_ATTRIBUTES, 1);
+
+    createAtlas();
+}
+
+TextRenderer::~TextRenderer()
+{
+    glDeleteTextures(1, &atlasTexture);
+    glDeleteVertexArrays(1, &VAO);
+}
+
+void TextRenderer::createAtlas()
+{
+    std::fill(std::begin(glyphRects), std::end(glyphRects), glm::vec4(0.0f));
+
+    // Rows go bottom up, like the texture coordinates.
+    std::vector<unsigned char> pixels((size_t)ATLAS_WIDTH * ATLAS_HEIGHT, 0);
+    for (int glyph = 0; glyph < GLYPH_COUNT; ++glyph)
+    {
+        std::vector<Segment> segments = parseStrokes(STROKE_GLYPHS[glyph].strokes);
+        int cellX = (glyph % ATLAS_COLUMNS) * CELL_TEXELS_X;
+        int cellY = (glyph / ATLAS_COLUMNS) * CELL_TEXELS_Y;
+
+        for (int y = 0; y < CELL_TEXELS_Y; ++y)
+        {
+            for (int x = 0; x < CELL_TEXELS_X; ++x)
+            {
+                // Texel center in grid units.
+                glm::vec2 p((x + 0.5f) / TEXELS_PER_UNIT - PADDING, (y + 0.5f) / TEXELS_PER_UNIT - PADDING);
+                float distance = PADDING;
+                for (const Segment& segment : segments)
+                {
+                    distance = std::min(distance, distanceToSegment(p, segment));
+                }
+                // 0.5 on the outline, rising inside the stroke.
+                float value = glm::clamp(0.5f + (STROKE_RADIUS - distance) / PADDING * 0.5f, 0.0f, 1.0f);
+                pixels[(size_t)(cellY + y) * ATLAS_WIDTH + cellX + x] = (unsigned char)(value * 255.0f + 0.5f);
+            }
+        }
+
+        glyphRects[(unsigned char)STROKE_GLYPHS[glyph].character] = glm::vec4(
+            (float)cellX / ATLAS_WIDTH, (float)cellY / ATLAS_HEIGHT,
+            (float)(cellX + CELL_TEXELS_X) / ATLAS_WIDTH, (float)(cellY + CELL_TEXELS_Y) / ATLAS_HEIGHT);
+    }
+
+    glGenTextures(1, &atlasTexture);
+    glBindTexture(GL_TEXTURE_2D, atlasTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, ATLAS_WIDTH, ATLAS_HEIGHT, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    // Distances filter linearly, and their mips keep distant text from shimmering.
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+float TextRenderer::getTextWidth(const std::string& text)
+{
+    if (text.empty())
+    {
+        return 0.0f;
+    }
+    return (text.size() * ADVANCE - (ADVANCE - GLYPH_WIDTH)) / GLYPH_HEIGHT;
+}
+
+void TextRenderer::addWorldText(const std::string& text, const glm::mat4& model, const glm::vec4& color)
+{
+    glm::vec3 right = glm::vec3(model[0]);
+    glm::vec3 up = glm::vec3(model[1]);
+    glm::vec3 origin = glm::vec3(model[3]) - right * (getTextWidth(text) * 0.5f);
+    addText(worldGlyphs, text, origin, right, up, color);
+}
+
+void TextRenderer::addScreenText(const std::string& text, float x, float y, float pixelHeight, const glm::vec4& color)
+{
+    // Pixel rows grow downwards.
+    addText(screenGlyphs, text, glm::vec3(x, y + pixelHeight, 0.0f), glm::vec3(pixelHeight, 0.0f, 0.0f),
+            glm::vec3(0.0f, -pixelHeight, 0.0f), color);
+}
+
+void TextRenderer::addText(std::vector<Glyph>& glyphs, const std::string& text, const glm::vec3& origin,
+                           const glm::vec3& right, const glm::vec3& up, const glm::vec4& color)
+{
+    // Grid units to text units, where a capital letter is one unit high.
+    glm::vec3 unitRight = right / GLYPH_HEIGHT;
+    glm::vec3 unitUp = up / GLYPH_HEIGHT;
+
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        unsigned char character = (unsigned char)text[i];
+        const glm::vec4& rect = glyphRects[character < 128 ? character : ' '];
+        if (rect.z <= rect.x)
+        {
+            continue;
+        }
+
+        Glyph glyph;
+        glyph.origin = origin + unitRight * (i * ADVANCE - PADDING) - unitUp * PADDING;
+        glyph.right = unitRight * CELL_WIDTH;
+        glyph.up = unitUp * CELL_HEIGHT;
+        glyph.uvRect = rect;
+        glyph.color = color;
+        glyphs.push_back(glyph);
+    }
+}
+
+int TextRenderer::drawWorld(CommandBuffer& commands)
+{
+    return draw(commands, worldGlyphs, false, 0, 0);
+}
+
+int TextRenderer::drawScreen(CommandBuffer& commands, int width, int height)
+{
+    return draw(commands, screenGlyphs, true, width, height);
+}
+
+int TextRenderer::draw(CommandBuffer& commands, std::vector<Glyph>& glyphs, bool screenSpace, int width, int height)
+{
+    int count = (int)glyphs.size();
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    RingAllocation allocation = streamBuffer->upload(glyphs.data(), glyphs.size() * sizeof(Glyph), 16);
+    glyphs.clear();
+    if (!allocation.valid())
+    {
+        return 0;
+    }
+
+    commands.useProgram(shader->ID);
+    commands.setUniform(screenSpaceLoc, (int)screenSpace);
+    commands.setUniform(viewportSizeLoc, glm::vec2((float)width, (float)height));
+    commands.enable(GL_BLEND);
+    commands.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    commands.bindTexture(0, GL_TEXTURE_2D, atlasTexture);
+
+    commands.bindVertexBuffer(VAO, allocation.buffer, allocation.offset, sizeof(Glyph), GLYPH_ATTRIBUTES);
+    commands.bindVertexArray(VAO);
+    commands.drawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+    commands.bindVertexArray(0);
+    commands.disable(GL_BLEND);
+    return count;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glm/glm/glm.hpp>
+#include <shader/Shader.h>
+#include "CommandBuffer.h"
+#include "RingBuffer.h"
+#include "VertexArrays.h"
+
+// Text drawn from a signed distance field glyph atlas, so glyphs stay sharp at
+// any size and distance with a single small texture.
+//
+// The atlas is generated at startup from a built-in stroke font: every glyph is
+// a few polylines on a 4x6 grid, and each texel stores its distance to the
+// nearest stroke, which is exact for line segments. Digits, capital letters and
+// some punctuation are included; other characters are drawn as spaces.
+//
+// Strings are queued as glyph instances (corner, axes, atlas rectangle and
+// color) and each batch is streamed through the frame ring and drawn as one
+// instanced quad strip. World text lies in the XY plane of a model matrix and is
+// drawn with the frame's view and projection; screen text is placed in pixels.
+class TextRenderer
+{
+public:
+    TextRenderer(Shader* shader, RingBuffer* streamBuffer);
+    ~TextRenderer();
+
+    TextRenderer(const TextRenderer&) = delete;
+    TextRenderer& operator=(const TextRenderer&) = delete;
+
+    // Centered on the model's origin with its baseline there; one unit is the
+    // height of a capital letter.
+    void addWorldText(const std::string& text, const glm::mat4& model, const glm::vec4& color);
+    // Top left corner in pixels from the top left of the framebuffer.
+    void addScreenText(const std::string& text, float x, float y, float pixelHeight, const glm::vec4& color);
+
+    // Record the draw of the queued glyphs of one kind and clear them. Return the number of glyphs drawn.
+    int drawWorld(CommandBuffer& commands);
+    int drawScreen(CommandBuffer& commands, int width, int height);
+
+    // Width of a string, in capital letter heights.
+    static float getTextWidth(const std::string& text);
+
+private:
+    struct Glyph
+    {
+        glm::vec3 origin;
+        glm::vec3 right;
+        glm::vec3 up;
+        glm::vec4 uvRect;
+        glm::vec4 color;
+    };
+    static const std::initializer_list<VertexAttribute> GLYPH_ATTRIBUTES;
+
+    void addText(std::vector<Glyph>& glyphs, const std::string& text, const glm::vec3& origin,
+                 const glm::vec3& right, const glm::vec3& up, const glm::vec4& color);
+    int draw(CommandBuffer& commands, std::vector<Glyph>& glyphs, bool screenSpace, int width, int height);
+    void createAtlas();
+
+    Shader* shader;
+    RingBuffer* streamBuffer;
+    GLuint VAO = 0;
+    GLuint atlasTexture = 0;
+    GLint screenSpaceLoc = -1;
+    GLint viewportSizeLoc = -1;
+    // Atlas rectangle of every character, empty for the ones without a glyph.
+    glm::vec4 glyphRects[128];
+    std::vector<Glyph> worldGlyphs;
+    std::vector<Glyph> screenGlyphs;
+};
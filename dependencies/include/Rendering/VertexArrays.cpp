@@ -0,0 +1,107 @@
+#include "VertexArrays.h"
+
+#include <cstdint>
+
+GLuint createStaticBuffer(const void* data, GLsizeiptr size)
+{
+    GLuint buffer = 0;
+    if (glCapabilities.directStateAccess)
+    {
+        glCreateBuffers(1, &buffer);
+        // Immutable storage cannot be empty; a mesh that failed to load keeps a buffer without any.
+        if (size > 0)
+        {
+            glNamedBufferStorage(buffer, size, data, 0);
+        }
+        return buffer;
+    }
+
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return buffer;
+}
+
+GLuint createBuffer()
+{
+    GLuint buffer = 0;
+    if (glCapabilities.directStateAccess)
+    {
+        // Unlike glGenBuffers, the name is a buffer object right away.
+        glCreateBuffers(1, &buffer);
+    }
+    else
+    {
+        glGenBuffers(1, &buffer);
+    }
+    return buffer;
+}
+
+void uploadBuffer(GLuint buffer, const void* data, GLsizeiptr size, GLenum usage)
+{
+    if (glCapabilities.directStateAccess)
+    {
+        glNamedBufferData(buffer, size, data, usage);
+        return;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, size, data, usage);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+GLuint createVertexArray(GLuint buffer, GLsizei stride, std::initializer_list<VertexAttribute> attributes,
+                         GLuint divisor)
+{
+    GLuint VAO = 0;
+    if (glCapabilities.directStateAccess)
+    {
+        glCreateVertexArrays(1, &VAO);
+        glVertexArrayVertexBuffer(VAO, 0, buffer, 0, stride);
+        glVertexArrayBindingDivisor(VAO, 0, divisor);
+        for (const VertexAttribute& attribute : attributes)
+        {
+            glEnableVertexArrayAttrib(VAO, attribute.location);
+            glVertexArrayAttribFormat(VAO, attribute.location, attribute.size, attribute.type, attribute.normalized,
+                                      attribute.offset);
+            glVertexArrayAttribBinding(VAO, attribute.location, 0);
+        }
+        return VAO;
+    }
+
+    glGenVertexArrays(1, &VAO);
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    for (const VertexAttribute& attribute : attributes)
+    {
+        glVertexAttribPointer(attribute.location, attribute.size, attribute.type, attribute.normalized, stride,
+                              (GLvoid*)(uintptr_t)attribute.offset);
+        glEnableVertexAttribArray(attribute.location);
+        glVertexAttribDivisor(attribute.location, divisor);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return VAO;
+}
+
+void setVertexBuffer(GLuint VAO, GLuint buffer, GLintptr offset, GLsizei stride, const VertexAttribute* attributes,
+                     size_t attributeCount)
+{
+    if (glCapabilities.directStateAccess)
+    {
+        glVertexArrayVertexBuffer(VAO, 0, buffer, offset, stride);
+        return;
+    }
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    for (size_t i = 0; i < attributeCount; ++i)
+    {
+        const VertexAttribute& attribute = attributes[i];
+        glVertexAttribPointer(attribute.location, attribute.size, attribute.type, attribute.normalized, stride,
+                              (GLvoid*)(uintptr_t)(offset + attribute.offset));
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <initializer_list>
+#include "GLExtensions.h"
+
+// One attribute of an interleaved vertex, read from buffer binding 0.
+struct VertexAttribute
+{
+    GLuint location;
+    GLint size;
+    GLuint offset;
+    GLenum type = GL_FLOAT;
+    GLboolean normalized = GL_FALSE;
+};
+
+// Buffer and vertex array setup. With direct state access the objects are
+// created and filled by name: the attribute formats and the buffer binding
+// are set separately, and neither the bound array buffer nor the bound vertex
+// array changes. Without it they fall back to binding to edit, and leave
+// both bindings at zero.
+
+// Immutable buffer holding size bytes of data.
+GLuint createStaticBuffer(const void* data, GLsizeiptr size);
+// Empty buffer whose contents are replaced with uploadBuffer.
+GLuint createBuffer();
+void uploadBuffer(GLuint buffer, const void* data, GLsizeiptr size, GLenum usage);
+
+// Vertex array reading the attributes from buffer, stride bytes per vertex,
+// advancing once per divisor instances (every vertex with 0).
+GLuint createVertexArray(GLuint buffer, GLsizei stride, std::initializer_list<VertexAttribute> attributes,
+                         GLuint divisor = 0);
+
+// Points a vertex array made by createVertexArray at offset bytes into buffer,
+// for vertices streamed to a new place every draw. With direct state access
+// that is one call on the buffer binding; without it every attribute is
+// pointed again, so they must be the ones the array was made with.
+void setVertexBuffer(GLuint VAO, GLuint buffer, GLintptr offset, GLsizei stride, const VertexAttribute* attributes,
+                     size_t attributeCount);
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <GLAD/glad.h>
+#include <glm/glm/glm.hpp>
+#include "SceneGraph.h"
+
+// Low bits index the entity table, high bits count how often the slot was reused,
+// so a handle to a destroyed entity never aliases its successor.
+using Entity = uint32_t;
+const Entity INVALID_ENTITY = 0xFFFFFFFFu;
+const int ENTITY_INDEX_BITS = 24;
+const Entity ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1;
+
+using ComponentMask = uint32_t;
+
+// One bit per component type. An entity's mask selects the archetype it lives in.
+enum ComponentBit : ComponentMask
+{
+    // Position, rotation and scale, plus their values at the previous step.
+    TRANSFORM = 1 << 0,
+    // Cached world and normal matrices for rendered entities (a Scene Transform).
+    MATRIX_CACHE = 1 << 1,
+    MESH = 1 << 2,
+    MATERIAL = 1 << 3,
+    RIGID_BODY = 1 << 4,
+    CURVE_FOLLOWER = 1 << 5,
+    // World transform owned by a scene graph node instead of the Transform columns.
+    SCENE_NODE = 1 << 6
+};
+
+struct MeshRef
+{
+    GLuint VAO = 0;
+    GLuint vertexCount = 0;
+    GLuint textureID = 0;
+    // Bounding sphere in model space.
+    glm::vec3 boundsCenter = glm::vec3(0.0f);
+    float boundsRadius = 0.0f;
+};
+
+struct Material
+{
+    glm::vec3 ka = glm::vec3(0.0f);
+    glm::vec3 kd = glm::vec3(0.0f);
+    glm::vec3 ks = glm::vec3(0.0f);
+    glm::vec3 ke = glm::vec3(0.0f);
+    float shininess = 32.0f;
+
+    bool operator==(const Material& other) const = default;
+};
+
+// Slot of a Material in the renderer's MaterialTable; what MATERIAL entities carry.
+using MaterialIndex = GLint;
+
+struct RigidBody
+{
+    glm::vec3 velocity = glm::vec3(0.0f);
+    float radius = 0.5f;
+};
+
+// Parameter along a sampled curve; the owner of the curve turns it into a position.
+struct CurveFollower
+{
+    float position = 0.0f;
+    float speed = 1.0f;
+    float length = 1.0f;
+    bool loop = false;
+
+    bool isFinished() const { return !loop && position >= length; }
+};
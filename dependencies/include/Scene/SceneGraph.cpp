@@ -0,0 +1,175 @@
+#include "SceneGraph.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <glm/glm/gtc/matrix_inverse.hpp>
+#include "Transform.h"
+
+NodeId SceneGraph::createNode(NodeId parent, NodeKind kind, int payload)
+{
+    NodeId handle = (NodeId)handleToIndex.size();
+    int index = (int)parents.size();
+    int parentIndex = parent == INVALID_NODE ? -1 : handleToIndex[parent];
+
+    parents.push_back(parentIndex);
+    depths.push_back(parentIndex < 0 ? 0 : depths[parentIndex] + 1);
+    kinds.push_back(kind);
+    payloads.push_back(payload);
+    localPositions.push_back(glm::vec3(0.0f));
+    localRotations.push_back(glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+    localScales.push_back(glm::vec3(1.0f));
+    worldMatrices.push_back(glm::mat4(1.0f));
+    normalMatrices.push_back(glm::mat3(1.0f));
+    dirty.push_back(1);
+    updated.push_back(0);
+    indexToHandle.push_back(handle);
+    handleToIndex.push_back(index);
+
+    // Appending keeps parents before children, but not grouped by depth.
+    if (index > 0 && depths[index] < depths[index - 1])
+    {
+        needsSort = true;
+    }
+
+    return handle;
+}
+
+NodeId SceneGraph::createCollider(NodeId parent, const glm::vec3& localMin, const glm::vec3& localMax)
+{
+    NodeId node = createNode(parent, NodeKind::Collider, (int)colliders.size());
+    colliders.push_back({node, localMin, localMax, localMin, localMax});
+    return node;
+}
+
+void SceneGraph::setLocalPosition(NodeId node, const glm::vec3& position)
+{
+    int index = handleToIndex[node];
+    localPositions[index] = position;
+    dirty[index] = 1;
+}
+
+void SceneGraph::setLocalRotation(NodeId node, const glm::quat& rotation)
+{
+    int index = handleToIndex[node];
+    localRotations[index] = rotation;
+    dirty[index] = 1;
+}
+
+void SceneGraph::setLocalScale(NodeId node, const glm::vec3& scale)
+{
+    int index = handleToIndex[node];
+    localScales[index] = scale;
+    dirty[index] = 1;
+}
+
+void SceneGraph::sortByDepth()
+{
+    int count = (int)parents.size();
+    std::vector<int> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return depths[a] < depths[b]; });
+
+    std::vector<int> newIndex(count);
+    for (int i = 0; i < count; ++i)
+    {
+        newIndex[order[i]] = i;
+    }
+
+    auto permute = [&](auto& values)
+    {
+        auto sorted = values;
+        for (int i = 0; i < count; ++i)
+        {
+            sorted[i] = values[order[i]];
+        }
+        values.swap(sorted);
+    };
+
+    permute(parents);
+    permute(depths);
+    permute(kinds);
+    permute(payloads);
+    permute(localPositions);
+    permute(localRotations);
+    permute(localScales);
+    permute(worldMatrices);
+    permute(normalMatrices);
+    permute(dirty);
+    permute(updated);
+    permute(indexToHandle);
+
+    for (int i = 0; i < count; ++i)
+    {
+        if (parents[i] >= 0)
+        {
+            parents[i] = newIndex[parents[i]];
+        }
+        handleToIndex[indexToHandle[i]] = i;
+    }
+
+    needsSort = false;
+}
+
+int SceneGraph::updateWorldTransforms()
+{
+    if (needsSort)
+    {
+        sortByDepth();
+    }
+
+    int recomputed = 0;
+    int count = (int)parents.size();
+    for (int i = 0; i < count; ++i)
+    {
+        int parent = parents[i];
+        if (!dirty[i] && (parent < 0 || !updated[parent]))
+        {
+            updated[i] = 0;
+            continue;
+        }
+
+        glm::mat4 local = Transform::composeWorldMatrix(localPositions[i], localRotations[i], localScales[i]);
+        worldMatrices[i] = parent < 0 ? local : worldMatrices[parent] * local;
+        if (kinds[i] == NodeKind::Mesh)
+        {
+            normalMatrices[i] = glm::inverseTranspose(glm::mat3(worldMatrices[i]));
+        }
+
+        dirty[i] = 0;
+        updated[i] = 1;
+        recomputed++;
+    }
+
+    for (Collider& collider : colliders)
+    {
+        int index = handleToIndex[collider.node];
+        if (!updated[index])
+        {
+            continue;
+        }
+
+        // Transform all eight corners so rotated parents still give a tight box.
+        const glm::mat4& world = worldMatrices[index];
+        collider.worldMin = glm::vec3(std::numeric_limits<float>::max());
+        collider.worldMax = glm::vec3(-std::numeric_limits<float>::max());
+        for (int corner = 0; corner < 8; ++corner)
+        {
+            glm::vec3 local((corner & 1) ? collider.localMax.x : collider.localMin.x,
+                            (corner & 2) ? collider.localMax.y : collider.localMin.y,
+                            (corner & 4) ? collider.localMax.z : collider.localMin.z);
+            glm::vec3 point = glm::vec3(world * glm::vec4(local, 1.0f));
+            collider.worldMin = glm::min(collider.worldMin, point);
+            collider.worldMax = glm::max(collider.worldMax, point);
+        }
+    }
+
+    return recomputed;
+}
+
+void SceneGraph::getColliderBounds(NodeId node, glm::vec3& worldMin, glm::vec3& worldMax) const
+{
+    const Collider& collider = colliders[getPayload(node)];
+    worldMin = collider.worldMin;
+    worldMax = collider.worldMax;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm/glm.hpp>
+#include <glm/glm/gtc/quaternion.hpp>
+
+using NodeId = int;
+const NodeId INVALID_NODE = -1;
+
+enum class NodeKind
+{
+    Group,
+    Mesh,
+    Collider,
+    Light
+};
+
+// Parent/child transform hierarchy. Nodes are kept in flat arrays (one per
+// attribute) sorted by depth, so every parent precedes its children and world
+// transforms propagate in a single linear pass. Only nodes whose local transform
+// changed, and their descendants, are recomputed.
+//
+// NodeIds are stable handles; the storage index of a node changes whenever the
+// arrays are re-sorted after nodes are added.
+class SceneGraph
+{
+public:
+    NodeId createNode(NodeId parent = INVALID_NODE, NodeKind kind = NodeKind::Group, int payload = -1);
+    // Collider nodes carry an axis-aligned box in the node's local space.
+    NodeId createCollider(NodeId parent, const glm::vec3& localMin, const glm::vec3& localMax);
+
+    void setLocalPosition(NodeId node, const glm::vec3& position);
+    void setLocalRotation(NodeId node, const glm::quat& rotation);
+    void setLocalScale(NodeId node, const glm::vec3& scale);
+
+    // Propagates dirty transforms and refreshes the world bounds of affected
+    // colliders. Returns the number of nodes recomputed.
+    int updateWorldTransforms();
+
+    const glm::mat4& getWorldMatrix(NodeId node) const { return worldMatrices[handleToIndex[node]]; }
+    glm::vec3 getWorldPosition(NodeId node) const { return glm::vec3(getWorldMatrix(node)[3]); }
+    // Only maintained for mesh nodes.
+    const glm::mat3& getNormalMatrix(NodeId node) const { return normalMatrices[handleToIndex[node]]; }
+    void getColliderBounds(NodeId node, glm::vec3& worldMin, glm::vec3& worldMax) const;
+
+    NodeKind getKind(NodeId node) const { return kinds[handleToIndex[node]]; }
+    int getPayload(NodeId node) const { return payloads[handleToIndex[node]]; }
+    int getNodeCount() const { return (int)parents.size(); }
+
+private:
+    void sortByDepth();
+
+    // Per-node attributes, indexed by storage position.
+    std::vector<int> parents;
+    std::vector<int> depths;
+    std::vector<NodeKind> kinds;
+    std::vector<int> payloads;
+    std::vector<glm::vec3> localPositions;
+    std::vector<glm::quat> localRotations;
+    std::vector<glm::vec3> localScales;
+    std::vector<glm::mat4> worldMatrices;
+    std::vector<glm::mat3> normalMatrices;
+    std::vector<uint8_t> dirty;
+    std::vector<uint8_t> updated;
+    std::vector<NodeId> indexToHandle;
+
+    std::vector<int> handleToIndex;
+    bool needsSort = false;
+
+    // Colliders are few, so their bounds live in a separate list indexed by payload.
+    struct Collider
+    {
+        NodeId node;
+        glm::vec3 localMin;
+        glm::vec3 localMax;
+        glm::vec3 worldMin;
+        glm::vec3 worldMax;
+    };
+    std::vector<Collider> colliders;
+};
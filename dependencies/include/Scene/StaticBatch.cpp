@@ -0,0 +1,142 @@
+#include "StaticBatch.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <atomic>
+#include <thread>
+
+namespace
+{
+    // One submesh to fill: where its vertices come from and where they go.
+    struct SubmeshJob
+    {
+        const StaticMeshInstance* instance;
+        StaticBatch* batch;
+        size_t submesh;
+        size_t sourceFirst;
+    };
+
+    size_t getVertexCount(const StaticMeshInstance& instance)
+    {
+        if (!instance.vertices)
+        {
+            return 0;
+        }
+        return std::min((size_t)instance.mesh.vertexCount, instance.vertices->size() / STATIC_VERTEX_FLOATS);
+    }
+
+    void transformSubmesh(const SubmeshJob& job)
+    {
+        StaticSubmesh& submesh = job.batch->submeshes[job.submesh];
+        const GLfloat* source = job.instance->vertices->data() + job.sourceFirst * STATIC_VERTEX_FLOATS;
+        GLfloat* destination = job.batch->vertices.data() + (size_t)submesh.first * STATIC_VERTEX_FLOATS;
+        const glm::mat4& model = job.instance->model;
+        const glm::mat3& normalMatrix = job.instance->normalMatrix;
+
+        glm::vec3 boundsMin(FLT_MAX);
+        glm::vec3 boundsMax(-FLT_MAX);
+        for (GLsizei i = 0; i < submesh.count; ++i)
+        {
+            const GLfloat* in = source + (size_t)i * STATIC_VERTEX_FLOATS;
+            GLfloat* out = destination + (size_t)i * STATIC_VERTEX_FLOATS;
+            glm::vec3 position = glm::vec3(model * glm::vec4(in[0], in[1], in[2], 1.0f));
+            glm::vec3 normal = normalMatrix * glm::vec3(in[5], in[6], in[7]);
+
+            out[0] = position.x;
+            out[1] = position.y;
+            out[2] = position.z;
+            out[3] = in[3];
+            out[4] = in[4];
+            out[5] = normal.x;
+            out[6] = normal.y;
+            out[7] = normal.z;
+            boundsMin = glm::min(boundsMin, position);
+            boundsMax = glm::max(boundsMax, position);
+        }
+        submesh.boundsMin = boundsMin;
+        submesh.boundsMax = boundsMax;
+    }
+}
+
+std::vector<StaticBatch> buildStaticBatches(const std::vector<StaticMeshInstance>& instances, int submeshTriangles,
+                                            int threadCount)
+{
+    // Lay the batches and their submeshes out first, so the threads only fill preallocated ranges.
+    std::vector<StaticBatch> batches;
+    std::vector<size_t> batchOfInstance(instances.size());
+    for (size_t i = 0; i < instances.size(); ++i)
+    {
+        const StaticMeshInstance& instance = instances[i];
+        if (!getVertexCount(instance))
+        {
+            continue;
+        }
+
+        auto found = std::find_if(batches.begin(), batches.end(), [&instance](const StaticBatch& batch)
+        {
+            return batch.textureID == instance.mesh.textureID && batch.materialIndex == instance.materialIndex;
+        });
+        if (found == batches.end())
+        {
+            StaticBatch batch;
+            batch.textureID = instance.mesh.textureID;
+            batch.materialIndex = instance.materialIndex;
+            batches.push_back(batch);
+            found = batches.end() - 1;
+        }
+        batchOfInstance[i] = found - batches.begin();
+    }
+
+    size_t submeshVertices = (size_t)std::max(submeshTriangles, 1) * 3;
+    std::vector<SubmeshJob> jobs;
+    for (size_t i = 0; i < instances.size(); ++i)
+    {
+        const StaticMeshInstance& instance = instances[i];
+        size_t vertexCount = getVertexCount(instance);
+        if (!vertexCount)
+        {
+            continue;
+        }
+
+        // Batches no longer move in memory, so the jobs can point at them.
+        StaticBatch& batch = batches[batchOfInstance[i]];
+        size_t batchVertices = batch.vertices.size() / STATIC_VERTEX_FLOATS;
+        for (size_t first = 0; first < vertexCount; first += submeshVertices)
+        {
+            StaticSubmesh submesh;
+            submesh.first = (GLint)(batchVertices + first);
+            submesh.count = (GLsizei)std::min(submeshVertices, vertexCount - first);
+            batch.submeshes.push_back(submesh);
+            jobs.push_back({&instance, &batch, batch.submeshes.size() - 1, first});
+        }
+        batch.vertices.resize((batchVertices + vertexCount) * STATIC_VERTEX_FLOATS);
+    }
+
+    if (threadCount <= 0)
+    {
+        threadCount = (int)std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    threadCount = std::min(threadCount, (int)jobs.size());
+
+    std::atomic<size_t> nextJob{0};
+    auto worker = [&jobs, &nextJob]()
+    {
+        for (size_t job = nextJob++; job < jobs.size(); job = nextJob++)
+        {
+            transformSubmesh(jobs[job]);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < threadCount; ++i)
+    {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    return batches;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <GLAD/glad.h>
+#include <glm/glm/glm.hpp>
+#include "Components.h"
+
+// Floats per vertex of the merged buffers: position, uv and normal, like the source meshes.
+const int STATIC_VERTEX_FLOATS = 8;
+
+// A mesh that never moves, placed in the world.
+struct StaticMeshInstance
+{
+    MeshRef mesh;
+    // Interleaved position, uv and normal of every vertex of the mesh.
+    std::shared_ptr<const std::vector<GLfloat>> vertices;
+    MaterialIndex materialIndex = 0;
+    glm::mat4 model = glm::mat4(1.0f);
+    glm::mat3 normalMatrix = glm::mat3(1.0f);
+};
+
+// A run of vertices of a batch, from a single instance, with its world space box.
+struct StaticSubmesh
+{
+    GLint first = 0;
+    GLsizei count = 0;
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+};
+
+// Every static mesh sharing a texture and a material, merged in world space.
+struct StaticBatch
+{
+    GLuint textureID = 0;
+    MaterialIndex materialIndex = 0;
+    std::vector<GLfloat> vertices;
+    std::vector<StaticSubmesh> submeshes;
+};
+
+// Groups the instances by texture and material, and copies each group into one
+// vertex array with positions and normals already transformed to world space,
+// so the whole group draws with identity matrices. Instances are cut into
+// submeshes of at most submeshTriangles triangles; the submeshes are
+// transformed and bounded on threadCount threads (0 for one per core).
+// Instances without CPU vertices are skipped.
+std::vector<StaticBatch> buildStaticBatches(const std::vector<StaticMeshInstance>& instances, int submeshTriangles,
+                                            int threadCount = 0);
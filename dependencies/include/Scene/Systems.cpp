@@ -0,0 +1,50 @@
+#include "Systems.h"
+
+#include <algorithm>
+#include <cmath>
+
+void storePreviousTransforms(World& world)
+{
+    world.forEach(TRANSFORM, [](Archetype& archetype)
+    {
+        std::copy(archetype.positions.begin(), archetype.positions.end(), archetype.previousPositions.begin());
+        std::copy(archetype.rotations.begin(), archetype.rotations.end(), archetype.previousRotations.begin());
+    });
+}
+
+void integrateRigidBodies(World& world, const glm::vec3& gravity, float dt)
+{
+    glm::vec3 deltaVelocity = gravity * dt;
+
+    world.forEach(TRANSFORM | RIGID_BODY, [&](Archetype& archetype)
+    {
+        size_t count = archetype.size();
+        glm::vec3* positions = archetype.positions.data();
+        RigidBody* bodies = archetype.rigidBodies.data();
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            bodies[i].velocity += deltaVelocity;
+            positions[i] += bodies[i].velocity * dt;
+        }
+    });
+}
+
+void advanceCurveFollowers(World& world, float dt)
+{
+    world.forEach(CURVE_FOLLOWER, [&](Archetype& archetype)
+    {
+        for (CurveFollower& follower : archetype.curveFollowers)
+        {
+            follower.position += follower.speed * dt;
+            if (follower.loop && follower.length > 0.0f)
+            {
+                follower.position = std::fmod(follower.position, follower.length);
+            }
+            else
+            {
+                follower.position = std::min(follower.position, follower.length);
+            }
+        }
+    });
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <glm/glm/glm.hpp>
+#include "World.h"
+
+// Systems run once per simulation step over every archetype holding the
+// components they need, walking the columns front to back.
+
+// Keeps the transforms of the last step for interpolation; call before anything moves.
+void storePreviousTransforms(World& world);
+
+// Semi-implicit Euler: gravity into velocity, then velocity into position.
+void integrateRigidBodies(World& world, const glm::vec3& gravity, float dt);
+
+// Advances curve parameters, wrapping looping followers and clamping the others at the end.
+void advanceCurveFollowers(World& world, float dt);
@@ -0,0 +1,69 @@
+#include "Transform.h"
+
+#include <glm/glm/gtc/matrix_transform.hpp>
+
+void Transform::setPosition(const glm::vec3& position)
+{
+    if (position != this->position)
+    {
+        this->position = position;
+        dirty = true;
+    }
+}
+
+void Transform::setRotation(const glm::quat& rotation)
+{
+    if (rotation != this->rotation)
+    {
+        this->rotation = rotation;
+        dirty = true;
+    }
+}
+
+void Transform::setScale(const glm::vec3& scale)
+{
+    if (scale != this->scale)
+    {
+        this->scale = scale;
+        dirty = true;
+    }
+}
+
+const glm::mat4& Transform::getWorldMatrix() const
+{
+    update();
+    return worldMatrix;
+}
+
+const glm::mat3& Transform::getNormalMatrix() const
+{
+    update();
+    return normalMatrix;
+}
+
+void Transform::update() const
+{
+    if (!dirty)
+    {
+        return;
+    }
+
+    worldMatrix = composeWorldMatrix(position, rotation, scale);
+    normalMatrix = composeNormalMatrix(rotation, scale);
+    dirty = false;
+}
+
+glm::mat4 Transform::composeWorldMatrix(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+{
+    glm::mat4 world = glm::translate(glm::mat4(1.0f), position) * glm::mat4_cast(rotation);
+    return glm::scale(world, scale);
+}
+
+glm::mat3 Transform::composeNormalMatrix(const glm::quat& rotation, const glm::vec3& scale)
+{
+    glm::mat3 normal = glm::mat3_cast(rotation);
+    normal[0] /= scale.x;
+    normal[1] /= scale.y;
+    normal[2] /= scale.z;
+    return normal;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <glm/glm/glm.hpp>
+#include <glm/glm/gtc/quaternion.hpp>
+
+// Position, rotation and scale with lazily cached world and normal matrices.
+// Setters only mark the transform dirty when the value actually changes, so an
+// object that stays put never rebuilds its matrices.
+class Transform
+{
+public:
+    void setPosition(const glm::vec3& position);
+    void setRotation(const glm::quat& rotation);
+    void setScale(const glm::vec3& scale);
+
+    const glm::vec3& getPosition() const { return position; }
+    const glm::quat& getRotation() const { return rotation; }
+    const glm::vec3& getScale() const { return scale; }
+
+    const glm::mat4& getWorldMatrix() const;
+    // Inverse transpose of the upper 3x3 of the world matrix, for transforming normals.
+    const glm::mat3& getNormalMatrix() const;
+    bool isDirty() const { return dirty; }
+
+    static glm::mat4 composeWorldMatrix(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+    // For a rotation and scale the inverse transpose is just R * S^-1, no general inverse needed.
+    static glm::mat3 composeNormalMatrix(const glm::quat& rotation, const glm::vec3& scale);
+
+private:
+    void update() const;
+
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+
+    mutable glm::mat4 worldMatrix = glm::mat4(1.0f);
+    mutable glm::mat3 normalMatrix = glm::mat3(1.0f);
+    mutable bool dirty = true;
+};
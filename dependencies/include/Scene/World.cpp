@@ -0,0 +1,180 @@
+#include "World.h"
+
+Entity World::create(ComponentMask mask)
+{
+    uint32_t index;
+    if (!freeIndices.empty())
+    {
+        index = freeIndices.back();
+        freeIndices.pop_back();
+    }
+    else
+    {
+        index = (uint32_t)records.size();
+        records.emplace_back();
+    }
+
+    EntityRecord& record = records[index];
+    Entity entity = (record.generation << ENTITY_INDEX_BITS) | index;
+
+    Archetype& archetype = getArchetype(mask);
+    record.archetype = &archetype;
+    record.row = appendRow(archetype, entity);
+    entityCount++;
+
+    return entity;
+}
+
+void World::destroy(Entity entity)
+{
+    if (!isAlive(entity))
+    {
+        return;
+    }
+
+    uint32_t index = entity & ENTITY_INDEX_MASK;
+    EntityRecord& record = records[index];
+    removeRow(*record.archetype, record.row);
+
+    record.archetype = nullptr;
+    record.generation = (record.generation + 1) & (0xFFFFFFFFu >> ENTITY_INDEX_BITS);
+    freeIndices.push_back(index);
+    entityCount--;
+}
+
+bool World::isAlive(Entity entity) const
+{
+    if (entity == INVALID_ENTITY)
+    {
+        return false;
+    }
+
+    uint32_t index = entity & ENTITY_INDEX_MASK;
+    return index < records.size() && records[index].archetype &&
+        records[index].generation == entity >> ENTITY_INDEX_BITS;
+}
+
+bool World::has(Entity entity, ComponentMask mask) const
+{
+    return isAlive(entity) && (records[entity & ENTITY_INDEX_MASK].archetype->mask & mask) == mask;
+}
+
+void World::addComponents(Entity entity, ComponentMask mask)
+{
+    if (isAlive(entity))
+    {
+        moveEntity(entity, records[entity & ENTITY_INDEX_MASK].archetype->mask | mask);
+    }
+}
+
+void World::removeComponents(Entity entity, ComponentMask mask)
+{
+    if (isAlive(entity))
+    {
+        moveEntity(entity, records[entity & ENTITY_INDEX_MASK].archetype->mask & ~mask);
+    }
+}
+
+void World::reserve(ComponentMask mask, size_t count)
+{
+    Archetype& archetype = getArchetype(mask);
+    archetype.entities.reserve(count);
+    Archetype::zipColumns(archetype, archetype, [&](auto& column, auto&, ComponentMask bit)
+    {
+        if (archetype.mask & bit)
+        {
+            column.reserve(count);
+        }
+    });
+}
+
+Archetype& World::getArchetype(ComponentMask mask)
+{
+    for (const std::unique_ptr<Archetype>& archetype : archetypes)
+    {
+        if (archetype->mask == mask)
+        {
+            return *archetype;
+        }
+    }
+
+    archetypes.push_back(std::make_unique<Archetype>());
+    archetypes.back()->mask = mask;
+    return *archetypes.back();
+}
+
+uint32_t World::appendRow(Archetype& archetype, Entity entity)
+{
+    archetype.entities.push_back(entity);
+    Archetype::zipColumns(archetype, archetype, [&](auto& column, auto&, ComponentMask bit)
+    {
+        if (archetype.mask & bit)
+        {
+            column.emplace_back();
+        }
+    });
+
+    // Value initialized glm types are all zeros, which is not a valid rotation or scale.
+    if (archetype.mask & TRANSFORM)
+    {
+        glm::quat identity(1.0f, 0.0f, 0.0f, 0.0f);
+        archetype.rotations.back() = identity;
+        archetype.previousRotations.back() = identity;
+        archetype.scales.back() = glm::vec3(1.0f);
+    }
+
+    return (uint32_t)archetype.size() - 1;
+}
+
+void World::removeRow(Archetype& archetype, uint32_t row)
+{
+    // Swap with the last row so the columns stay densely packed.
+    uint32_t last = (uint32_t)archetype.size() - 1;
+    if (row != last)
+    {
+        Archetype::zipColumns(archetype, archetype, [&](auto& column, auto&, ComponentMask bit)
+        {
+            if (archetype.mask & bit)
+            {
+                column[row] = std::move(column[last]);
+            }
+        });
+        archetype.entities[row] = archetype.entities[last];
+        records[archetype.entities[row] & ENTITY_INDEX_MASK].row = row;
+    }
+
+    archetype.entities.pop_back();
+    Archetype::zipColumns(archetype, archetype, [&](auto& column, auto&, ComponentMask bit)
+    {
+        if (archetype.mask & bit)
+        {
+            column.pop_back();
+        }
+    });
+}
+
+void World::moveEntity(Entity entity, ComponentMask mask)
+{
+    EntityRecord& record = records[entity & ENTITY_INDEX_MASK];
+    Archetype& source = *record.archetype;
+    if (source.mask == mask)
+    {
+        return;
+    }
+
+    Archetype& destination = getArchetype(mask);
+    uint32_t sourceRow = record.row;
+    uint32_t destinationRow = appendRow(destination, entity);
+
+    Archetype::zipColumns(source, destination, [&](auto& from, auto& to, ComponentMask bit)
+    {
+        if (source.mask & destination.mask & bit)
+        {
+            to[destinationRow] = from[sourceRow];
+        }
+    });
+
+    removeRow(source, sourceRow);
+    record.archetype = &destination;
+    record.row = destinationRow;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <glm/glm/glm.hpp>
+#include <glm/glm/gtc/quaternion.hpp>
+#include "Components.h"
+#include "Transform.h"
+
+// All entities sharing one component mask. Every component field is its own
+// densely packed array indexed by row, so a system only streams the fields it
+// actually touches. Columns of components outside the mask stay empty.
+struct Archetype
+{
+    ComponentMask mask = 0;
+    std::vector<Entity> entities;
+
+    // TRANSFORM
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> previousPositions;
+    std::vector<glm::quat> rotations;
+    std::vector<glm::quat> previousRotations;
+    std::vector<glm::vec3> scales;
+
+    std::vector<Transform> matrixCaches;
+    std::vector<MeshRef> meshes;
+    std::vector<MaterialIndex> materials;
+    std::vector<RigidBody> rigidBodies;
+    std::vector<CurveFollower> curveFollowers;
+    std::vector<NodeId> sceneNodes;
+
+    size_t size() const { return entities.size(); }
+
+    // Calls fn(columnOfA, columnOfB, bit) for every matching pair of columns.
+    template<typename Fn>
+    static void zipColumns(Archetype& a, Archetype& b, Fn&& fn)
+    {
+        fn(a.positions, b.positions, TRANSFORM);
+        fn(a.previousPositions, b.previousPositions, TRANSFORM);
+        fn(a.rotations, b.rotations, TRANSFORM);
+        fn(a.previousRotations, b.previousRotations, TRANSFORM);
+        fn(a.scales, b.scales, TRANSFORM);
+        fn(a.matrixCaches, b.matrixCaches, MATRIX_CACHE);
+        fn(a.meshes, b.meshes, MESH);
+        fn(a.materials, b.materials, MATERIAL);
+        fn(a.rigidBodies, b.rigidBodies, RIGID_BODY);
+        fn(a.curveFollowers, b.curveFollowers, CURVE_FOLLOWER);
+        fn(a.sceneNodes, b.sceneNodes, SCENE_NODE);
+    }
+};
+
+// Archetype based entity storage. Adding or removing components moves the
+// entity's row to the archetype of its new mask; handles stay valid.
+class World
+{
+public:
+    World() = default;
+    World(const World&) = delete;
+    World& operator=(const World&) = delete;
+
+    Entity create(ComponentMask mask);
+    void destroy(Entity entity);
+    bool isAlive(Entity entity) const;
+    // True when the entity has every component in mask.
+    bool has(Entity entity, ComponentMask mask) const;
+    void addComponents(Entity entity, ComponentMask mask);
+    void removeComponents(Entity entity, ComponentMask mask);
+
+    // Preallocates rows in the archetype of mask, for bulk creation.
+    void reserve(ComponentMask mask, size_t count);
+
+    glm::vec3& getPosition(Entity entity) { return at(entity, &Archetype::positions); }
+    glm::vec3& getPreviousPosition(Entity entity) { return at(entity, &Archetype::previousPositions); }
+    glm::quat& getRotation(Entity entity) { return at(entity, &Archetype::rotations); }
+    glm::quat& getPreviousRotation(Entity entity) { return at(entity, &Archetype::previousRotations); }
+    glm::vec3& getScale(Entity entity) { return at(entity, &Archetype::scales); }
+    Transform& getMatrixCache(Entity entity) { return at(entity, &Archetype::matrixCaches); }
+    MeshRef& getMesh(Entity entity) { return at(entity, &Archetype::meshes); }
+    MaterialIndex& getMaterial(Entity entity) { return at(entity, &Archetype::materials); }
+    RigidBody& getRigidBody(Entity entity) { return at(entity, &Archetype::rigidBodies); }
+    CurveFollower& getCurveFollower(Entity entity) { return at(entity, &Archetype::curveFollowers); }
+    NodeId& getSceneNode(Entity entity) { return at(entity, &Archetype::sceneNodes); }
+
+    // Calls fn(archetype) for every non-empty archetype holding all components in mask.
+    template<typename Fn>
+    void forEach(ComponentMask mask, Fn&& fn)
+    {
+        for (const std::unique_ptr<Archetype>& archetype : archetypes)
+        {
+            if ((archetype->mask & mask) == mask && archetype->size() > 0)
+            {
+                fn(*archetype);
+            }
+        }
+    }
+
+    size_t getEntityCount() const { return entityCount; }
+
+private:
+    struct EntityRecord
+    {
+        Archetype* archetype = nullptr;
+        uint32_t row = 0;
+        uint32_t generation = 0;
+    };
+
+    template<typename T>
+    T& at(Entity entity, std::vector<T> Archetype::* column)
+    {
+        EntityRecord& record = records[entity & ENTITY_INDEX_MASK];
+        return (record.archetype->*column)[record.row];
+    }
+
+    Archetype& getArchetype(ComponentMask mask);
+    uint32_t appendRow(Archetype& archetype, Entity entity);
+    void removeRow(Archetype& archetype, uint32_t row);
+    void moveEntity(Entity entity, ComponentMask mask);
+
+    std::vector<std::unique_ptr<Archetype>> archetypes;
+    std::vector<EntityRecord> records;
+    std::vector<uint32_t> freeIndices;
+    size_t entityCount = 0;
+};
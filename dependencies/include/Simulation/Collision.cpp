@@ -0,0 +1,52 @@
+#include "Collision.h"
+
+#include <algorithm>
+
+bool checkSphereAABB(glm::vec3 sphereCenter, float radius, glm::vec3 boxMin, glm::vec3 boxMax)
+{
+    float x = std::max(boxMin.x, std::min(sphereCenter.x, boxMax.x));
+    float y = std::max(boxMin.y, std::min(sphereCenter.y, boxMax.y));
+    float z = std::max(boxMin.z, std::min(sphereCenter.z, boxMax.z));
+
+    float distance = glm::length(glm::vec3(x, y, z) - sphereCenter);
+    return distance < radius;
+}
+
+Frustum Frustum::fromMatrix(const glm::mat4& viewProjection)
+{
+    // Rows of the matrix; glm stores columns.
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    }
+
+    Frustum frustum;
+    frustum.planes[0] = rows[3] + rows[0];
+    frustum.planes[1] = rows[3] - rows[0];
+    frustum.planes[2] = rows[3] + rows[1];
+    frustum.planes[3] = rows[3] - rows[1];
+    frustum.planes[4] = rows[3] + rows[2];
+    frustum.planes[5] = rows[3] - rows[2];
+    for (glm::vec4& plane : frustum.planes)
+    {
+        plane /= glm::length(glm::vec3(plane));
+    }
+    return frustum;
+}
+
+bool Frustum::intersectsAABB(const glm::vec3& boxMin, const glm::vec3& boxMax) const
+{
+    for (const glm::vec4& plane : planes)
+    {
+        // The corner furthest along the plane normal.
+        glm::vec3 corner(plane.x >= 0.0f ? boxMax.x : boxMin.x,
+                         plane.y >= 0.0f ? boxMax.y : boxMin.y,
+                         plane.z >= 0.0f ? boxMax.z : boxMin.z);
+        if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+        {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <glm/glm/glm.hpp>
+
+// True when the sphere overlaps the axis aligned box.
+bool checkSphereAABB(glm::vec3 sphereCenter, float radius, glm::vec3 boxMin, glm::vec3 boxMax);
+
+// The six planes of a view volume, pointing inwards (xyz normal, w distance).
+struct Frustum
+{
+    glm::vec4 planes[6];
+
+    // Extracts the planes of a projection * view matrix (Gribb and Hartmann).
+    static Frustum fromMatrix(const glm::mat4& viewProjection);
+
+    // False only when the box lies entirely outside one of the planes; boxes
+    // crossing a corner of the volume may still be reported as visible.
+    bool intersectsAABB(const glm::vec3& boxMin, const glm::vec3& boxMax) const;
+};
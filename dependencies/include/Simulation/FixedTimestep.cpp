@@ -0,0 +1,36 @@
+#include "FixedTimestep.h"
+
+#include <algorithm>
+
+// Frames longer than this (breakpoints, window drags) are treated as a hitch.
+static const double MAX_FRAME_SECONDS = 0.25;
+
+FixedTimestep::FixedTimestep(double stepSeconds, int maxSubsteps)
+    : step(stepSeconds), maxSubsteps(maxSubsteps)
+{
+}
+
+void FixedTimestep::setStep(double stepSeconds)
+{
+    // Keep the interpolation factor meaningful when the rate changes at runtime.
+    double alpha = accumulator / step;
+    step = stepSeconds;
+    accumulator = std::min(alpha, 1.0) * step;
+}
+
+int FixedTimestep::advance(double frameSeconds)
+{
+    accumulator += std::clamp(frameSeconds, 0.0, MAX_FRAME_SECONDS);
+
+    // The epsilon keeps rounding from leaving a step of almost exactly one in the accumulator.
+    int steps = (int)((accumulator + 1e-9) / step);
+    if (steps > maxSubsteps)
+    {
+        droppedSteps += steps - maxSubsteps;
+        accumulator -= (steps - maxSubsteps) * step;
+        steps = maxSubsteps;
+    }
+
+    accumulator -= steps * step;
+    return steps;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <algorithm>
+
+// Accumulator that turns variable frame times into a whole number of fixed
+// simulation steps. The remainder is exposed as an interpolation factor so the
+// renderer can blend between the previous and the current simulation state.
+class FixedTimestep
+{
+public:
+    FixedTimestep(double stepSeconds, int maxSubsteps = 5);
+
+    void setStep(double stepSeconds);
+    void setMaxSubsteps(int maxSubsteps) { this->maxSubsteps = maxSubsteps; }
+
+    // Adds the elapsed frame time and returns how many steps must run now. When
+    // the simulation falls behind by more than maxSubsteps the excess time is
+    // dropped instead of being carried over, so a slow frame cannot snowball.
+    int advance(double frameSeconds);
+
+    double getStep() const { return step; }
+    float getAlpha() const { return (float)std::clamp(accumulator / step, 0.0, 1.0); }
+    long long getDroppedSteps() const { return droppedSteps; }
+
+private:
+    double step;
+    double accumulator = 0.0;
+    int maxSubsteps;
+    long long droppedSteps = 0;
+};
@@ -0,0 +1,36 @@
+#include "FramePacer.h"
+
+#include <thread>
+
+FramePacer::FramePacer(double targetRate)
+{
+    setTargetRate(targetRate);
+}
+
+void FramePacer::setTargetRate(double targetRate)
+{
+    this->targetRate = targetRate;
+    interval = targetRate > 0.0
+                   ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / targetRate))
+                   : Clock::duration::zero();
+    nextFrame = Clock::now() + interval;
+}
+
+void FramePacer::wait()
+{
+    if (interval == Clock::duration::zero())
+    {
+        return;
+    }
+
+    std::this_thread::sleep_until(nextFrame);
+
+    // If we missed the deadline by more than a frame, restart the schedule from
+    // now instead of rendering a burst of frames to catch up.
+    Clock::time_point now = Clock::now();
+    nextFrame += interval;
+    if (now > nextFrame)
+    {
+        nextFrame = now + interval;
+    }
+}
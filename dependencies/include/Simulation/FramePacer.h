@@ -0,0 +1,22 @@
+#pragma once
+
+#include <chrono>
+
+// Caps the render loop to a target rate by sleeping until the next frame
+// deadline. A rate of zero means uncapped (only vsync, if enabled, limits it).
+class FramePacer
+{
+public:
+    explicit FramePacer(double targetRate = 0.0);
+
+    void setTargetRate(double targetRate);
+    double getTargetRate() const { return targetRate; }
+    void wait();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    double targetRate = 0.0;
+    Clock::duration interval = Clock::duration::zero();
+    Clock::time_point nextFrame;
+};
@@ -0,0 +1,19 @@
+#include "FrameSnapshot.h"
+
+#include <algorithm>
+
+glm::mat4 InterpolatedTransform::getModelMatrix(float alpha) const
+{
+    return Transform::composeWorldMatrix(glm::mix(previousPosition, position, alpha),
+                                         glm::slerp(previousRotation, rotation, alpha), scale);
+}
+
+glm::mat3 InterpolatedTransform::getNormalMatrix(float alpha) const
+{
+    return Transform::composeNormalMatrix(glm::slerp(previousRotation, rotation, alpha), scale);
+}
+
+float FrameSnapshot::getAlpha(double now) const
+{
+    return (float)std::clamp((now - stateTime) / step, 0.0, 1.0);
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <vector>
+#include <GLAD/glad.h>
+#include <glm/glm/glm.hpp>
+#include <glm/glm/gtc/quaternion.hpp>
+#include <Lighting/LightClusters.h>
+#include <Lighting/ShadowMap.h>
+#include <Scene/Components.h>
+#include <Scene/Transform.h>
+
+// Transform at the last two simulation steps. The renderer blends between them
+// with the interpolation factor of the frame it is drawing.
+struct InterpolatedTransform
+{
+    glm::vec3 previousPosition = glm::vec3(0.0f);
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::quat previousRotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+
+    bool isMoving() const { return previousPosition != position || previousRotation != rotation; }
+    glm::mat4 getModelMatrix(float alpha) const;
+    glm::mat3 getNormalMatrix(float alpha) const;
+};
+
+struct DrawItem
+{
+    InterpolatedTransform transform;
+    GLuint VAO = 0;
+    GLsizei vertexCount = 0;
+    GLuint textureID = 0;
+    glm::vec3 boundsCenter = glm::vec3(0.0f);
+    float boundsRadius = 0.0f;
+    // Static items are drawn into the cached shadow layer instead of every frame.
+    bool isStatic = false;
+
+    // Items that did not move between the two steps carry the cached matrices of
+    // their Transform instead of being interpolated every frame.
+    bool interpolated = true;
+    glm::mat4 model = glm::mat4(1.0f);
+    glm::mat3 normalMatrix = glm::mat3(1.0f);
+
+    MaterialIndex materialIndex = 0;
+
+    glm::mat4 getModelMatrix(float alpha) const { return interpolated ? transform.getModelMatrix(alpha) : model; }
+    glm::vec3 getPosition() const { return interpolated ? transform.position : glm::vec3(model[3]); }
+    glm::mat3 getNormalMatrix(float alpha) const
+    {
+        return interpolated ? transform.getNormalMatrix(alpha) : normalMatrix;
+    }
+};
+
+// Everything the render thread needs to draw one frame. Written by the
+// simulation thread, read-only once published.
+struct FrameSnapshot
+{
+    // Wall-clock time the current state corresponds to, and the step it advanced by.
+    double stateTime = 0.0;
+    double step = 1.0 / 60.0;
+
+    glm::vec3 previousCameraPosition = glm::vec3(0.0f);
+    glm::vec3 cameraPosition = glm::vec3(0.0f);
+    glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
+    glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
+
+    int framebufferWidth = 0;
+    int framebufferHeight = 0;
+
+    // Opaque objects, sorted front to back along the camera direction.
+    std::vector<DrawItem> objects;
+    // The score, drawn as text moving along the Hermite path.
+    bool drawScore = false;
+    int score = 0;
+    InterpolatedTransform scoreTransform;
+    glm::vec4 scoreColor = glm::vec4(1.0f);
+
+    glm::vec3 previousBallPosition = glm::vec3(0.0f);
+    glm::vec3 ballPosition = glm::vec3(0.0f);
+    glm::vec3 hoopCenter = glm::vec3(0.0f);
+    bool showParametricCurves = false;
+
+    // Benchmark switch for the object shader's old per-vertex normal matrix path.
+    bool perVertexNormalMatrix = false;
+
+    // Lay down depth before shading, and count fragments shaded per pixel.
+    bool depthPrePass = false;
+    bool showOverdraw = false;
+    // Frame-time graph and draw statistics overlay.
+    bool showHUD = false;
+    // Let the governor trade resolution and detail for GPU time.
+    bool dynamicResolution = false;
+
+    // Read the frame back for the capture worker (every stride-th frame).
+    bool capturing = false;
+    // Changes when a pass timing table was requested.
+    unsigned int profileReportVersion = 0;
+    // Changes with every particle burst out of the hoop, and when the particle benchmark was requested.
+    unsigned int celebrationVersion = 0;
+    unsigned int particleBenchmarkVersion = 0;
+
+    ShadowSettings shadowSettings;
+    unsigned int staticShadowVersion = 0;
+
+    // Point lights at the current step, with their positions at the previous one.
+    std::vector<PointLight> pointLights;
+    std::vector<glm::vec3> previousPointLightPositions;
+
+    bool flashScreen = false;
+    float flashTimer = 0.0f;
+
+    double renderRateLimit = 0.0;
+    bool vsync = true;
+
+    float getAlpha(double now) const;
+};
@@ -0,0 +1,168 @@
+#include "InputRecording.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+const char MAGIC[4] = {'B', 'I', 'N', 'P'};
+const uint32_t VERSION = 1;
+
+void writeUnsigned(std::ostream& out, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+    {
+        out.put((char)((value >> (8 * i)) & 0xFF));
+    }
+}
+
+uint64_t readUnsigned(std::istream& in, int bytes)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i)
+    {
+        value |= (uint64_t)(unsigned char)in.get() << (8 * i);
+    }
+    return value;
+}
+
+void writeDouble(std::ostream& out, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    writeUnsigned(out, bits, 8);
+}
+
+double readDouble(std::istream& in)
+{
+    uint64_t bits = readUnsigned(in, 8);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+}
+
+void InputRecording::beginFrame(double deltaTime)
+{
+    frames.emplace_back();
+    frames.back().deltaTime = deltaTime;
+}
+
+void InputRecording::addEvent(const InputEvent& event)
+{
+    // The file stores the event count of a frame in 16 bits.
+    if (!frames.empty() && frames.back().events.size() < 0xFFFF)
+    {
+        frames.back().events.push_back(event);
+    }
+}
+
+bool InputRecording::save(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+
+    file.write(MAGIC, sizeof(MAGIC));
+    writeUnsigned(file, VERSION, 4);
+    writeDouble(file, simulationStep);
+    writeUnsigned(file, frames.size(), 4);
+
+    for (const InputFrame& frame : frames)
+    {
+        writeDouble(file, frame.deltaTime);
+        writeUnsigned(file, frame.events.size(), 2);
+        for (const InputEvent& event : frame.events)
+        {
+            writeUnsigned(file, (uint8_t)event.type, 1);
+            switch (event.type)
+            {
+            case InputEventType::Key:
+                // GLFW key codes fit in 16 bits, actions and modifier bits in 8.
+                writeUnsigned(file, (uint16_t)event.code, 2);
+                writeUnsigned(file, (uint16_t)event.scancode, 2);
+                writeUnsigned(file, (uint8_t)event.action, 1);
+                writeUnsigned(file, (uint8_t)event.mods, 1);
+                break;
+            case InputEventType::MouseButton:
+                writeUnsigned(file, (uint8_t)event.code, 1);
+                writeUnsigned(file, (uint8_t)event.action, 1);
+                writeUnsigned(file, (uint8_t)event.mods, 1);
+                break;
+            case InputEventType::CursorPos:
+                writeDouble(file, event.x);
+                writeDouble(file, event.y);
+                break;
+            }
+        }
+    }
+
+    return (bool)file;
+}
+
+bool InputRecording::load(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(MAGIC)] = {};
+    if (!file || !file.read(magic, sizeof(magic)) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+    {
+        std::cerr << "Not an input recording: " << path << std::endl;
+        return false;
+    }
+
+    uint32_t version = (uint32_t)readUnsigned(file, 4);
+    if (version != VERSION)
+    {
+        std::cerr << "Unsupported input recording version " << version << ": " << path << std::endl;
+        return false;
+    }
+
+    simulationStep = readDouble(file);
+    uint32_t frameCount = (uint32_t)readUnsigned(file, 4);
+    frames.clear();
+    frames.reserve(frameCount);
+
+    for (uint32_t i = 0; i < frameCount && file; ++i)
+    {
+        InputFrame& frame = frames.emplace_back();
+        frame.deltaTime = readDouble(file);
+        uint16_t eventCount = (uint16_t)readUnsigned(file, 2);
+        frame.events.resize(eventCount);
+        for (InputEvent& event : frame.events)
+        {
+            event.type = (InputEventType)readUnsigned(file, 1);
+            switch (event.type)
+            {
+            case InputEventType::Key:
+                event.code = (int16_t)readUnsigned(file, 2);
+                event.scancode = (int16_t)readUnsigned(file, 2);
+                event.action = (int)readUnsigned(file, 1);
+                event.mods = (int)readUnsigned(file, 1);
+                break;
+            case InputEventType::MouseButton:
+                event.code = (int)readUnsigned(file, 1);
+                event.action = (int)readUnsigned(file, 1);
+                event.mods = (int)readUnsigned(file, 1);
+                break;
+            case InputEventType::CursorPos:
+                event.x = readDouble(file);
+                event.y = readDouble(file);
+                break;
+            default:
+                file.setstate(std::ios::failbit);
+                break;
+            }
+        }
+    }
+
+    if (!file)
+    {
+        std::cerr << "Truncated input recording: " << path << std::endl;
+        frames.clear();
+        return false;
+    }
+    return true;
+}
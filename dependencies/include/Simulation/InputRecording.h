@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class InputEventType : uint8_t
+{
+    Key,
+    MouseButton,
+    CursorPos
+};
+
+// One window callback, with the same arguments GLFW passed to it.
+struct InputEvent
+{
+    InputEventType type = InputEventType::Key;
+    // Key or mouse button.
+    int code = 0;
+    int scancode = 0;
+    int action = 0;
+    int mods = 0;
+    double x = 0.0;
+    double y = 0.0;
+};
+
+// One iteration of the main loop: the time it advanced the virtual clock by and
+// the input events handled at its end.
+struct InputFrame
+{
+    double deltaTime = 0.0;
+    std::vector<InputEvent> events;
+};
+
+// Input and frame times of a session, for replaying it deterministically. Fed the
+// same frame times and the same events in the same order, the fixed step
+// simulation goes through exactly the same states.
+//
+// The file is little endian: a header with the simulation step the session was
+// recorded with, then per frame the delta time and the events it handled, each
+// packed to the bytes its type needs.
+class InputRecording
+{
+public:
+    // Starts a new frame; events added afterwards belong to it.
+    void beginFrame(double deltaTime);
+    void addEvent(const InputEvent& event);
+    void clear() { frames.clear(); }
+
+    size_t getFrameCount() const { return frames.size(); }
+    const InputFrame& getFrame(size_t index) const { return frames[index]; }
+    double getSimulationStep() const { return simulationStep; }
+    void setSimulationStep(double step) { simulationStep = step; }
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+private:
+    std::vector<InputFrame> frames;
+    double simulationStep = 0.0;
+};
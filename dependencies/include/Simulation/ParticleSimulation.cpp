@@ -0,0 +1,196 @@
+#include "ParticleSimulation.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PARTICLES_SSE 1
+#endif
+
+namespace
+{
+    const float PI = 3.14159265f;
+
+    // Consumes one hash step and maps its top 24 bits to [0, 1), exactly as the shaders do.
+    float nextRandom(unsigned int& state)
+    {
+        state = hashParticle(state);
+        return (float)(state >> 8) * (1.0f / 16777216.0f);
+    }
+
+    int roundUpToLanes(int count)
+    {
+        return (count + 3) & ~3;
+    }
+}
+
+unsigned int hashParticle(unsigned int value)
+{
+    unsigned int state = value * 747796405u + 2891336453u;
+    unsigned int word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+Particle makeParticle(const ParticleSettings& settings, const ParticleBurst& burst, unsigned int index)
+{
+    unsigned int state = index * 2654435769u + burst.seed;
+
+    float azimuth = nextRandom(state) * 2.0f * PI;
+    float cosTheta = 1.0f + (std::cos(glm::radians(settings.spreadDegrees)) - 1.0f) * nextRandom(state);
+    float sinTheta = std::sqrt(std::max(1.0f - cosTheta * cosTheta, 0.0f));
+    float speed = settings.minSpeed + (settings.maxSpeed - settings.minSpeed) * nextRandom(state);
+    float lifetime = settings.minLifetime + (settings.maxLifetime - settings.minLifetime) * nextRandom(state);
+    float colorMix = nextRandom(state);
+
+    Particle particle;
+    particle.position = burst.origin;
+    particle.velocity = glm::vec3(sinTheta * std::cos(azimuth), cosTheta, sinTheta * std::sin(azimuth)) * speed;
+    particle.life = lifetime;
+    particle.lifetime = lifetime;
+    particle.color = settings.colorA + (settings.colorB - settings.colorA) * colorMix;
+    return particle;
+}
+
+ParticleSimulation::ParticleSimulation(int capacity)
+    : capacity(capacity)
+{
+    size_t lanes = roundUpToLanes(capacity);
+    for (std::vector<float>* column : {&positionX, &positionY, &positionZ, &velocityX, &velocityY, &velocityZ,
+                                       &life, &lifetime})
+    {
+        column->assign(lanes, 0.0f);
+    }
+    colors.assign(capacity, glm::vec4(0.0f));
+}
+
+int ParticleSimulation::emit(const ParticleSettings& settings, const ParticleBurst& burst)
+{
+    int emitted = std::clamp(burst.count, 0, capacity - count);
+    for (int i = 0; i < emitted; ++i)
+    {
+        Particle particle = makeParticle(settings, burst, (unsigned int)i);
+        int row = count + i;
+        positionX[row] = particle.position.x;
+        positionY[row] = particle.position.y;
+        positionZ[row] = particle.position.z;
+        velocityX[row] = particle.velocity.x;
+        velocityY[row] = particle.velocity.y;
+        velocityZ[row] = particle.velocity.z;
+        life[row] = particle.life;
+        lifetime[row] = particle.lifetime;
+        colors[row] = particle.color;
+    }
+    count += emitted;
+    return emitted;
+}
+
+void ParticleSimulation::update(const ParticleSettings& settings, float dt)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    integrate(settings, dt);
+    compact();
+}
+
+void ParticleSimulation::integrate(const ParticleSettings& settings, float dt)
+{
+    float damping = std::max(1.0f - settings.drag * dt, 0.0f);
+    glm::vec3 deltaVelocity = settings.gravity * dt;
+    int lanes = roundUpToLanes(count);
+
+#ifdef PARTICLES_SSE
+    const __m128 dt4 = _mm_set1_ps(dt);
+    const __m128 damping4 = _mm_set1_ps(damping);
+    const __m128 deltaX = _mm_set1_ps(deltaVelocity.x);
+    const __m128 deltaY = _mm_set1_ps(deltaVelocity.y);
+    const __m128 deltaZ = _mm_set1_ps(deltaVelocity.z);
+    const __m128 floor4 = _mm_set1_ps(settings.floorHeight);
+    const __m128 bounce4 = _mm_set1_ps(-settings.restitution);
+
+    for (int i = 0; i < lanes; i += 4)
+    {
+        __m128 vx = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&velocityX[i]), deltaX), damping4);
+        __m128 vy = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&velocityY[i]), deltaY), damping4);
+        __m128 vz = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&velocityZ[i]), deltaZ), damping4);
+
+        __m128 px = _mm_add_ps(_mm_loadu_ps(&positionX[i]), _mm_mul_ps(vx, dt4));
+        __m128 py = _mm_add_ps(_mm_loadu_ps(&positionY[i]), _mm_mul_ps(vy, dt4));
+        __m128 pz = _mm_add_ps(_mm_loadu_ps(&positionZ[i]), _mm_mul_ps(vz, dt4));
+
+        // Below the floor: clamp onto it and reflect the vertical speed.
+        __m128 below = _mm_cmplt_ps(py, floor4);
+        py = _mm_max_ps(py, floor4);
+        vy = _mm_or_ps(_mm_and_ps(below, _mm_mul_ps(vy, bounce4)), _mm_andnot_ps(below, vy));
+
+        _mm_storeu_ps(&velocityX[i], vx);
+        _mm_storeu_ps(&velocityY[i], vy);
+        _mm_storeu_ps(&velocityZ[i], vz);
+        _mm_storeu_ps(&positionX[i], px);
+        _mm_storeu_ps(&positionY[i], py);
+        _mm_storeu_ps(&positionZ[i], pz);
+        _mm_storeu_ps(&life[i], _mm_sub_ps(_mm_loadu_ps(&life[i]), dt4));
+    }
+#else
+    for (int i = 0; i < lanes; ++i)
+    {
+        velocityX[i] = (velocityX[i] + deltaVelocity.x) * damping;
+        velocityY[i] = (velocityY[i] + deltaVelocity.y) * damping;
+        velocityZ[i] = (velocityZ[i] + deltaVelocity.z) * damping;
+
+        positionX[i] += velocityX[i] * dt;
+        positionY[i] += velocityY[i] * dt;
+        positionZ[i] += velocityZ[i] * dt;
+
+        if (positionY[i] < settings.floorHeight)
+        {
+            positionY[i] = settings.floorHeight;
+            velocityY[i] *= -settings.restitution;
+        }
+
+        life[i] -= dt;
+    }
+#endif
+}
+
+void ParticleSimulation::compact()
+{
+    int alive = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        if (life[i] <= 0.0f)
+        {
+            continue;
+        }
+        if (alive != i)
+        {
+            positionX[alive] = positionX[i];
+            positionY[alive] = positionY[i];
+            positionZ[alive] = positionZ[i];
+            velocityX[alive] = velocityX[i];
+            velocityY[alive] = velocityY[i];
+            velocityZ[alive] = velocityZ[i];
+            life[alive] = life[i];
+            lifetime[alive] = lifetime[i];
+            colors[alive] = colors[i];
+        }
+        alive++;
+    }
+    count = alive;
+}
+
+void ParticleSimulation::gather(std::vector<Particle>& particles) const
+{
+    particles.resize(count);
+    for (int i = 0; i < count; ++i)
+    {
+        Particle& particle = particles[i];
+        particle.position = glm::vec3(positionX[i], positionY[i], positionZ[i]);
+        particle.life = life[i];
+        particle.velocity = glm::vec3(velocityX[i], velocityY[i], velocityZ[i]);
+        particle.lifetime = lifetime[i];
+        particle.color = colors[i];
+    }
+}
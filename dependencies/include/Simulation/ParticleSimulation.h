@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm/glm.hpp>
+
+// Matches the std430 layout of Particle in the particle shaders, and the vertex
+// layout they are drawn and captured with.
+struct Particle
+{
+    glm::vec3 position = glm::vec3(0.0f);
+    // Seconds left; the particle is removed once it reaches zero.
+    float life = 0.0f;
+    glm::vec3 velocity = glm::vec3(0.0f);
+    float lifetime = 1.0f;
+    glm::vec4 color = glm::vec4(1.0f);
+};
+
+// How bursts are shaped and how particles move. The GPU paths receive the same
+// values as uniforms.
+struct ParticleSettings
+{
+    glm::vec3 gravity = glm::vec3(0.0f, -9.81f, 0.0f);
+    // Fraction of the velocity lost per second.
+    float drag = 0.8f;
+    float floorHeight = -1.0f;
+    // Fraction of the vertical speed kept when bouncing off the floor.
+    float restitution = 0.4f;
+    // Half angle of the upward cone particles leave the origin in.
+    float spreadDegrees = 55.0f;
+    float minSpeed = 4.0f;
+    float maxSpeed = 13.0f;
+    float minLifetime = 1.2f;
+    float maxLifetime = 2.8f;
+    // Particles pick a color between these two.
+    glm::vec4 colorA = glm::vec4(1.0f, 0.55f, 0.1f, 1.0f);
+    glm::vec4 colorB = glm::vec4(1.0f, 0.95f, 0.6f, 1.0f);
+    // Billboard edge length in world units.
+    float size = 0.12f;
+};
+
+// One emission request. Particle i of a burst is derived from hashing the seed
+// and i alone, so every path creates the same particles for the same burst.
+struct ParticleBurst
+{
+    glm::vec3 origin = glm::vec3(0.0f);
+    unsigned int seed = 0;
+    int count = 0;
+};
+
+// Integer hash the emitters draw their random numbers from (PCG output permutation).
+unsigned int hashParticle(unsigned int value);
+Particle makeParticle(const ParticleSettings& settings, const ParticleBurst& burst, unsigned int index);
+
+// CPU reference of the GPU particle simulation. Particles are kept as separate
+// arrays per component, padded to a multiple of four, so integration runs four
+// particles per SSE instruction; dead particles are then compacted away,
+// keeping the survivors in order. Used when the GPU paths are unavailable, and
+// to check them.
+class ParticleSimulation
+{
+public:
+    explicit ParticleSimulation(int capacity);
+
+    // Appends the burst's particles, as many as fit. Returns the number emitted.
+    int emit(const ParticleSettings& settings, const ParticleBurst& burst);
+    // Moves every particle by dt seconds and removes the ones whose life ran out.
+    void update(const ParticleSettings& settings, float dt);
+    void clear() { count = 0; }
+
+    int getCount() const { return count; }
+    int getCapacity() const { return capacity; }
+    // Replaces particles with the live particles, in the GPU layout.
+    void gather(std::vector<Particle>& particles) const;
+
+private:
+    void integrate(const ParticleSettings& settings, float dt);
+    void compact();
+
+    int capacity;
+    int count = 0;
+    std::vector<float> positionX;
+    std::vector<float> positionY;
+    std::vector<float> positionZ;
+    std::vector<float> velocityX;
+    std::vector<float> velocityY;
+    std::vector<float> velocityZ;
+    std::vector<float> life;
+    std::vector<float> lifetime;
+    std::vector<glm::vec4> colors;
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+
+// Lock-free single producer / single consumer triple buffer. The producer always
+// has a private slot to write into and the consumer always reads the most recently
+// published slot, so neither side ever waits on the other. Slots are reused, which
+// keeps vectors inside T from reallocating once they reached their working size.
+template <typename T>
+class TripleBuffer
+{
+public:
+    // Slot the producer may fill before calling publish().
+    T& beginWrite() { return slots[backIndex]; }
+
+    void publish()
+    {
+        int previous = middle.exchange(backIndex | FRESH_BIT, std::memory_order_acq_rel);
+        backIndex = previous & INDEX_MASK;
+    }
+
+    // Latest published slot. Returns false when nothing new was published since the
+    // last call, in which case the previously acquired slot is still valid.
+    bool acquire()
+    {
+        if ((middle.load(std::memory_order_relaxed) & FRESH_BIT) == 0)
+        {
+            return false;
+        }
+
+        int previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+        frontIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+    const T& front() const { return slots[frontIndex]; }
+
+private:
+    static const int FRESH_BIT = 4;
+    static const int INDEX_MASK = 3;
+
+    T slots[3];
+    int backIndex = 0;
+    int frontIndex = 1;
+    std::atomic<int> middle{2};
+};
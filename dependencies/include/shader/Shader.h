@@ -12,18 +12,32 @@
 // GLFW
 #include <GLFW/glfw3.h>
 
+#include <Profiling/CPUProfiler.h>
+#include <Rendering/GLExtensions.h>
+
 using namespace std;
 
 class Shader
 {
 public:
 	GLuint ID;
-	// Constructor generates the shader on the fly
-	Shader(const GLchar* vertexPath, const GLchar* fragmentPath)
+	// Constructor generates the shader on the fly; the geometry stage is optional.
+	// defines (e.g. "#define NAME\n") are inserted after the #version line of every stage,
+	// to build variants of one source file; the source at fragmentIncludePath follows them
+	// in the fragment stage, to share declarations and functions between programs
+	// Compiling and linking are only submitted: the statuses are not queried, since that
+	// waits for the compiler. With parallel compilation the driver builds every program
+	// constructed so far on its own threads; isReady() tells when one is done and
+	// finish() reports the errors.
+	Shader(const GLchar* vertexPath, const GLchar* fragmentPath, const GLchar* geometryPath = nullptr,
+	       const GLchar* defines = nullptr, const GLchar* fragmentIncludePath = nullptr)
 	{
+		PROFILE_SCOPE("Shader");
 		// 1. Retrieve the vertex/fragment source code from filePath
 		std::string vertexCode;
 		std::string fragmentCode;
+		std::string geometryCode;
+		std::string includeCode;
 		std::ifstream vShaderFile;
 		std::ifstream fShaderFile;
 		// ensures ifstream objects can throw exceptions:
@@ -44,56 +58,120 @@ public:
 			// Convert stream into string
 			vertexCode = vShaderStream.str();
 			fragmentCode = fShaderStream.str();
+			if (geometryPath)
+			{
+				std::ifstream gShaderFile(geometryPath);
+				std::stringstream gShaderStream;
+				gShaderStream << gShaderFile.rdbuf();
+				geometryCode = gShaderStream.str();
+			}
+			if (fragmentIncludePath)
+			{
+				std::ifstream includeFile(fragmentIncludePath);
+				std::stringstream includeStream;
+				includeStream << includeFile.rdbuf();
+				includeCode = includeStream.str();
+			}
 		}
 		catch (std::ifstream::failure e)
 		{
 			std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
 		}
-		const GLchar* vShaderCode = vertexCode.c_str();
-		const GLchar * fShaderCode = fragmentCode.c_str();
-		// 2. Compile shaders
-		GLuint vertex, fragment;
-		GLint success;
-		GLchar infoLog[512];
-		// Vertex Shader
-		vertex = glCreateShader(GL_VERTEX_SHADER);
-		glShaderSource(vertex, 1, &vShaderCode, NULL);
-		glCompileShader(vertex);
-		// Print compile errors if any
-		glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
-		if (!success)
+		if (!includeCode.empty())
 		{
-			glGetShaderInfoLog(vertex, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
+			size_t lineEnd = fragmentCode.find('\n');
+			if (lineEnd != std::string::npos)
+			{
+				fragmentCode.insert(lineEnd + 1, includeCode);
+			}
 		}
-		// Fragment Shader
-		fragment = glCreateShader(GL_FRAGMENT_SHADER);
-		glShaderSource(fragment, 1, &fShaderCode, NULL);
-		glCompileShader(fragment);
-		// Print compile errors if any
-		glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-		if (!success)
+		if (defines)
+		{
+			for (std::string* code : {&vertexCode, &fragmentCode, &geometryCode})
+			{
+				size_t lineEnd = code->find('\n');
+				if (lineEnd != std::string::npos)
+				{
+					code->insert(lineEnd + 1, defines);
+				}
+			}
+		}
+		// 2. Compile shaders
+		stages[0] = compileStage(GL_VERTEX_SHADER, vertexCode);
+		stages[1] = compileStage(GL_FRAGMENT_SHADER, fragmentCode);
+		if (geometryPath)
 		{
-			glGetShaderInfoLog(fragment, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
+			stages[2] = compileStage(GL_GEOMETRY_SHADER, geometryCode);
 		}
 		// Shader Program
 		this->ID = glCreateProgram();
-		glAttachShader(this->ID, vertex);
-		glAttachShader(this->ID, fragment);
+		for (GLuint stage : stages)
+		{
+			if (stage)
+			{
+				glAttachShader(this->ID, stage);
+			}
+		}
 		glLinkProgram(this->ID);
+	}
+
+	// True once the program is linked, or failed to; never waits. Without parallel
+	// compilation there is no way to ask, and the first use waits instead.
+	bool isReady() const
+	{
+		if (finished || !glCapabilities.parallelShaderCompile)
+		{
+			return true;
+		}
+		GLint completed = GL_FALSE;
+		glGetProgramiv(this->ID, GL_COMPLETION_STATUS_KHR, &completed);
+		return completed == GL_TRUE;
+	}
+
+	// Waits for the program, prints the compile and link errors if any, and deletes
+	// the stages. Returns whether it linked.
+	bool finish()
+	{
+		if (finished)
+		{
+			return linked;
+		}
+		finished = true;
+
+		GLint success;
+		GLchar infoLog[512];
+		const char* stageNames[] = {"VERTEX", "FRAGMENT", "GEOMETRY"};
+		for (int i = 0; i < 3; ++i)
+		{
+			if (!stages[i])
+			{
+				continue;
+			}
+			// Print compile errors if any
+			glGetShaderiv(stages[i], GL_COMPILE_STATUS, &success);
+			if (!success)
+			{
+				glGetShaderInfoLog(stages[i], 512, NULL, infoLog);
+				std::cout << "ERROR::SHADER::" << stageNames[i] << "::COMPILATION_FAILED\n" << infoLog << std::endl;
+			}
+		}
 		// Print linking errors if any
 		glGetProgramiv(this->ID, GL_LINK_STATUS, &success);
+		linked = success;
 		if (!success)
 		{
 			glGetProgramInfoLog(this->ID, 512, NULL, infoLog);
 			std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
 		}
 		// Delete the shaders as they're linked into our program now and no longer necessery
-		glDeleteShader(vertex);
-		glDeleteShader(fragment);
-
+		for (GLuint& stage : stages)
+		{
+			glDeleteShader(stage);
+			stage = 0;
+		}
+		return linked;
 	}
+
 	// Uses the current shader
 	void Use()
 	{
@@ -136,4 +214,19 @@ public:
 	{
 		glUniformMatrix4fv(glGetUniformLocation(this->ID, name.c_str()), 1, GL_FALSE, v);
 	}
+
+private:
+	static GLuint compileStage(GLenum type, const std::string& code)
+	{
+		const GLchar* source = code.c_str();
+		GLuint stage = glCreateShader(type);
+		glShaderSource(stage, 1, &source, NULL);
+		glCompileShader(stage);
+		return stage;
+	}
+
+	// Vertex, fragment and geometry stages, released by finish().
+	GLuint stages[3] = {0, 0, 0};
+	bool finished = false;
+	bool linked = false;
 };
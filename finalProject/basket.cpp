@@ -13,8 +13,44 @@
 #include <stb_image/stb_image.h>
 #include <random>
 #include <algorithm>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <limits>
 #include <ParametricCurves/Bezier.h>
 #include <ParametricCurves/Hermite.h>
+#include <Rendering/RingBuffer.h>
+#include <Rendering/CommandBackend.h>
+#include <Rendering/HeadlessContext.h>
+#include <Rendering/ImpostorRenderer.h>
+#include <Rendering/MaterialTable.h>
+#include <Rendering/FrameCapture.h>
+#include <Rendering/GPUProfiler.h>
+#include <Rendering/ObjLoader.h>
+#include <Rendering/ParticleSystem.h>
+#include <Rendering/PendingPrograms.h>
+#include <Rendering/PerfHUD.h>
+#include <Rendering/RenderStats.h>
+#include <Rendering/RenderTarget.h>
+#include <Rendering/ResolutionGovernor.h>
+#include <Rendering/TextRenderer.h>
+#include <Rendering/VertexArrays.h>
+#include <Profiling/CPUProfiler.h>
+#include <Lighting/LightClusters.h>
+#include <Lighting/ShadowMap.h>
+#include <Simulation/Collision.h>
+#include <Simulation/FixedTimestep.h>
+#include <Simulation/FramePacer.h>
+#include <Simulation/FrameSnapshot.h>
+#include <Simulation/InputRecording.h>
+#include <Simulation/TripleBuffer.h>
+#include <Scene/Transform.h>
+#include <Scene/SceneGraph.h>
+#include <Scene/World.h>
+#include <Scene/Systems.h>
 #include <nlohmann/json.hpp>
 
 using json = nlohmann::json;
@@ -24,31 +60,181 @@ using namespace std;
 // Structs
 // ------------------------
 
+// Mesh and material loaded from an OBJ file. Where and how it is placed in the
+// scene lives in the entity world.
 struct Geometry
 {
-    GLuint VAO;
-    GLuint vertexCount;
-    GLuint textureID = 0;
+    MeshRef mesh;
+    MaterialIndex materialIndex;
     string textureFilePath;
-    glm::vec3 position;
-    float scaleFactor = 0.07;
-    string name = "";
-
-    glm::vec3 ka;
-    glm::vec3 kd;
-    glm::vec3 ks;
-    glm::vec3 ke;
-    float shininess = 32.0f;
 };
 
-struct Material
+// Ball throw requested by the mouse, launched on the next simulation step.
+enum class BallThrow
 {
-    glm::vec3 ka;
-    glm::vec3 kd;
-    glm::vec3 ks;
-    glm::vec3 ke;
-    float shininess;
-    string texturePath;
+    None,
+    Straight,
+    Bezier
+};
+
+// Path of one animated point light around the court.
+struct LightOrbit
+{
+    float radius;
+    float height;
+    float phase;
+    float speed;
+};
+
+// Cluster build statistics collected on the render thread after the light count changes.
+struct LightingBenchmark
+{
+    int lightCount = -1;
+    int frames = 0;
+    double buildMilliseconds = 0.0;
+    double frameMilliseconds = 0.0;
+    long long lightIndices = 0;
+};
+
+// The GPU profiler times the scene object pass; after the normal matrix path
+// changes, its average over the next BENCHMARK_FRAMES frames is printed to compare
+// the uniform normal matrix against computing it per vertex in the shader.
+struct VertexStageBenchmark
+{
+    bool perVertexNormalMatrix = false;
+    bool reported = false;
+};
+
+// Depth-only programs for the pre-pass. Each links the vertex shader of its
+// shading pass with an empty fragment shader.
+struct DepthPrePass
+{
+    Shader* objectShader;
+    Shader* floorShader;
+    GLint objectModelLoc;
+    GLint floorModelLoc;
+};
+
+// The object shader built with IMPOSTOR_FADE, for meshes crossfading into their
+// impostor: it discards the share of the pixels the impostor draws.
+struct FadingObjects
+{
+    Shader* shader;
+    GLint modelLoc;
+    GLint normalMatrixLoc;
+    GLint perVertexNormalMatrixLoc;
+    GLint materialIndexLoc;
+    GLint impostorFadeLoc;
+    GLint cameraPosLoc;
+};
+
+// Fragments shaded per pixel, counted in the stencil buffer while the overdraw view is on.
+struct OverdrawCounter
+{
+    std::vector<GLubyte> stencil;
+    bool depthPrePass = false;
+    int frames = 0;
+    double fragmentsPerPixel = 0.0;
+    int maxFragments = 0;
+};
+
+// Scene graph nodes making up the hoop assembly.
+struct HoopNodes
+{
+    NodeId root = INVALID_NODE;
+    NodeId mesh = INVALID_NODE;
+    NodeId backboard = INVALID_NODE;
+    NodeId rim = INVALID_NODE;
+    NodeId scoreZone = INVALID_NODE;
+    NodeId pole = INVALID_NODE;
+};
+
+struct HoopColliders
+{
+    glm::vec3 backboardMin;
+    glm::vec3 backboardMax;
+    glm::vec3 rimMin;
+    glm::vec3 rimMax;
+    glm::vec3 scoreZoneMin;
+    glm::vec3 scoreZoneMax;
+    glm::vec3 hoopCenter;
+    glm::vec3 poleMin;
+    glm::vec3 poleMax;
+};
+
+// GL objects used by the render thread once the frame loop starts.
+struct RenderResources
+{
+    // Exactly one of the two is set: headless runs have no window.
+    GLFWwindow* window;
+    HeadlessContext* headlessContext;
+    // Where finished frames go: the window's default framebuffer, or the headless one.
+    GLuint outputFramebuffer = 0;
+    Shader* shader;
+    Shader* backgroundShader;
+    Shader* backgroundStarsShader;
+    Shader* curvesShader;
+    GLint modelLoc;
+    GLint normalMatrixLoc;
+    GLint perVertexNormalMatrixLoc;
+    GLint materialIndexLoc;
+    GLint cameraPosLoc;
+    GLint modelLocFloor;
+    GLuint backgroundVAO;
+    GLuint backgroundTexture;
+    GLuint backgroundStarsVAO;
+    GLuint backgroundStarsTexture;
+    Bezier* bezier;
+    Hermite* hermite;
+    RingBuffer* frameRing;
+    LightClusters* lightClusters;
+    ShadowMap* shadowMap;
+    DepthPrePass depthPrePass;
+    // Set once the impostor programs are ready.
+    FadingObjects fadingObjects = {};
+    ImpostorRenderer* impostorRenderer = nullptr;
+    MaterialTable* materialTable;
+    Shader* overdrawShader;
+    GLint overdrawColorLoc;
+    FrameCapture* frameCapture;
+    GPUProfiler* gpuProfiler;
+    PerfHUD* perfHUD;
+    TextRenderer* textRenderer;
+    ParticlePrograms* particlePrograms;
+    ParticleSystem* particleSystem;
+    ResolutionGovernor* resolutionGovernor;
+    RenderTarget* sceneTarget;
+    // Sampler for the scene textures, carrying the governor's LOD bias.
+    GLuint textureSampler;
+    std::vector<PointLight> frameLights;
+    // Impostor fade of every snapshot object this frame, 0 for the mesh alone.
+    std::vector<float> impostorFades;
+    LightingBenchmark lightingBenchmark;
+    VertexStageBenchmark vertexStageBenchmark;
+    OverdrawCounter overdrawCounter;
+    unsigned int profileReportVersion = 0;
+    unsigned int celebrationVersion = 0;
+    unsigned int particleBenchmarkVersion = 0;
+    // Setup of the programs still compiling when the frame loop started.
+    PendingPrograms pendingPrograms;
+    // The passes of the frame, recorded and submitted to commandBackend up to submittedCommands.
+    CommandBackend* commandBackend = nullptr;
+    CommandBuffer commands;
+    size_t submittedCommands = 0;
+    // Snapshot time the particles were last advanced to.
+    double particleTime = 0.0;
+    long long governorFrames = 0;
+    QualityLevel quality;
+    RenderStats renderStats;
+    // Every frame's CPU time and interval, kept while benchmarking a replay.
+    std::vector<double> benchmarkFrameTimes;
+    std::vector<double> benchmarkFrameIntervals;
+};
+
+struct FrameUniforms
+{
+    glm::mat4 view;
+    glm::mat4 projection;
 };
 
 struct Camera
@@ -59,6 +245,7 @@ struct Camera
     glm::vec3 Right;
     glm::vec3 WorldUp;
     glm::vec3 InitialPosition;
+    glm::vec3 PreviousPosition;
 
     float Yaw;
     float Pitch;
@@ -66,8 +253,10 @@ struct Camera
     float Speed;
     float Sensitivity;
 
+    // Movement runs once per simulation step; the speed matches the old behaviour,
+    // where it was applied once per drawn object plus once per frame.
     Camera(glm::vec3 position, glm::vec3 up, float yaw, float pitch)
-        : Front(glm::vec3(0.0f, 0.0f, -1.0f)), Speed(1.0f), Sensitivity(0.1f)
+        : Front(glm::vec3(0.0f, 0.0f, -1.0f)), Speed(4.0f), Sensitivity(0.1f)
     {
         Position = position;
         WorldUp = up;
@@ -75,6 +264,7 @@ struct Camera
         Pitch = pitch;
         updateCameraVectors();
         InitialPosition = position;
+        PreviousPosition = position;
     }
 
     glm::mat4 GetViewMatrix()
@@ -82,6 +272,22 @@ struct Camera
         return glm::lookAt(Position, Position + Front, Up);
     }
 
+    glm::mat4 GetViewMatrix(float alpha)
+    {
+        glm::vec3 position = GetInterpolatedPosition(alpha);
+        return glm::lookAt(position, position + Front, Up);
+    }
+
+    glm::vec3 GetInterpolatedPosition(float alpha)
+    {
+        return glm::mix(PreviousPosition, Position, alpha);
+    }
+
+    void BeginStep()
+    {
+        PreviousPosition = Position;
+    }
+
     void ProcessKeyboard(const string& direction, float deltaTime)
     {
         float velocity = Speed * deltaTime;
@@ -140,21 +346,60 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mode
 void continousKeyPress(GLFWwindow* window, Camera& camera, float currentTime);
 void mouseCallback(GLFWwindow* window, double xpos, double ypos);
 void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
+void liveKeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void liveCursorPosCallback(GLFWwindow* window, double xpos, double ypos);
+void liveMouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
+void handleLiveInput(GLFWwindow* window, const InputEvent& event);
+void dispatchInput(GLFWwindow* window, const InputEvent& event);
+bool isKeyDown(GLFWwindow* window, int key);
+void replayInputFrame(GLFWwindow* window, double frameEndTime);
+uint64_t getStateChecksum();
+void printFrameTimeStats(const string& label, std::vector<double> milliseconds);
 void framebufferSizeCallback(GLFWwindow* window, int width, int height);
-Geometry setupGeometry(const char* filepath);
-bool loadObject(const char* path,
-                std::vector<glm::vec3>& out_vertices,
-                std::vector<glm::vec2>& out_uvs,
-                std::vector<glm::vec3>& out_normals);
+Geometry setupGeometry(const char* filepath, MaterialTable& materialTable);
 GLuint setupBackgroundQuad(GLuint& quadVAO, GLuint& quadVBO, const char* texturePath, const char* type);
 int loadTexture(const std::string& path);
-Material loadMTL(const std::string& path);
 vector<glm::vec3> generateControlPointsSet(int nPoints);
 vector<glm::vec3> generateControlPointsSet();
 std::vector<glm::vec3> generateUnisinosPointsSet();
 GLuint generateControlPointsBuffer(vector<glm::vec3> controlPoints);
 std::vector<glm::vec3> generateCircleControlPointsSet(int nPoints, float radius = 0.5f, string orientation = "");
-bool checkSphereAABB(glm::vec3 sphereCenter, float radius, glm::vec3 boxMin, glm::vec3 boxMax);
+void bindFrameUniformBlock(const Shader& shader);
+void setPointLightCount(int count);
+ShadowType parseShadowType(const string& name);
+const char* getShadowTypeName(ShadowType type);
+CaptureFormat parseCaptureFormat(const string& name);
+void drawShadowCasters(ShadowMap& shadowMap, ShadowMap::Layer layer, RenderResources& resources,
+                       const FrameSnapshot& snapshot, float alpha, GLuint framebuffer, int width, int height);
+void updatePointLights();
+void readPointLightPositions();
+HoopNodes createHoopNodes(const glm::vec3& position, float scaleFactor);
+HoopColliders getHoopColliders(const HoopNodes& nodes);
+Entity createMeshEntity(const Geometry& geometry, const glm::vec3& position, float scaleFactor);
+bool isBallInFlight();
+glm::vec3 getBallHandPosition();
+void stepBall(float dt, const HoopColliders& hoop);
+void stepSimulation(float dt, Hermite& hermite, const HoopColliders& hoop);
+void runEntityBenchmark();
+void runParticleBenchmark(RenderResources& resources);
+void applyTimingMode();
+glm::vec3 getInterpolatedCurvePoint(Curve& curve, float position);
+DrawItem makeDrawItem(const MeshRef& mesh, MaterialIndex materialIndex);
+glm::quat getNumberRotation(glm::vec3 numberPosition);
+void buildFrameSnapshot(FrameSnapshot& snapshot, const HoopColliders& hoop);
+void renderFrame(RenderResources& resources, const FrameSnapshot& snapshot, float alpha);
+void drawDepthPrePass(RenderResources& resources, const FrameSnapshot& snapshot, float alpha,
+                      const glm::mat4& modelFloor);
+void drawObject(CommandBuffer& commands, GLint modelLoc, GLint normalMatrixLoc, GLint materialIndexLoc,
+                const DrawItem& item, float alpha);
+void submitCommands(RenderResources& resources);
+void drawOverdraw(RenderResources& resources, const FrameSnapshot& snapshot, int width, int height);
+void updateResolutionGovernor(RenderResources& resources, const FrameSnapshot& snapshot);
+void renderThreadMain(RenderResources* resources);
+bool parseCommandLine(int argc, char** argv);
+void setRenderContextCurrent(const RenderResources& resources, bool current);
+void saveFramePPM(const string& path, const std::vector<unsigned char>& pixels, int width, int height);
+void reportVertexStageBenchmark(VertexStageBenchmark& benchmark, GPUProfiler& profiler, bool perVertexNormalMatrix);
 bool changeToGameplayScene = false;
 json jsonReader(string jsonpath);
 
@@ -165,6 +410,27 @@ json jsonReader(string jsonpath);
 const GLuint WIDTH = 1024;
 const GLuint HEIGHT = 768;
 
+// ------------------------
+// Per-frame streaming
+// ------------------------
+
+// Curves and frame uniforms; the clustered light lists are added on top of this.
+const GLsizeiptr FRAME_RING_SIZE = 1 << 20;
+const int FRAMES_IN_FLIGHT = 3;
+const GLuint FRAME_UNIFORMS_BINDING = 0;
+
+// Frames averaged by the console benchmarks after a setting changes.
+const int BENCHMARK_FRAMES = 120;
+
+// Cap height of the score in the top right corner, in pixels.
+const float SCORE_READOUT_HEIGHT = 20.0f;
+
+// Points per segment of the throw preview at full quality.
+const int BEZIER_POINTS_PER_SEGMENT = 30;
+
+// Shaded fragment counts shown as separate colors by the overdraw view; higher counts share the last one.
+const int OVERDRAW_LEVELS = 8;
+
 // ------------------------
 // Scene states
 // ------------------------
@@ -172,10 +438,51 @@ const GLuint HEIGHT = 768;
 bool rotateX = false;
 bool rotateY = false;
 bool rotateZ = false;
-bool throwBall = false;
+bool perVertexNormalMatrix = false;
+bool depthPrePass = false;
+bool showOverdraw = false;
+bool showHUD = false;
+bool dynamicResolution = false;
+ResolutionGovernorSettings resolutionGovernorSettings;
 int indexObject = 0;
-std::vector<Geometry> sceneObjects;
-std::vector<Geometry> numberObjects;
+
+// ------------------------
+// Entities
+// ------------------------
+
+World world;
+// Balls on display in the selection scene; the chosen one becomes ballEntity.
+std::vector<Entity> selectionBalls;
+Entity ballEntity = INVALID_ENTITY;
+Entity hoopEntity = INVALID_ENTITY;
+Entity numberEntity = INVALID_ENTITY;
+
+const size_t ENTITY_BENCHMARK_COUNT = 1000000;
+const int ENTITY_BENCHMARK_UPDATES = 20;
+
+// ------------------------
+// Particles
+// ------------------------
+
+// Every basket bursts particles out of the hoop; "auto" picks the fastest backend the context has.
+string particleBackendName = "auto";
+int particleCapacity = 65536;
+int particlesPerBasket = 20000;
+ParticleSettings particleSettings;
+// Bumped for every burst, and to ask the render thread for the scaling benchmark.
+unsigned int celebrationVersion = 0;
+unsigned int particleBenchmarkVersion = 0;
+
+// Burst sizes of the scaling benchmark, each simulated for PARTICLE_BENCHMARK_STEPS steps of 1/60 s.
+const int PARTICLE_BENCHMARK_COUNTS[] = {1024, 4096, 16384, 65536, 262144};
+const int PARTICLE_BENCHMARK_STEPS = 120;
+
+// ------------------------
+// Impostors
+// ------------------------
+
+// Meshes farther than impostorSettings.distance fade into camera-facing quads.
+ImpostorSettings impostorSettings;
 
 // ------------------------
 // Time transformations
@@ -183,14 +490,121 @@ std::vector<Geometry> numberObjects;
 
 glm::vec3 position = glm::vec3(0.0f, 0.0f, 0.0f);
 float deltaTime = 0.0f;
-float lastFrame = 0.0f;
 float speed = 0.1f;
 
+// ------------------------
+// Simulation timing
+// ------------------------
+
+FixedTimestep simulationClock(1.0 / 60.0);
+double simulationTime = 0.0;
+double simulationRate = 60.0;
+double renderRateLimit = 0.0;
+double batterySimulationRate = 30.0;
+double batteryRenderRateLimit = 30.0;
+bool vsync = true;
+bool batteryMode = false;
+
+// ------------------------
+// Threads
+// ------------------------
+
+// Snapshots flow from the simulation (main) thread to the render thread, which
+// owns the GL context while the frame loop runs.
+TripleBuffer<FrameSnapshot> frameSnapshots;
+std::atomic<bool> renderThreadRunning(false);
+int framebufferWidth = WIDTH;
+int framebufferHeight = HEIGHT;
+
+// ------------------------
+// Headless
+// ------------------------
+
+// --headless renders the frame loop into an offscreen framebuffer, without a window
+// or input, and exits after headlessFrameCount frames.
+bool headless = false;
+int headlessFrameCount = 300;
+string headlessOutputPath;
+std::atomic<int> renderedFrames(0);
+
+// ------------------------
+// Frame capture
+// ------------------------
+
+CaptureSettings captureSettings;
+bool capturing = false;
+
+// ------------------------
+// Profiling
+// ------------------------
+
+// Bumped to ask the render thread for a pass timing table; written as CSV on exit when set.
+unsigned int profileReportVersion = 0;
+string profileOutputPath;
+// CPU scopes of every thread, written as a Chrome trace on exit when set.
+string traceOutputPath;
+
+// ------------------------
+// Command streams
+// ------------------------
+
+// --null-backend counts and validates the recorded passes instead of drawing them;
+// --dump-commands saves the command stream of the last frame on exit.
+bool nullCommandBackend = false;
+string commandDumpPath;
+
+// ------------------------
+// Input recording
+// ------------------------
+
+// --record saves the frame times and input of the session on exit; --replay feeds
+// a saved session back in place of live input, and --benchmark then prints the
+// frame time statistics of the replay and exits when it ends.
+InputRecording inputRecording;
+string inputRecordPath;
+string inputReplayPath;
+bool benchmarkReplay = false;
+bool replayingInput = false;
+size_t replayFrame = 0;
+// Held keys as of the replayed events, in place of glfwGetKey.
+bool replayKeysDown[GLFW_KEY_LAST + 1] = {};
+
+// ------------------------
+// Clustered lights
+// ------------------------
+
+const int MAX_POINT_LIGHTS = 1024;
+const int MAX_LIGHT_INDICES = 1 << 18;
+const int POINT_LIGHT_COUNT_STEPS[] = {0, 16, 128, 1000};
+std::vector<PointLight> pointLights;
+std::vector<glm::vec3> previousPointLightPositions;
+std::vector<LightOrbit> lightOrbits;
+float pointLightRadius = 4.0f;
+float pointLightIntensity = 2.0f;
+
+// ------------------------
+// Scene graph
+// ------------------------
+
+// Hoop scale the collider offsets were measured at.
+const float HOOP_REFERENCE_SCALE = 0.05f;
+SceneGraph sceneGraph;
+// Orbiting lights are children of this node, centered over the court.
+NodeId lightRigNode = INVALID_NODE;
+std::vector<NodeId> pointLightNodes;
+
+// ------------------------
+// Shadows
+// ------------------------
+
+// Bumped whenever the set of static shadow casters changes, invalidating the cached layer.
+ShadowSettings shadowSettings;
+unsigned int staticShadowVersion = 0;
+
 // ------------------------
 // Light and materials
 // ------------------------
 
-std::string mtlFilePath = "";
 glm::vec3 ambientColor(0.0f);
 glm::vec3 diffuseColor(0.0f);
 glm::vec3 specularColor(0.0f);
@@ -222,8 +636,7 @@ float lastY = HEIGHT / 2.0f;
 int bezierNbCurvePoints = 0;
 int bezierPointOnCurveIterReference = 0;
 int hermiteNbCurvePoints = 0;
-int hermitePointOnCurveIterReference = 0;
-vector<glm::vec3> pointsOnCurveVector;
+float hermitePointsPerSecond = 60.0f;
 
 // ------------------------
 // Enum
@@ -241,8 +654,8 @@ SceneState currentScene = SELECTION_SCENE;
 // Ball Physics
 // ------------------------
 
-glm::vec3 ballPosition;
-glm::vec3 ballVelocity;
+const glm::vec3 GRAVITY = glm::vec3(0.0f, -4.81f, 0.0f);
+BallThrow pendingThrow = BallThrow::None;
 bool initialized = false;
 glm::vec3 forward = glm::normalize(camera.Front);
 float launchSpeed = 20.0f;
@@ -264,13 +677,8 @@ float softenDuration = 0.5f;
 // Bezier Logic
 // ------------------------
 
-static bool justLaunched = true;
-static float bezierT = 0.0f;
 static float bezierSpeed = 0.5f;
 static std::vector<glm::vec3> bezierCurvePoints;
-static bool bezierPhase = false;
-static glm::vec3 finalBezierDirection;
-bool throwBallBezier = false;
 
 // ------------------------
 // Flash Effect
@@ -280,139 +688,320 @@ bool flashScreen = false;
 float flashTimer = 0.0f;
 const float flashDuration = 0.7f;
 
+// ------------------------
+// Scene configuration
+// ------------------------
+
+glm::vec3 objectRotationAxis(1.0f, 0.0f, 0.0f);
+// Height of the score's digits, and their color.
+float scoreTextHeight = 42.0f;
+glm::vec4 scoreColor(0.8f, 0.0f, 0.0f, 1.0f);
+bool showParametricCurves = false;
+
 // ------------------------
 // JSON Configuration
 // ------------------------
 
 std::string jsonpath = "../finalProject/basketball_config.json";
 
-int main()
+int main(int argc, char** argv)
 {
-    glfwInit();
+    if (!parseCommandLine(argc, argv))
+    {
+        return 1;
+    }
+
+    // The null platform needs no display; GLFW is then only used for its timer.
+    if (headless)
+    {
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    }
+    PROFILE_THREAD_NAME("main");
+    {
+        PROFILE_SCOPE("glfwInit");
+        glfwInit();
+    }
 
     json jsonData = jsonReader(jsonpath);
 
-    GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, jsonData["windowName"].get<string>().c_str(), nullptr,
-                                          nullptr);
-    glfwMakeContextCurrent(window);
+    GLFWwindow* window = nullptr;
+    std::unique_ptr<HeadlessContext> headlessContext;
+    GLADloadproc loadProc = (GLADloadproc)glfwGetProcAddress;
+    if (headless)
+    {
+        headlessContext = std::make_unique<HeadlessContext>();
+        if (!headlessContext->create(WIDTH, HEIGHT))
+        {
+            glfwTerminate();
+            return 1;
+        }
+        headlessContext->makeCurrent();
+        loadProc = HeadlessContext::getProcAddress;
+    }
+    else
+    {
+        window = glfwCreateWindow(WIDTH, HEIGHT, jsonData["windowName"].get<string>().c_str(), nullptr, nullptr);
+        glfwMakeContextCurrent(window);
 
-    glfwSetKeyCallback(window, keyCallback);
-    glfwSetCursorPosCallback(window, mouseCallback);
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-    glfwSetMouseButtonCallback(window, mouseButtonCallback);
+        glfwSetKeyCallback(window, liveKeyCallback);
+        glfwSetCursorPosCallback(window, liveCursorPosCallback);
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+        glfwSetMouseButtonCallback(window, liveMouseButtonCallback);
+
+        glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+    }
 
-    glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+    simulationRate = jsonData.value("simulationRate", simulationRate);
+    renderRateLimit = jsonData.value("renderRateLimit", renderRateLimit);
+    batterySimulationRate = jsonData.value("batterySimulationRate", batterySimulationRate);
+    batteryRenderRateLimit = jsonData.value("batteryRenderRateLimit", batteryRenderRateLimit);
+    batteryMode = jsonData.value("batteryMode", batteryMode);
+    vsync = jsonData.value("vsync", vsync);
+    simulationClock.setMaxSubsteps(jsonData.value("maxSimulationSubsteps", 5));
+    applyTimingMode();
 
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    if (!gladLoadGLLoader(loadProc))
     {
         std::cout << "Failed to initialize GLAD" << std::endl;
     }
+    loadGLExtensions(loadProc);
 
     const GLubyte* renderer = glGetString(GL_RENDERER);
     const GLubyte* version = glGetString(GL_VERSION);
     cout << "Renderer: " << renderer << endl;
     cout << "OpenGL version supported " << version << endl;
 
-    int width, height;
-    glfwGetFramebufferSize(window, &width, &height);
-    glViewport(0, 0, width, height);
+    if (headless)
+    {
+        headlessContext->createFramebuffer();
+    }
+    else
+    {
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    }
+    glViewport(0, 0, framebufferWidth, framebufferHeight);
+    // The render state every pass starts from and leaves behind, see CommandBuffer.
+    glEnable(GL_DEPTH_TEST);
+
+    objectRotationAxis = glm::vec3(jsonData["objectRotation"][0], jsonData["objectRotation"][1],
+                                   jsonData["objectRotation"][2]);
+    scoreTextHeight = jsonData.value("scoreTextHeight", scoreTextHeight);
+    if (jsonData.contains("scoreColor"))
+    {
+        scoreColor = glm::vec4(jsonData["scoreColor"][0], jsonData["scoreColor"][1], jsonData["scoreColor"][2], 1.0f);
+    }
+    showParametricCurves = jsonData["showParametricCurves"].get<bool>();
+    particleBackendName = jsonData.value("particleBackend", particleBackendName);
+    particleCapacity = std::max(jsonData.value("particleCapacity", particleCapacity), 1);
+    particlesPerBasket = jsonData.value("particlesPerBasket", particlesPerBasket);
+    particleSettings.size = jsonData.value("particleSize", particleSettings.size);
+    impostorSettings.distance = jsonData.value("impostorDistance", impostorSettings.distance);
+    impostorSettings.fadeRange = jsonData.value("impostorFadeRange", impostorSettings.fadeRange);
+    impostorSettings.views = jsonData.value("impostorViews", impostorSettings.views);
+    impostorSettings.viewSize = jsonData.value("impostorViewSize", impostorSettings.viewSize);
+    depthPrePass = jsonData.value("depthPrePass", depthPrePass);
+    showHUD = jsonData.value("showHUD", showHUD);
+    dynamicResolution = jsonData.value("dynamicResolution", dynamicResolution);
+    resolutionGovernorSettings.targetMilliseconds =
+        jsonData.value("targetFrameTime", resolutionGovernorSettings.targetMilliseconds);
+    resolutionGovernorSettings.minScale = jsonData.value("minResolutionScale", resolutionGovernorSettings.minScale);
+    resolutionGovernorSettings.maxScale = jsonData.value("maxResolutionScale", resolutionGovernorSettings.maxScale);
+
+    captureSettings.stride = jsonData.value("captureStride", captureSettings.stride);
+    captureSettings.format = parseCaptureFormat(jsonData.value("captureFormat", string("ppm")));
+    captureSettings.pathPrefix = jsonData.value("capturePath", captureSettings.pathPrefix);
+    captureSettings.command = jsonData.value("captureCommand", captureSettings.command);
+    if (profileOutputPath.empty())
+    {
+        profileOutputPath = jsonData.value("profileOutput", profileOutputPath);
+    }
+    if (traceOutputPath.empty())
+    {
+        traceOutputPath = jsonData.value("traceOutput", traceOutputPath);
+    }
+
+    pointLightRadius = jsonData.value("pointLightRadius", pointLightRadius);
+    pointLightIntensity = jsonData.value("pointLightIntensity", pointLightIntensity);
+    lightRigNode = sceneGraph.createNode();
+    sceneGraph.setLocalPosition(lightRigNode, glm::vec3(0.0f, 0.0f, -4.0f));
+    setPointLightCount(jsonData.value("pointLightCount", 0));
 
+    shadowSettings.type = parseShadowType(jsonData.value("shadowType", string("directional")));
+    shadowSettings.lightPosition = glm::vec3(jsonData["lightPos"][0], jsonData["lightPos"][1], jsonData["lightPos"][2]);
+    if (jsonData.contains("shadowLightDirection"))
+    {
+        shadowSettings.lightDirection = glm::vec3(jsonData["shadowLightDirection"][0],
+                                                  jsonData["shadowLightDirection"][1],
+                                                  jsonData["shadowLightDirection"][2]);
+    }
+    if (jsonData.contains("shadowCenter"))
+    {
+        shadowSettings.center = glm::vec3(jsonData["shadowCenter"][0], jsonData["shadowCenter"][1],
+                                          jsonData["shadowCenter"][2]);
+    }
+    shadowSettings.extent = jsonData.value("shadowExtent", shadowSettings.extent);
+    shadowSettings.farPlane = jsonData.value("shadowFarPlane", shadowSettings.farPlane);
+    shadowSettings.resolution = jsonData.value("shadowResolution", shadowSettings.resolution);
+    shadowSettings.strength = jsonData.value("shadowStrength", shadowSettings.strength);
+
+    // Shader storage buffers are core in GL 4.3, which the #version 460 shaders already require.
+    std::unique_ptr<LightClusters> lightClusters;
+    GLsizeiptr frameRingSize = FRAME_RING_SIZE;
+    if (glCapabilities.shaderStorageBuffers)
+    {
+        lightClusters = std::make_unique<LightClusters>(MAX_POINT_LIGHTS, MAX_LIGHT_INDICES);
+        frameRingSize += lightClusters->getMaxUploadSize();
+    }
+    else
+    {
+        std::cerr << "Shader storage buffers unavailable, clustered lights disabled" << std::endl;
+    }
 
+    // --- Shaders ---
+    // Every program is submitted before anything waits for one, so with parallel
+    // compilation the driver builds them all at once while the models and textures load.
+    if (glCapabilities.parallelShaderCompile)
+    {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    }
+    cout << "Shader compilation: " << (glCapabilities.parallelShaderCompile ? "parallel" : "serial") << endl;
+
+    Shader particleShader(jsonData["vertexShaderParticles"].get<string>().c_str(),
+                          jsonData["fragmentShaderParticles"].get<string>().c_str(),
+                          jsonData["geometryShaderParticles"].get<string>().c_str());
+    // The lit programs share the lights, materials and shadow lookups of one source file,
+    // so the fading mesh variant and the impostor are lit exactly like the object shader.
+    string fragmentShaderLighting = jsonData["fragmentShaderLighting"].get<string>();
     Shader shader(jsonData["vertexShaderObject"].get<string>().c_str(),
-                  jsonData["fragmentShaderObject"].get<string>().c_str());
-
-    Geometry basketBall = setupGeometry(jsonData["basketBall"].get<string>().c_str());
-    basketBall.position = glm::vec3(jsonData["basketBallPosition"][0], jsonData["basketBallPosition"][1],
-                                    jsonData["basketBallPosition"][2]);
-    basketBall.scaleFactor = jsonData["basketBallScaleFactor"];
+                  jsonData["fragmentShaderObject"].get<string>().c_str(), nullptr, nullptr,
+                  fragmentShaderLighting.c_str());
+    Shader fadingShader(jsonData["vertexShaderObject"].get<string>().c_str(),
+                        jsonData["fragmentShaderObject"].get<string>().c_str(), nullptr, "#define IMPOSTOR_FADE\n",
+                        fragmentShaderLighting.c_str());
+    Shader impostorShader(jsonData["vertexShaderImpostor"].get<string>().c_str(),
+                          jsonData["fragmentShaderImpostor"].get<string>().c_str(), nullptr, nullptr,
+                          fragmentShaderLighting.c_str());
+    Shader impostorBakeShader(jsonData["vertexShaderImpostorBake"].get<string>().c_str(),
+                              jsonData["fragmentShaderImpostorBake"].get<string>().c_str());
+    Shader textShader(jsonData["vertexShaderText"].get<string>().c_str(),
+                      jsonData["fragmentShaderText"].get<string>().c_str());
+    Shader backgroundShader(jsonData["vertexShaderBackground"].get<string>().c_str(),
+                            jsonData["fragmentShaderBackground"].get<string>().c_str(), nullptr, nullptr,
+                            fragmentShaderLighting.c_str());
+    Shader backgroundStarsShader(jsonData["vertexShaderBackgroundStars"].get<string>().c_str(),
+                                 jsonData["fragmentShaderBackgroundStars"].get<string>().c_str());
+    string fragmentShaderDepth = jsonData["fragmentShaderDepth"].get<string>();
+    Shader objectDepthShader(jsonData["vertexShaderObject"].get<string>().c_str(), fragmentShaderDepth.c_str());
+    Shader floorDepthShader(jsonData["vertexShaderBackground"].get<string>().c_str(), fragmentShaderDepth.c_str());
+    Shader overdrawShader(jsonData["vertexShaderBackgroundStars"].get<string>().c_str(),
+                          jsonData["fragmentShaderOverdraw"].get<string>().c_str());
+    Shader shadowShader(jsonData["vertexShaderShadow"].get<string>().c_str(),
+                        jsonData["fragmentShaderShadow"].get<string>().c_str());
+    Shader curvesShader(jsonData["vertexShaderCurves"].get<string>().c_str(),
+                        jsonData["fragmentShaderCurves"].get<string>().c_str());
+    Shader hudShader(jsonData["vertexShaderHUD"].get<string>().c_str(),
+                     jsonData["fragmentShaderHUD"].get<string>().c_str());
 
+    // --- Models ---
+    // Every model's material goes into one table, uploaded once they are all loaded.
+    auto materialTable = std::make_unique<MaterialTable>();
+    Geometry basketBall = setupGeometry(jsonData["basketBall"].get<string>().c_str(), *materialTable);
+    glm::vec3 basketBallPosition = glm::vec3(jsonData["basketBallPosition"][0], jsonData["basketBallPosition"][1],
+                                             jsonData["basketBallPosition"][2]);
 
-    basketBall.name = "basketBall";
+    Geometry orangeBall = setupGeometry(jsonData["orangeBall"].get<string>().c_str(), *materialTable);
+    glm::vec3 orangeBallPosition = glm::vec3(jsonData["orangeBallPosition"][0], jsonData["orangeBallPosition"][1],
+                                             jsonData["orangeBallPosition"][2]);
 
-    Geometry orangeBall = setupGeometry(jsonData["orangeBall"].get<string>().c_str());
-    orangeBall.position = glm::vec3(jsonData["orangeBallPosition"][0], jsonData["orangeBallPosition"][1],
-                                    jsonData["orangeBallPosition"][2]);
-    orangeBall.scaleFactor = jsonData["orangeBallScaleFactor"];
-    orangeBall.name = "orangeBall";
+    Geometry pumpkinBall = setupGeometry(jsonData["pumpkinBall"].get<string>().c_str(), *materialTable);
+    glm::vec3 pumpkinBallPosition = glm::vec3(jsonData["pumpkinBallPosition"][0], jsonData["pumpkinBallPosition"][1],
+                                              jsonData["pumpkinBallPosition"][2]);
 
-    Geometry pumpkinBall = setupGeometry(jsonData["pumpkinBall"].get<string>().c_str());
-    pumpkinBall.position = glm::vec3(jsonData["pumpkinBallPosition"][0], jsonData["pumpkinBallPosition"][1],
-                                     jsonData["pumpkinBallPosition"][2]);
-    pumpkinBall.scaleFactor = jsonData["pumpkinBallScaleFactor"];
-    pumpkinBall.name = "pumpkinBall";
+    Geometry basketHoop = setupGeometry(jsonData["basketHoop"].get<string>().c_str(), *materialTable);
+    glm::vec3 basketHoopPosition = glm::vec3(jsonData["basketHoopPosition"][0], jsonData["basketHoopPosition"][1],
+                                             jsonData["basketHoopPosition"][2]);
 
-    Geometry basketHoop = setupGeometry(jsonData["basketHoop"].get<string>().c_str());
-    basketHoop.position = glm::vec3(jsonData["basketHoopPosition"][0], jsonData["basketHoopPosition"][1],
-                                    jsonData["basketHoopPosition"][2]);
-    basketHoop.scaleFactor = jsonData["basketHoopScaleFactor"];
+    materialTable->upload();
+    cout << "Material table: " << materialTable->getCount() << " materials" << endl;
 
-    glm::vec3 hoopBase = basketHoop.position;
+    HoopNodes hoopNodes = createHoopNodes(basketHoopPosition, jsonData["basketHoopScaleFactor"]);
+    sceneGraph.updateWorldTransforms();
+    HoopColliders hoopColliders = getHoopColliders(hoopNodes);
 
-    // --- Backboard ---ll
-    glm::vec3 backboardMin = hoopBase + glm::vec3(-4.2f, 13.0f, 4.0f);
-    glm::vec3 backboardMax = hoopBase + glm::vec3(3.0f, 18.2f, 4.0);
+    selectionBalls = {
+        createMeshEntity(basketBall, basketBallPosition, jsonData["basketBallScaleFactor"]),
+        createMeshEntity(orangeBall, orangeBallPosition, jsonData["orangeBallScaleFactor"]),
+        createMeshEntity(pumpkinBall, pumpkinBallPosition, jsonData["pumpkinBallScaleFactor"])
+    };
 
-    // --- Rim ---
-    glm::vec3 rimMin = hoopBase + glm::vec3(-0.2f, 13.5f, 7.0f);
-    glm::vec3 rimMax = hoopBase + glm::vec3(0.2f, 13.5f, 7.0f);
-    glm::vec3 rimCenter = hoopBase + glm::vec3(0.0f, 13.5f, 7.0f);
-    glm::vec3 scoreZoneMin = hoopBase + glm::vec3(-1.0f, 15.0f, 3.0f);
-    glm::vec3 scoreZoneMax = hoopBase + glm::vec3(-0.9f, 15.0f, 3.2f);
-    glm::vec3 hoopCenter = (scoreZoneMin + scoreZoneMax) * 0.5f;
+    GLuint backgroundVAO, backgroundVBO;
+    GLuint backgroundTexture =
+        setupBackgroundQuad(backgroundVAO, backgroundVBO, jsonData["floorTexture"].get<string>().c_str(), "floor");
+    GLuint backgroundStarsVAO, backgroundStarsVBO;
+    GLuint backgroundStarsTexture = setupBackgroundQuad(backgroundStarsVAO, backgroundStarsVBO,
+                                                        jsonData["starsTexture"].get<string>().c_str(),
+                                                        "");
 
-    // --- Pole ---
-    glm::vec3 poleMin = hoopBase + glm::vec3(-1.0f, 0.0f, 3.0f);
-    glm::vec3 poleMax = hoopBase + glm::vec3(1.0f, 13.0f, 3.1);
+    // The impostor programs are only needed once a mesh is far away: the render
+    // thread finishes them, and meanwhile draws every mesh in full.
+    for (Shader* firstFrameShader : {&particleShader, &shader, &textShader, &backgroundShader, &backgroundStarsShader,
+                                     &objectDepthShader, &floorDepthShader, &overdrawShader, &shadowShader,
+                                     &curvesShader, &hudShader})
+    {
+        firstFrameShader->finish();
+    }
 
-    sceneObjects = {basketBall, orangeBall, pumpkinBall};
+    // --- Particles ---
+    // The CPU backend streams every particle through the ring, so it is sized first.
+    bindFrameUniformBlock(particleShader);
+    auto particlePrograms = std::make_unique<ParticlePrograms>(
+        &particleShader, jsonData["computeShaderParticles"].get<string>(),
+        jsonData["vertexShaderParticlesFeedback"].get<string>(), jsonData["geometryShaderParticlesFeedback"].get<string>());
+    ParticleBackend particleBackend = particlePrograms->choose(particleBackendName);
+    if (nullCommandBackend)
+    {
+        // The GPU backends simulate with GL calls of their own, outside the command stream.
+        particleBackend = ParticleBackend::CPU;
+    }
+    frameRingSize += ParticleSystem::getMaxUploadSize(particleBackend, particleCapacity);
+    cout << "Particles: " << getParticleBackendName(particleBackend) << " backend, " << particleCapacity << " at most"
+        << endl;
+
+    // Nothing reads the ring when the null backend replaces the GPU.
+    auto frameRing = std::make_unique<RingBuffer>(frameRingSize, FRAMES_IN_FLIGHT, nullCommandBackend);
+    cout << "Frame ring buffer: "
+        << (nullCommandBackend ? "host only" : frameRing->isPersistent() ? "persistent mapped" : "buffer sub data")
+        << endl;
+    cout << "Vertex setup: " << (glCapabilities.directStateAccess ? "direct state access" : "bind to edit") << endl;
+    auto particleSystem = std::make_unique<ParticleSystem>(particleBackend, particleCapacity, particleSettings,
+                                                           particlePrograms.get(), frameRing.get());
+
+    // --- Scene objects ---
     glUseProgram(shader.ID);
+    bindFrameUniformBlock(shader);
+    LightClusters::bindUniformBlock(shader.ID);
+    ShadowMap::bindProgram(shader.ID);
 
-    glm::mat4 model = glm::mat4(1);
     GLint modelLoc = glGetUniformLocation(shader.ID, "model");
+    GLint normalMatrixLoc = glGetUniformLocation(shader.ID, "normalMatrix");
+    GLint perVertexNormalMatrixLoc = glGetUniformLocation(shader.ID, "perVertexNormalMatrix");
+    GLint materialIndexLoc = glGetUniformLocation(shader.ID, "materialIndex");
+    GLint cameraPosLoc = glGetUniformLocation(shader.ID, "cameraPos");
 
     shader.setVec3("lightPos", jsonData["lightPos"][0], jsonData["lightPos"][1], jsonData["lightPos"][2]);
     shader.setVec3("lightColor", jsonData["lightColor"][0], jsonData["lightColor"][1], jsonData["lightColor"][2]);
 
-    glm::mat4 view = camera.GetViewMatrix();
-    glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)width / (float)height, 0.1f, 100.0f);
-    shader.setMat4("view", glm::value_ptr(view));
-    shader.setMat4("projection", glm::value_ptr(projection));
+    // --- Impostors ---
+    // Created by the render thread once their programs are ready, see below.
+    std::unique_ptr<ImpostorRenderer> impostorRenderer;
 
-    Shader shaderNumber(jsonData["vertexShaderNumber"].get<string>().c_str(),
-                        jsonData["fragmentShaderNumber"].get<string>().c_str());
-
-    for (int i = 0; i <= 3; ++i)
-    {
-        string numberObjectPath = jsonData["numberObject"].get<string>() + std::to_string(i) + "/number_" +
-            std::to_string(i) +
-            ".obj";
-        Geometry number = setupGeometry(numberObjectPath.c_str());
-        number.position = glm::vec3(jsonData["numberPosition"][0], jsonData["numberPosition"][1],
-                                    jsonData["numberPosition"][2]);
-        number.scaleFactor = jsonData["numberScaleFactor"];
-
-        numberObjects.push_back(number);
-    }
-
-    glUseProgram(shaderNumber.ID);
-
-    model = glm::mat4(1);
-    modelLoc = glGetUniformLocation(shaderNumber.ID, "model");
-    shaderNumber.setVec3("lightPos", jsonData["lightPos"][0], jsonData["lightPos"][1], jsonData["lightPos"][2]);
-    shaderNumber.setVec3("lightColor", jsonData["lightColor"][0], jsonData["lightColor"][1], jsonData["lightColor"][2]);
-
-    shaderNumber.setMat4("view", glm::value_ptr(view));
-    shaderNumber.setMat4("projection", glm::value_ptr(projection));
-
-    shaderNumber.setMat4("model", glm::value_ptr(model));
+    // --- Score text ---
+    bindFrameUniformBlock(textShader);
+    auto textRenderer = std::make_unique<TextRenderer>(&textShader, frameRing.get());
 
     // --- Background Floor ---
-    GLuint backgroundVAO, backgroundVBO;
-    GLuint backgroundTexture =
-        setupBackgroundQuad(backgroundVAO, backgroundVBO, jsonData["floorTexture"].get<string>().c_str(), "floor");
-    Shader backgroundShader(jsonData["vertexShaderBackground"].get<string>().c_str(),
-                            jsonData["fragmentShaderBackground"].get<string>().c_str());
-    glUseProgram(backgroundShader.ID);
+    ShadowMap::bindProgram(backgroundShader.ID);
+    bindFrameUniformBlock(backgroundShader);
     glUniform1i(glGetUniformLocation(backgroundShader.ID, "backgroundTexture"), 0);
 
     glm::mat4 modelFloor = glm::mat4(1);
@@ -421,465 +1010,377 @@ int main()
     glUniformMatrix4fv(modelLocFloor, 1, 0, glm::value_ptr(modelFloor));
 
     // --- Background Stars ---
-    GLuint backgroundStarsVAO, backgroundStarsVBO;
-    GLuint backgroundStarsTexture = setupBackgroundQuad(backgroundStarsVAO, backgroundStarsVBO,
-                                                        jsonData["starsTexture"].get<string>().c_str(),
-                                                        "");
-    Shader backgroundStarsShader(jsonData["vertexShaderBackgroundStars"].get<string>().c_str(),
-                                 jsonData["fragmentShaderBackgroundStars"].get<string>().c_str());
-
     glUseProgram(backgroundStarsShader.ID);
     glUniform1i(glGetUniformLocation(backgroundStarsShader.ID, "backgroundStarsTexture"), 0);
 
+    // --- Depth pre-pass ---
+    bindFrameUniformBlock(objectDepthShader);
+    bindFrameUniformBlock(floorDepthShader);
+
+    DepthPrePass depthPrePassShaders = {
+        &objectDepthShader, &floorDepthShader,
+        glGetUniformLocation(objectDepthShader.ID, "model"),
+        glGetUniformLocation(floorDepthShader.ID, "modelFloor")
+    };
+
+    // --- Shadows ---
+    auto shadowMap = std::make_unique<ShadowMap>(&shadowShader);
+
     // --- Shader Curves  ---
-    Shader curvesShader(jsonData["vertexShaderCurves"].get<string>().c_str(),
-                        jsonData["fragmentShaderCurves"].get<string>().c_str());
     glUseProgram(curvesShader.ID);
-    curvesShader.setMat4("view", glm::value_ptr(view));
-    curvesShader.setMat4("projection", glm::value_ptr(projection));
+    bindFrameUniformBlock(curvesShader);
     curvesShader.setVec4("finalColor", 1, 0, 0, 1);
 
     // --- Bezier ---
     Bezier bezier;
     bezier.setShader(&curvesShader);
-    bezier.generateQuadraticCurve(30);
+    bezier.setStreamBuffer(frameRing.get());
+    bezier.generateQuadraticCurve(BEZIER_POINTS_PER_SEGMENT);
     bezierNbCurvePoints = bezier.getNbCurvePoints();
 
     // --- Hermite ---
     vector<glm::vec3> hermiteControlPoints = generateCircleControlPointsSet(100, 60.0f, "horizontal");
-    GLuint VAOhermiteControlPoints = generateControlPointsBuffer(hermiteControlPoints);
     Hermite hermite;
     hermite.setControlPoints(hermiteControlPoints);
     hermite.setShader(&curvesShader);
     hermite.generateCurve(60);
     hermiteNbCurvePoints = hermite.getNbCurvePoints();
 
-    while (!glfwWindowShouldClose(window))
+    // --- Frame capture ---
+    auto frameCapture = std::make_unique<FrameCapture>(captureSettings);
+
+    // --- GPU profiler ---
+    // One frame more than the ring buffer keeps in flight, so results are ready when read.
+    // The null backend submits nothing for timer queries to measure.
+    auto gpuProfiler = std::make_unique<GPUProfiler>(FRAMES_IN_FLIGHT + 1, 240, !nullCommandBackend);
+
+    // --- Performance HUD ---
+    auto perfHUD = std::make_unique<PerfHUD>(&hudShader, frameRing.get(), !nullCommandBackend);
+
+    // --- Dynamic resolution ---
+    auto resolutionGovernor = std::make_unique<ResolutionGovernor>(resolutionGovernorSettings);
+    auto sceneTarget = std::make_unique<RenderTarget>();
+    // Same filtering as loadTexture, plus trilinear mipmapping so the LOD bias has levels to pick from.
+    GLuint textureSampler;
+    glGenSamplers(1, &textureSampler);
+    glSamplerParameteri(textureSampler, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glSamplerParameteri(textureSampler, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glSamplerParameteri(textureSampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glSamplerParameteri(textureSampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // --- Hand the context over to the render thread ---
+    RenderResources renderResources;
+    renderResources.window = window;
+    renderResources.headlessContext = headlessContext.get();
+    renderResources.outputFramebuffer = headlessContext ? headlessContext->getFramebuffer() : 0;
+    renderResources.shader = &shader;
+    renderResources.backgroundShader = &backgroundShader;
+    renderResources.backgroundStarsShader = &backgroundStarsShader;
+    renderResources.curvesShader = &curvesShader;
+    renderResources.modelLoc = modelLoc;
+    renderResources.normalMatrixLoc = normalMatrixLoc;
+    renderResources.perVertexNormalMatrixLoc = perVertexNormalMatrixLoc;
+    renderResources.materialIndexLoc = materialIndexLoc;
+    renderResources.cameraPosLoc = cameraPosLoc;
+    renderResources.modelLocFloor = modelLocFloor;
+    renderResources.backgroundVAO = backgroundVAO;
+    renderResources.backgroundTexture = backgroundTexture;
+    renderResources.backgroundStarsVAO = backgroundStarsVAO;
+    renderResources.backgroundStarsTexture = backgroundStarsTexture;
+    renderResources.bezier = &bezier;
+    renderResources.hermite = &hermite;
+    renderResources.frameRing = frameRing.get();
+    renderResources.lightClusters = lightClusters.get();
+    renderResources.shadowMap = shadowMap.get();
+    renderResources.depthPrePass = depthPrePassShaders;
+    renderResources.materialTable = materialTable.get();
+    renderResources.overdrawShader = &overdrawShader;
+    renderResources.overdrawColorLoc = glGetUniformLocation(overdrawShader.ID, "color");
+    renderResources.frameCapture = frameCapture.get();
+    renderResources.gpuProfiler = gpuProfiler.get();
+    renderResources.perfHUD = perfHUD.get();
+    renderResources.textRenderer = textRenderer.get();
+    renderResources.particlePrograms = particlePrograms.get();
+    renderResources.particleSystem = particleSystem.get();
+    renderResources.resolutionGovernor = resolutionGovernor.get();
+    renderResources.sceneTarget = sceneTarget.get();
+    renderResources.textureSampler = textureSampler;
+    GLCommandBackend glCommandBackend;
+    NullCommandBackend nullBackend;
+    renderResources.commandBackend = nullCommandBackend ? (CommandBackend*)&nullBackend : &glCommandBackend;
+    cout << "Command backend: " << (nullCommandBackend ? "null" : "GL") << endl;
+
+    renderResources.pendingPrograms.add({&fadingShader, &impostorShader, &impostorBakeShader}, [&]()
     {
-        // --- Events and buffers ---
-        glfwPollEvents();
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        glLineWidth(10);
-        glPointSize(20);
-
-        view = camera.GetViewMatrix();
-        shader.setMat4("view", glm::value_ptr(view));
+        for (Shader* litShader : {&fadingShader, &impostorShader})
+        {
+            glUseProgram(litShader->ID);
+            bindFrameUniformBlock(*litShader);
+            LightClusters::bindUniformBlock(litShader->ID);
+            ShadowMap::bindProgram(litShader->ID);
+            litShader->setVec3("lightPos", jsonData["lightPos"][0], jsonData["lightPos"][1], jsonData["lightPos"][2]);
+            litShader->setVec3("lightColor", jsonData["lightColor"][0], jsonData["lightColor"][1],
+                               jsonData["lightColor"][2]);
+        }
+        renderResources.fadingObjects = {
+            &fadingShader,
+            glGetUniformLocation(fadingShader.ID, "model"),
+            glGetUniformLocation(fadingShader.ID, "normalMatrix"),
+            glGetUniformLocation(fadingShader.ID, "perVertexNormalMatrix"),
+            glGetUniformLocation(fadingShader.ID, "materialIndex"),
+            glGetUniformLocation(fadingShader.ID, "impostorFade"),
+            glGetUniformLocation(fadingShader.ID, "cameraPos")
+        };
+        impostorRenderer = std::make_unique<ImpostorRenderer>(&impostorBakeShader, &impostorShader, impostorSettings);
+        renderResources.impostorRenderer = impostorRenderer.get();
+        cout << "Impostor programs ready" << endl;
+    });
 
-        if (score >= 3)
+    // --- Input recording ---
+    if (!inputReplayPath.empty())
+    {
+        if (!inputRecording.load(inputReplayPath))
         {
-            score = 0;
-            flashScreen = true;
-            flashTimer = 0.0f;
+            return 1;
+        }
+        if (inputRecording.getSimulationStep() != simulationClock.getStep())
+        {
+            cerr << "Replay was recorded at " << 1.0 / inputRecording.getSimulationStep()
+                << " simulation steps per second, it will not play back exactly" << endl;
         }
+        replayingInput = inputRecording.getFrameCount() > 0;
+        cout << "Replaying " << inputRecording.getFrameCount() << " frames of input from " << inputReplayPath << endl;
+    }
+    else if (!inputRecordPath.empty())
+    {
+        inputRecording.setSimulationStep(simulationClock.getStep());
+    }
 
-        if (flashScreen)
+    double previousTime = glfwGetTime();
+    double startTime = previousTime;
+    FrameSnapshot& initialSnapshot = frameSnapshots.beginWrite();
+    buildFrameSnapshot(initialSnapshot, hoopColliders);
+    initialSnapshot.stateTime = previousTime;
+    initialSnapshot.step = simulationClock.getStep();
+    frameSnapshots.publish();
+
+    setRenderContextCurrent(renderResources, false);
+    renderThreadRunning = true;
+    std::thread renderThread(renderThreadMain, &renderResources);
+
+    bool replayFinished = false;
+    while (!(benchmarkReplay && replayFinished) &&
+        (headless ? renderedFrames < headlessFrameCount : !glfwWindowShouldClose(window)))
+    {
+        double currentTime = glfwGetTime();
+        double frameSeconds = currentTime - previousTime;
+        if (replayingInput)
+        {
+            // The recorded frame times drive the simulation; the clock only paces the replay.
+            frameSeconds = inputRecording.getFrame(replayFrame).deltaTime;
+            currentTime = previousTime + frameSeconds;
+        }
+        else if (!inputRecordPath.empty())
         {
-            flashTimer += deltaTime;
+            inputRecording.beginFrame(frameSeconds);
+        }
+        deltaTime = (float)frameSeconds;
+        previousTime = currentTime;
 
-            if (fmod(flashTimer * 10.0f, 2.0f) < 1.0f)
+        // --- Fixed step simulation ---
+        int simulationSteps = simulationClock.advance(deltaTime);
+        float simulationStep = (float)simulationClock.getStep();
+        for (int step = 0; step < simulationSteps; ++step)
+        {
+            camera.BeginStep();
+            if (window || replayingInput)
+            {
+                PROFILE_SCOPE("input");
+                continousKeyPress(window, camera, simulationStep);
+            }
             {
-                glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+                PROFILE_SCOPE("physics");
+                stepSimulation(simulationStep, hermite, hoopColliders);
             }
-            else
+
+            PROFILE_SCOPE("scene graph");
+            sceneGraph.updateWorldTransforms();
+            readPointLightPositions();
+            hoopColliders = getHoopColliders(hoopNodes);
+        }
+
+        if (changeToGameplayScene && currentScene == SELECTION_SCENE)
+        {
+            ballEntity = selectionBalls[indexObject];
+            for (Entity entity : selectionBalls)
             {
-                glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+                if (entity != ballEntity)
+                {
+                    world.destroy(entity);
+                }
             }
+            selectionBalls.clear();
 
-            if (flashTimer > flashDuration)
+            // The basketball model is authored at gameplay size, the others keep their scale.
+            if (indexObject == 0)
             {
-                flashScreen = false;
-                glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+                world.getScale(ballEntity) = glm::vec3(1.0f);
             }
+            world.getPosition(ballEntity) = getBallHandPosition();
+
+            hoopEntity = world.create(MESH | MATERIAL | SCENE_NODE);
+            world.getMesh(hoopEntity) = basketHoop.mesh;
+            world.getMaterial(hoopEntity) = basketHoop.materialIndex;
+            world.getSceneNode(hoopEntity) = hoopNodes.mesh;
+
+            numberEntity = world.create(TRANSFORM | CURVE_FOLLOWER);
+            CurveFollower& numberFollower = world.getCurveFollower(numberEntity);
+            numberFollower.speed = hermitePointsPerSecond;
+            numberFollower.length = (float)hermiteNbCurvePoints;
+            numberFollower.loop = true;
+            world.getPosition(numberEntity) = getInterpolatedCurvePoint(hermite, 0.0f);
+            world.getRotation(numberEntity) = getNumberRotation(world.getPosition(numberEntity));
+            world.getScale(numberEntity) = glm::vec3(scoreTextHeight);
+
+            currentScene = GAMEPLAY_SCENE;
+            staticShadowVersion++;
         }
-        glDisable(GL_DEPTH_TEST);
 
-        // --- Background Stars ---
-        if (!flashScreen)
+        // --- Publish snapshot ---
+        if (simulationSteps > 0)
         {
-            glUseProgram(backgroundStarsShader.ID);
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, backgroundStarsTexture);
-            glBindVertexArray(backgroundStarsVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 6);
-            glBindVertexArray(0);
+            PROFILE_SCOPE("snapshot");
+            FrameSnapshot& snapshot = frameSnapshots.beginWrite();
+            buildFrameSnapshot(snapshot, hoopColliders);
+            snapshot.step = simulationClock.getStep();
+            snapshot.stateTime = currentTime - simulationClock.getAlpha() * snapshot.step;
+            frameSnapshots.publish();
         }
 
-        // --- Background Floor ---
-        glUseProgram(backgroundShader.ID);
-        view = camera.GetViewMatrix();
-        projection = glm::perspective(glm::radians(45.0f), (float)width / (float)height, 0.1f, 100.0f);
-        backgroundShader.setMat4("view", glm::value_ptr(view));
-        backgroundShader.setMat4("projection", glm::value_ptr(projection));
-
-        modelFloor = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -1.0f, 0.0f));
-        glUniformMatrix4fv(modelLocFloor, 1, GL_FALSE, glm::value_ptr(modelFloor));
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, backgroundTexture);
-        glBindVertexArray(backgroundVAO);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        glBindVertexArray(0);
-
-        // --- Drawing Bezier Curve ---
-        glUseProgram(curvesShader.ID);
-        curvesShader.setMat4("view", glm::value_ptr(view));
-        curvesShader.setMat4("projection", glm::value_ptr(projection));
-        curvesShader.setVec4("finalColor", 1, 0, 0, 1);
+        // Sleep until the next step is due, waking up early to handle input.
+        double timeout = (1.0 - simulationClock.getAlpha()) * simulationClock.getStep();
+        if (replayingInput)
+        {
+            PROFILE_SCOPE("input");
+            size_t nextFrame = replayFrame + 1;
+            double nextDelta = nextFrame < inputRecording.getFrameCount() ? inputRecording.getFrame(nextFrame).deltaTime
+                                                                          : 0.0;
+            replayInputFrame(window, currentTime + nextDelta);
+            if (!replayingInput)
+            {
+                replayFinished = true;
+                cout << "Replay finished after " << inputRecording.getFrameCount() << " frames (state checksum "
+                    << std::hex << getStateChecksum() << std::dec << ")" << endl;
+            }
+        }
+        else if (headless)
+        {
+            std::this_thread::sleep_for(std::chrono::duration<double>(timeout));
+        }
+        else
+        {
+            PROFILE_SCOPE("input");
+            glfwWaitEventsTimeout(timeout);
+        }
+    }
 
-        glm::vec3 p0 = ballPosition;
-        glm::vec3 p2 = hoopCenter;
+    renderThreadRunning = false;
+    renderThread.join();
+    setRenderContextCurrent(renderResources, true);
 
-        glm::vec3 p1 = (p0 + p2) * 0.5f + glm::vec3(0.0f, 3.0f, 0.0f);
-        std::vector<glm::vec3> controlPoints;
-        controlPoints.push_back(p0);
-        controlPoints.push_back(p1);
-        controlPoints.push_back(p2);
+    if (headless)
+    {
+        double seconds = glfwGetTime() - startTime;
+        cout << "Headless: " << renderedFrames << " frames in " << seconds << " s, "
+            << seconds * 1000.0 / std::max((int)renderedFrames, 1) << " ms per frame" << endl;
+    }
 
-        bezier.setControlPoints(controlPoints);
-        bezier.generateQuadraticCurve(30);
-        bezierNbCurvePoints = bezier.getNbCurvePoints();
-        GLuint VAObezierControlPoints = generateControlPointsBuffer(controlPoints);
+    if (benchmarkReplay)
+    {
+        printFrameTimeStats("frame interval", renderResources.benchmarkFrameIntervals);
+        printFrameTimeStats("frame CPU", renderResources.benchmarkFrameTimes);
+    }
 
-        glBindVertexArray(VAObezierControlPoints);
-        glBindVertexArray(0);
-        if (jsonData["showParametricCurves"].get<bool>())
+    if (!inputRecordPath.empty())
+    {
+        if (inputRecording.save(inputRecordPath))
         {
-            bezier.drawCurve(glm::vec4(1, 0, 0, 1));
+            cout << "Input recording: " << inputRecording.getFrameCount() << " frames written to " << inputRecordPath
+                << " (state checksum " << std::hex << getStateChecksum() << std::dec << ")" << endl;
         }
-
-        // --- Hermite ---
-        glUseProgram(curvesShader.ID);
-        curvesShader.setMat4("view", glm::value_ptr(view));
-        curvesShader.setMat4("projection", glm::value_ptr(projection));
-        curvesShader.setVec4("finalColor", 1, 1, 0, 1);
-
-        glBindVertexArray(VAOhermiteControlPoints);
-        glBindVertexArray(0);
-        if (jsonData["showParametricCurves"].get<bool>())
+        else
         {
-            hermite.drawCurve(glm::vec4(1, 1, 0, 1));
+            cerr << "Failed to write input recording: " << inputRecordPath << endl;
         }
+    }
 
-        glm::vec3 hermitePointOnCurve = hermite.getPointOnCurve(hermitePointOnCurveIterReference);
-        pointsOnCurveVector.push_back(hermitePointOnCurve);
-        hermitePointOnCurveIterReference = (hermitePointOnCurveIterReference + 1) % hermiteNbCurvePoints;
-
-        float currentFrame = (float)glfwGetTime();
-        deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
-
-        switch (currentScene)
+    if (!commandDumpPath.empty())
+    {
+        if (renderResources.commands.save(commandDumpPath))
         {
-        case SELECTION_SCENE:
-            {
-                glEnable(GL_DEPTH_TEST);
-                glUseProgram(shader.ID);
-                shader.setMat4("view", glm::value_ptr(view));
-                shader.setMat4("projection", glm::value_ptr(projection));
-                shader.setVec4("finalColor", 1, 0, 0, 1);
-
-                for (size_t i = 0; i < sceneObjects.size(); ++i)
-                {
-                    Geometry& obj = sceneObjects[i];
-
-                    model = glm::mat4(1.0f);
-                    model = glm::translate(model, obj.position);
-                    model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-                    model = glm::scale(model, glm::vec3(obj.scaleFactor));
-
-                    if (indexObject == i)
-                    {
-                        if (rotateX)
-                        {
-                            model = glm::rotate(model, currentFrame, glm::vec3(1.0f, 0.0f, 0.0f));
-                        }
-                        else if (rotateY)
-                        {
-                            model = glm::rotate(model, currentFrame, glm::vec3(0.0f, 1.0f, 0.0f));
-                        }
-                        else if (rotateZ)
-                        {
-                            model = glm::rotate(model, currentFrame, glm::vec3(0.0f, 0.0f, 1.0f));
-                        }
-                    }
-
-                    shader.setVec3("ka", obj.ka.r, obj.ka.g, obj.ka.b);
-                    shader.setVec3("kd", obj.kd.r, obj.kd.g, obj.kd.b);
-                    shader.setVec3("ks", obj.ks.r, obj.ks.g, obj.ks.b);
-                    shader.setVec3("ke", obj.ke.r, obj.ke.g, obj.ke.b);
-                    shader.setFloat("q", obj.shininess);
+            cout << "Command stream: " << renderResources.commands.size() << " commands written to "
+                << commandDumpPath << endl;
+        }
+        else
+        {
+            cerr << "Failed to write command stream: " << commandDumpPath << endl;
+        }
+    }
+    if (nullCommandBackend)
+    {
+        nullBackend.print(cout);
+        cout << "  Every pass is recorded; rendering issued no GL calls besides presenting and creating resources "
+            "on first use." << endl;
+    }
 
-                    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-
-                    glBindTexture(GL_TEXTURE_2D, obj.textureID);
-                    glBindVertexArray(obj.VAO);
-                    glDrawArrays(GL_TRIANGLES, 0, obj.vertexCount);
-
-                    continousKeyPress(window, camera, deltaTime);
-                }
-
-                if (changeToGameplayScene)
-                {
-                    Geometry selectedBall = sceneObjects[indexObject];
-                    sceneObjects.clear();
-                    sceneObjects.resize(2);
-                    sceneObjects[0] = selectedBall;
-                    sceneObjects.push_back(basketHoop);
-                    currentScene = GAMEPLAY_SCENE;
-                }
-
-                break;
-            }
-        case GAMEPLAY_SCENE:
-            {
-                // --- Scene objects ---
-                glEnable(GL_DEPTH_TEST);
-                glUseProgram(shader.ID);
-                shader.setMat4("view", glm::value_ptr(view));
-                shader.setMat4("projection", glm::value_ptr(projection));
-                shader.setVec4("finalColor", 1, 0, 0, 1);
-
-                for (size_t i = 0; i < sceneObjects.size(); ++i)
-                {
-                    Geometry& obj = sceneObjects[i];
-
-                    if (i == 0) // Ball
-                    {
-                        if (!throwBall)
-                        {
-                            glm::vec3 forward = glm::normalize(camera.Front);
-                            glm::vec3 up = glm::normalize(camera.Up);
-                            glm::vec3 right = glm::normalize(glm::cross(forward, up));
-
-                            glm::vec3 offset = forward * 2.0f + up * -0.5f; // + right * 0.0f;
-                            glm::vec3 ballPosition = camera.Position + offset;
-
-                            model = glm::mat4(1.0f);
-                            model = glm::translate(model, ballPosition);
-
-                            glm::mat4 rotationOnly = glm::mat4(glm::mat3(camera.GetViewMatrix()));
-                            model *= glm::inverse(rotationOnly);
-                        }
-                        else
-                        {
-                            if (throwBallBezier)
-                            {
-                                if (justLaunched)
-                                {
-                                    glm::vec3 p0 = camera.Position + camera.Front * 2.0f + camera.Up * -0.5f;
-                                    glm::vec3 p2 = hoopCenter;
-                                    glm::vec3 p1 = (p0 + p2) * 0.5f + glm::vec3(0.0f, 8.0f, 0.0f);
-
-                                    bezierCurvePoints.clear();
-                                    for (int i = 0; i <= 30; ++i)
-                                    {
-                                        float t = i / 30.0f;
-                                        glm::vec3 point =
-                                            (1 - t) * (1 - t) * p0 +
-                                            2 * (1 - t) * t * p1 +
-                                            t * t * p2;
-                                        bezierCurvePoints.push_back(point);
-                                    }
-
-                                    bezierT = 0.0f;
-                                    ballPosition = p0;
-                                    bezierPhase = true;
-                                    justLaunched = false;
-                                }
-
-                                if (bezierPhase)
-                                {
-                                    bezierT += deltaTime * bezierSpeed;
-
-                                    if (bezierT >= 1.0f)
-                                    {
-                                        bezierPhase = false;
-
-                                        glm::vec3 pA = bezierCurvePoints[bezierCurvePoints.size() - 2];
-                                        glm::vec3 pB = bezierCurvePoints.back();
-                                        finalBezierDirection = glm::normalize(pB - pA);
-
-                                        ballVelocity = finalBezierDirection * launchBallSpeed * 0.6f;
-                                    }
-                                    else
-                                    {
-                                        int totalPoints = bezierCurvePoints.size();
-                                        float indexF = bezierT * (totalPoints - 1);
-                                        int idx = (int)indexF;
-                                        float frac = indexF - idx;
-
-                                        if (idx < totalPoints - 1)
-                                        {
-                                            ballPosition = glm::mix(bezierCurvePoints[idx], bezierCurvePoints[idx + 1],
-                                                                    frac);
-                                        }
-                                    }
-                                }
-                                else
-                                {
-                                    ballVelocity += glm::vec3(0.0f, -4.81f, 0.0f) * deltaTime;
-                                    ballPosition += ballVelocity * deltaTime;
-                                }
-                            }
-                            else
-                            {
-                                glm::vec3 launchDir = glm::normalize(camera.Front + camera.Up * 0.25f);
-
-                                if (justLaunched)
-                                {
-                                    ballVelocity = launchDir * launchBallSpeed;
-                                    ballPosition = camera.Position + camera.Front * 2.0f + camera.Up * -0.5f;
-                                    justLaunched = false;
-                                }
-
-                                ballVelocity += glm::vec3(0.0f, -4.81f, 0.0f) * deltaTime;
-                                ballPosition += ballVelocity * deltaTime;
-                            }
-
-                            if (!alreadyScored &&
-                                checkSphereAABB(ballPosition, ballRadius, scoreZoneMin, scoreZoneMax) &&
-                                ballVelocity.y < 0.0f)
-                            {
-                                score++;
-                                alreadyScored = true;
-                                ballSoftened = true;
-                                softenTimer = 0.0f;
-                                std::cout << "Hoop! Score: " << score << std::endl;
-                            }
-
-                            if (alreadyScored &&
-                                !checkSphereAABB(ballPosition, ballRadius, scoreZoneMin, scoreZoneMax))
-                            {
-                                alreadyScored = false;
-                            }
-
-                            if (ballSoftened)
-                            {
-                                softenTimer += deltaTime;
-                                ballVelocity *= 0.5f;
-
-                                if (softenTimer >= softenDuration)
-                                {
-                                    ballSoftened = false;
-                                }
-                            }
-
-                            model = glm::mat4(1.0f);
-                            model = glm::translate(model, ballPosition);
-                            model = glm::rotate(model, currentFrame * 5, glm::vec3(-1.0f, 0.0f, 0.0f));
-
-                            if (ballPosition.y < ballGroundY)
-                            {
-                                ballPosition.y = ballGroundY;
-                                ballVelocity.y *= -0.6f;
-                                ballVelocity.x *= 0.95f;
-                                ballVelocity.z *= 0.95f;
-
-                                if (glm::length(ballVelocity) < 10.5f)
-                                {
-                                    throwBall = false;
-                                    throwBallBezier = false;
-
-                                    ballVelocity = glm::vec3(0.0f);
-                                    ballPosition = camera.Position + camera.Front * 2.0f + camera.Up * -0.5f;
-                                    justLaunched = true;
-                                }
-                            }
-
-                            if (checkSphereAABB(ballPosition, ballRadius, backboardMin, backboardMax) ||
-                                checkSphereAABB(ballPosition, ballRadius, rimMin, rimMax) ||
-                                checkSphereAABB(ballPosition, ballRadius, poleMin, poleMax))
-                            {
-                                glm::vec3 normal = glm::vec3(0.0f, 0.0f, 1.0f);
-                                ballVelocity = ballVelocity - 2.0f * glm::dot(ballVelocity, normal) * normal;
-                                ballVelocity *= 0.7f;
-                                ballPosition += normal * 0.03f;
-                                std::cout << "Colision\n";
-                            }
-                        }
-                        if (obj.name != "basketBall")
-                        {
-                            model = glm::scale(model, glm::vec3(obj.scaleFactor));
-                        }
-                    }
-                    else
-                    {
-                        model = glm::mat4(1.0f);
-                        model = glm::translate(model, obj.position);
-                        model = glm::rotate(model, glm::radians(-90.0f),
-                                            glm::vec3(jsonData["objectRotation"][0], jsonData["objectRotation"][1],
-                                                      jsonData["objectRotation"][2]));
-                        model = glm::scale(model, glm::vec3(obj.scaleFactor));
-                    }
-
-                    shader.setVec3("ka", obj.ka.r, obj.ka.g, obj.ka.b);
-                    shader.setVec3("kd", obj.kd.r, obj.kd.g, obj.kd.b);
-                    shader.setVec3("ks", obj.ks.r, obj.ks.g, obj.ks.b);
-                    shader.setVec3("ke", obj.ke.r, obj.ke.g, obj.ke.b);
-                    shader.setFloat("q", obj.shininess);
-
-                    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-
-                    glBindTexture(GL_TEXTURE_2D, obj.textureID);
-                    glBindVertexArray(obj.VAO);
-                    glDrawArrays(GL_TRIANGLES, 0, obj.vertexCount);
-
-                    continousKeyPress(window, camera, deltaTime);
-                }
-
-                Geometry& numberObject = numberObjects[score];
-                numberObject.position = pointsOnCurveVector[0];
-
-                glUseProgram(shaderNumber.ID);
-
-                shaderNumber.setMat4("view", glm::value_ptr(view));
-                shaderNumber.setMat4("projection", glm::value_ptr(projection));
-                shaderNumber.setVec4("finalColor", 1.0, 0, 0, 1);
-
-                glm::vec3 center = glm::vec3(0.0f, numberObject.position.y, 0.0f);
-                glm::vec3 dirToCenter = glm::normalize(center - numberObject.position);
-                float angle = atan2(dirToCenter.x, dirToCenter.z);
-
-                model = glm::mat4(1.0f);
-                model = glm::translate(model, numberObject.position);
-                model = glm::rotate(model, angle, glm::vec3(0.0f, 1.0f, 0.0f));
-                model = glm::rotate(model, glm::radians(-90.0f),
-                                    glm::vec3(jsonData["numberRotation"][0], jsonData["numberRotation"][1],
-                                              jsonData["numberRotation"][2]));
-
-                model = glm::scale(model, glm::vec3(numberObject.scaleFactor));
-
-                shaderNumber.setVec3("ka", numberObject.ka.r, numberObject.ka.g, numberObject.ka.b);
-                shaderNumber.setVec3("kd", numberObject.kd.r, numberObject.kd.g, numberObject.kd.b);
-                shaderNumber.setVec3("ks", numberObject.ks.r, numberObject.ks.g, numberObject.ks.b);
-                shaderNumber.setVec3("ke", numberObject.ke.r, numberObject.ke.g, numberObject.ke.b);
-                shaderNumber.setFloat("q", numberObject.shininess);
-                shaderNumber.setVec3("color", 1.0f, 0.0f, 0.0f);
-
-                glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-
-                glBindTexture(GL_TEXTURE_2D, numberObject.textureID);
-                glBindVertexArray(numberObject.VAO);
-                glDrawArrays(GL_TRIANGLES, 0, numberObject.vertexCount);
-                break;
-            }
+    // --- Cleanup ---
+    if (!traceOutputPath.empty())
+    {
+        if (!CPUProfiler::isEnabled())
+        {
+            cerr << "CPU profiling is compiled out of this build, no trace written" << endl;
+        }
+        else if (!CPUProfiler::writeChromeTrace(traceOutputPath))
+        {
+            cerr << "Failed to write trace: " << traceOutputPath << endl;
         }
-
-        // --- Finalizing Frame ---
-        glBindVertexArray(0);
-        glBindTexture(GL_TEXTURE_2D, 0);
-        glfwSwapBuffers(window);
-        pointsOnCurveVector.clear();
-
-        continousKeyPress(window, camera, deltaTime);
     }
-
-    // --- Cleanup ---
-    for (const Geometry& obj : sceneObjects)
+    if (!profileOutputPath.empty())
+    {
+        if (gpuProfiler->exportCSV(profileOutputPath))
+        {
+            cout << "Pass timings written to " << profileOutputPath << endl;
+        }
+        else
+        {
+            cerr << "Failed to write pass timings: " << profileOutputPath << endl;
+        }
+    }
+    gpuProfiler.reset();
+    perfHUD.reset();
+    textRenderer.reset();
+    particleSystem.reset();
+    particlePrograms.reset();
+    impostorRenderer.reset();
+    materialTable.reset();
+    sceneTarget.reset();
+    glDeleteSamplers(1, &textureSampler);
+    world.forEach(MESH, [](Archetype& archetype)
+    {
+        for (const MeshRef& mesh : archetype.meshes)
+        {
+            glDeleteVertexArrays(1, &mesh.VAO);
+        }
+    });
+    if (frameCapture->getCapturedFrames() > 0 || frameCapture->getDroppedFrames() > 0)
     {
-        glDeleteVertexArrays(1, &obj.VAO);
+        cout << "Capture: " << frameCapture->getCapturedFrames() << " frames written, "
+            << frameCapture->getDroppedFrames() << " dropped" << endl;
     }
+    frameCapture.reset();
+    shadowMap.reset();
+    lightClusters.reset();
+    frameRing.reset();
 
     glfwTerminate();
     return 0;
@@ -935,78 +1436,155 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mode
         if (key == GLFW_KEY_A && action == GLFW_PRESS)
         {
             glm::vec3 right = glm::normalize(glm::cross(camera.Front, camera.Up));
-            sceneObjects[indexObject].position -= right * speed;
+            world.getPosition(selectionBalls[indexObject]) -= right * speed;
         }
 
         if (key == GLFW_KEY_W && action == GLFW_PRESS)
         {
-            sceneObjects[indexObject].position += glm::normalize(camera.Front) * speed;
+            world.getPosition(selectionBalls[indexObject]) += glm::normalize(camera.Front) * speed;
         }
 
         if (key == GLFW_KEY_S && action == GLFW_PRESS)
         {
-            sceneObjects[indexObject].position -= glm::normalize(camera.Front) * speed;
+            world.getPosition(selectionBalls[indexObject]) -= glm::normalize(camera.Front) * speed;
         }
 
         if (key == GLFW_KEY_D && action == GLFW_PRESS)
         {
             glm::vec3 right = glm::normalize(glm::cross(camera.Front, camera.Up));
-            sceneObjects[indexObject].position += right * speed;
+            world.getPosition(selectionBalls[indexObject]) += right * speed;
         }
 
         if (key == GLFW_KEY_J && action == GLFW_PRESS)
         {
-            sceneObjects[indexObject].position.y -= speed;
+            world.getPosition(selectionBalls[indexObject]).y -= speed;
         }
 
         if (key == GLFW_KEY_I && action == GLFW_PRESS)
         {
-            sceneObjects[indexObject].position.y += speed;
+            world.getPosition(selectionBalls[indexObject]).y += speed;
         }
 
         if (key == GLFW_KEY_MINUS && action == GLFW_PRESS)
         {
-            sceneObjects[indexObject].scaleFactor -= speed;
+            world.getScale(selectionBalls[indexObject]) -= glm::vec3(speed);
         }
 
         if (key == GLFW_KEY_EQUAL && action == GLFW_PRESS)
         {
-            sceneObjects[indexObject].scaleFactor += speed;
+            world.getScale(selectionBalls[indexObject]) += glm::vec3(speed);
         }
     }
 
-    if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
+    if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS && window)
     {
         glfwSetWindowShouldClose(window, GL_TRUE);
     }
 
+    if (key == GLFW_KEY_B && action == GLFW_PRESS)
+    {
+        batteryMode = !batteryMode;
+        applyTimingMode();
+    }
+
+    if (key == GLFW_KEY_L && action == GLFW_PRESS)
+    {
+        int nextCount = 0;
+        for (int count : POINT_LIGHT_COUNT_STEPS)
+        {
+            if (count > (int)pointLights.size())
+            {
+                nextCount = count;
+                break;
+            }
+        }
+        setPointLightCount(nextCount);
+        cout << "Point lights: " << nextCount << endl;
+    }
+
+    if (key == GLFW_KEY_N && action == GLFW_PRESS)
+    {
+        perVertexNormalMatrix = !perVertexNormalMatrix;
+        cout << "Normal matrix: " << (perVertexNormalMatrix ? "per-vertex inverse" : "uniform") << endl;
+    }
+
+    if (key == GLFW_KEY_K && action == GLFW_PRESS)
+    {
+        shadowSettings.type = (ShadowType)(((int)shadowSettings.type + 1) % 3);
+        cout << "Shadows: " << getShadowTypeName(shadowSettings.type) << endl;
+    }
+
+    if (key == GLFW_KEY_E && action == GLFW_PRESS)
+    {
+        runEntityBenchmark();
+    }
+
+    if (key == GLFW_KEY_P && action == GLFW_PRESS)
+    {
+        depthPrePass = !depthPrePass;
+        cout << "Depth pre-pass: " << (depthPrePass ? "on" : "off") << endl;
+    }
+
+    if (key == GLFW_KEY_O && action == GLFW_PRESS)
+    {
+        showOverdraw = !showOverdraw;
+        cout << "Overdraw view: " << (showOverdraw ? "on" : "off") << endl;
+    }
+
+    if (key == GLFW_KEY_G && action == GLFW_PRESS)
+    {
+        profileReportVersion++;
+    }
+
+    if (key == GLFW_KEY_H && action == GLFW_PRESS)
+    {
+        showHUD = !showHUD;
+    }
+
+    if (key == GLFW_KEY_R && action == GLFW_PRESS)
+    {
+        dynamicResolution = !dynamicResolution;
+        cout << "Dynamic resolution: " << (dynamicResolution ? "on" : "off") << endl;
+    }
+
+    if (key == GLFW_KEY_F && action == GLFW_PRESS)
+    {
+        celebrationVersion++;
+    }
+
+    if (key == GLFW_KEY_V && action == GLFW_PRESS)
+    {
+        particleBenchmarkVersion++;
+    }
 
-    if (sceneObjects[indexObject].scaleFactor < 0.001f)
+    if (key == GLFW_KEY_C && action == GLFW_PRESS)
     {
-        sceneObjects[indexObject].scaleFactor = 0.001f;
+        capturing = !capturing;
+        cout << "Frame capture: " << (capturing ? "on" : "off") << endl;
     }
 
-    if (sceneObjects[indexObject].scaleFactor > 0.7f)
+    if (currentScene == SELECTION_SCENE)
     {
-        sceneObjects[indexObject].scaleFactor = 0.7f;
+        glm::vec3& scale = world.getScale(selectionBalls[indexObject]);
+        scale = glm::clamp(scale, glm::vec3(0.001f), glm::vec3(0.7f));
     }
 }
 
 void continousKeyPress(GLFWwindow* window, Camera& camera, float currentTime)
 {
-    if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
+    if (isKeyDown(window, GLFW_KEY_UP))
     {
         camera.ProcessKeyboard("FORWARD", currentTime);
     }
-    if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
+    if (isKeyDown(window, GLFW_KEY_DOWN))
     {
         camera.ProcessKeyboard("BACKWARD", currentTime);
     }
-    if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
+    if (isKeyDown(window, GLFW_KEY_LEFT))
     {
         camera.ProcessKeyboard("LEFT", currentTime);
     }
-    if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
+    if (isKeyDown(window, GLFW_KEY_RIGHT))
     {
         camera.ProcessKeyboard("RIGHT", currentTime);
     }
@@ -1051,174 +1629,241 @@ void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
 {
     if (currentScene == GAMEPLAY_SCENE)
     {
-        if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
+        if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS && !isBallInFlight())
         {
-            throwBall = true;
+            pendingThrow = BallThrow::Straight;
         }
 
-        if (button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_PRESS)
+        if (button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_PRESS && !isBallInFlight())
         {
-            throwBallBezier = true;
-            throwBall = true;
+            pendingThrow = BallThrow::Bezier;
         }
     }
 }
 
-Geometry setupGeometry(const char* filepath)
+void liveKeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
-    std::vector<GLfloat> vertices;
-    std::vector<glm::vec3> vert;
-    std::vector<glm::vec2> uvs;
-    std::vector<glm::vec3> normals;
+    InputEvent event;
+    event.type = InputEventType::Key;
+    event.code = key;
+    event.scancode = scancode;
+    event.action = action;
+    event.mods = mods;
+    handleLiveInput(window, event);
+}
+
+void liveCursorPosCallback(GLFWwindow* window, double xpos, double ypos)
+{
+    InputEvent event;
+    event.type = InputEventType::CursorPos;
+    event.x = xpos;
+    event.y = ypos;
+    handleLiveInput(window, event);
+}
 
-    loadObject(filepath, vert, uvs, normals);
+void liveMouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
+{
+    InputEvent event;
+    event.type = InputEventType::MouseButton;
+    event.code = button;
+    event.action = action;
+    event.mods = mods;
+    handleLiveInput(window, event);
+}
 
-    vertices.reserve(vert.size() * 8);
-    for (size_t i = 0; i < vert.size(); ++i)
+void handleLiveInput(GLFWwindow* window, const InputEvent& event)
+{
+    // Live input would change the outcome of a replay.
+    if (replayingInput)
     {
-        vertices.insert(vertices.end(),
-                        {
-                            vert[i].x, vert[i].y, vert[i].z,
-                            uvs[i].x, uvs[i].y,
-                            normals[i].x, normals[i].y, normals[i].z
-                        });
+        return;
     }
 
-    GLuint VBO, VAO;
-
-    glGenBuffers(1, &VBO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    if (!inputRecordPath.empty())
+    {
+        inputRecording.addEvent(event);
+    }
+    dispatchInput(window, event);
+}
 
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_STATIC_DRAW);
+void dispatchInput(GLFWwindow* window, const InputEvent& event)
+{
+    switch (event.type)
+    {
+    case InputEventType::Key:
+        if (event.code >= 0 && event.code <= GLFW_KEY_LAST)
+        {
+            replayKeysDown[event.code] = event.action != GLFW_RELEASE;
+        }
+        keyCallback(window, event.code, event.scancode, event.action, event.mods);
+        break;
+    case InputEventType::MouseButton:
+        mouseButtonCallback(window, event.code, event.action, event.mods);
+        break;
+    case InputEventType::CursorPos:
+        mouseCallback(window, event.x, event.y);
+        break;
+    }
+}
 
-    glGenVertexArrays(1, &VAO);
+bool isKeyDown(GLFWwindow* window, int key)
+{
+    if (replayingInput)
+    {
+        return replayKeysDown[key];
+    }
+    return glfwGetKey(window, key) == GLFW_PRESS;
+}
 
-    glBindVertexArray(VAO);
+void replayInputFrame(GLFWwindow* window, double frameEndTime)
+{
+    // Wait as long as the recorded frame did, so rendering sees the same pace.
+    double remaining = frameEndTime - glfwGetTime();
+    if (remaining > 0.0)
+    {
+        std::this_thread::sleep_for(std::chrono::duration<double>(remaining));
+    }
+    if (window)
+    {
+        // Keeps the window responsive; the live events are dropped by handleLiveInput.
+        glfwPollEvents();
+    }
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)0);
-    glEnableVertexAttribArray(0);
+    for (const InputEvent& event : inputRecording.getFrame(replayFrame).events)
+    {
+        dispatchInput(window, event);
+    }
 
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(1);
+    if (++replayFrame == inputRecording.getFrameCount())
+    {
+        replayingInput = false;
+    }
+}
 
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)(5 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(2);
+uint64_t getStateChecksum()
+{
+    // FNV-1a over the camera and every entity transform.
+    uint64_t hash = 1469598103934665603ull;
+    auto add = [&hash](const void* data, size_t size)
+    {
+        const unsigned char* bytes = (const unsigned char*)data;
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    add(&camera.Position, sizeof(camera.Position));
+    add(&camera.Yaw, sizeof(camera.Yaw));
+    add(&camera.Pitch, sizeof(camera.Pitch));
+    world.forEach(TRANSFORM, [&add](Archetype& archetype)
+    {
+        add(archetype.positions.data(), archetype.positions.size() * sizeof(glm::vec3));
+        add(archetype.rotations.data(), archetype.rotations.size() * sizeof(glm::quat));
+        add(archetype.scales.data(), archetype.scales.size() * sizeof(glm::vec3));
+    });
+    return hash;
+}
 
-    Geometry geom;
-    geom.VAO = VAO;
-    geom.vertexCount = vertices.size() / 6; // 3 for position + 3 for color
+void printFrameTimeStats(const string& label, std::vector<double> milliseconds)
+{
+    if (milliseconds.empty())
+    {
+        return;
+    }
 
-    string basePath = string(filepath).substr(0, string(filepath).find_last_of("/"));
-    string mtlPath = basePath + "/" + mtlFilePath;
-    Material mat = loadMTL(mtlPath);
-    geom.ka = mat.ka;
-    geom.kd = mat.kd;
-    geom.ks = mat.ks;
-    geom.ke = mat.ke;
-    geom.shininess = mat.shininess;
-    geom.textureFilePath = mat.texturePath;
+    std::sort(milliseconds.begin(), milliseconds.end());
+    auto percentile = [&milliseconds](double p)
+    {
+        size_t rank = (size_t)std::ceil(p / 100.0 * milliseconds.size());
+        return milliseconds[std::clamp(rank, (size_t)1, milliseconds.size()) - 1];
+    };
 
-    if (!mat.texturePath.empty())
+    double sum = 0.0;
+    for (double value : milliseconds)
     {
-        string fullTexturePath = basePath + "/" + mat.texturePath;
-        geom.textureID = loadTexture(fullTexturePath);
+        sum += value;
     }
 
-    return geom;
+    cout << "Benchmark " << label << ": " << milliseconds.size() << " frames, avg " << sum / milliseconds.size()
+        << " ms, p50 " << percentile(50.0) << ", p95 " << percentile(95.0) << ", p99 " << percentile(99.0)
+        << ", p99.9 " << percentile(99.9) << ", max " << milliseconds.back() << endl;
 }
 
-void framebufferSizeCallback(GLFWwindow* window, int width, int height)
+Geometry setupGeometry(const char* filepath, MaterialTable& materialTable)
 {
-    glViewport(0, 0, width, height);
-}
+    PROFILE_SCOPE("setupGeometry");
+    std::vector<GLfloat> vertices;
+    std::vector<glm::vec3> vert;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
 
-bool loadObject(
-    const char* path,
-    std::vector<glm::vec3>& out_vertices,
-    std::vector<glm::vec2>& out_uvs,
-    std::vector<glm::vec3>& out_normals)
-{
-    std::ifstream file(path);
+    string mtlFilePath;
+    loadObject(filepath, vert, uvs, normals, &mtlFilePath);
 
-    if (!file)
+    vertices.reserve(vert.size() * 8);
+    for (size_t i = 0; i < vert.size(); ++i)
     {
-        std::cerr << "Failed to open file: " << path << std::endl;
-        return false;
+        vertices.insert(vertices.end(),
+                        {
+                            vert[i].x, vert[i].y, vert[i].z,
+                            uvs[i].x, uvs[i].y,
+                            normals[i].x, normals[i].y, normals[i].z
+                        });
     }
 
-    std::vector<unsigned int> vertexIndices, uvIndices, normalIndices;
-    std::vector<glm::vec3> temp_vertices;
-    std::vector<glm::vec2> temp_uvs;
-    std::vector<glm::vec3> temp_normals;
+    // Position, uv and normal.
+    GLuint VBO = createStaticBuffer(vertices.data(), vertices.size() * sizeof(GLfloat));
+    GLuint VAO = createVertexArray(VBO, 8 * sizeof(GLfloat),
+                                   {{0, 3, 0}, {1, 2, 3 * sizeof(GLfloat)}, {2, 3, 5 * sizeof(GLfloat)}});
 
-    std::string line;
+    Geometry geom;
+    geom.mesh.VAO = VAO;
+    geom.mesh.vertexCount = vert.size();
 
-    while (std::getline(file, line))
+    // Bounding sphere around the center of the box, for the impostor atlas.
+    if (!vert.empty())
     {
-        std::istringstream iss(line);
-        std::string type;
-        iss >> type;
-
-        if (type == "v")
-        {
-            glm::vec3 vertex;
-            iss >> vertex.x >> vertex.y >> vertex.z;
-            temp_vertices.push_back(vertex);
-        }
-        else if (type == "vt")
-        {
-            glm::vec2 uv;
-            iss >> uv.x >> uv.y;
-            temp_uvs.push_back(uv);
-        }
-        else if (type == "vn")
-        {
-            glm::vec3 normal;
-            iss >> normal.x >> normal.y >> normal.z;
-            temp_normals.push_back(normal);
-        }
-        else if (type == "f")
+        glm::vec3 minimum = vert[0];
+        glm::vec3 maximum = vert[0];
+        for (const glm::vec3& v : vert)
         {
-            unsigned int vertexIndex[3], uvIndex[3], normalIndex[3];
-            char slash;
-
-            for (int i = 0; i < 3; ++i)
-            {
-                iss >> vertexIndex[i] >> slash >> uvIndex[i] >> slash >> normalIndex[i];
-                vertexIndices.push_back(vertexIndex[i]);
-                uvIndices.push_back(uvIndex[i]);
-                normalIndices.push_back(normalIndex[i]);
-            }
+            minimum = glm::min(minimum, v);
+            maximum = glm::max(maximum, v);
         }
-        else if (type == "mtllib")
+        geom.mesh.boundsCenter = (minimum + maximum) * 0.5f;
+        for (const glm::vec3& v : vert)
         {
-            iss >> mtlFilePath;
+            geom.mesh.boundsRadius = std::max(geom.mesh.boundsRadius, glm::distance(v, geom.mesh.boundsCenter));
         }
     }
 
-    // Populate output vectors
-    for (unsigned int i = 0; i < vertexIndices.size(); ++i)
-    {
-        unsigned int vertexIndex = vertexIndices[i];
-        unsigned int uvIndex = uvIndices[i];
-        unsigned int normalIndex = normalIndices[i];
-
-        glm::vec3 vertex = temp_vertices[vertexIndex - 1];
-        glm::vec2 uv = temp_uvs[uvIndex - 1];
-        glm::vec3 normal = temp_normals[normalIndex - 1];
+    string basePath = string(filepath).substr(0, string(filepath).find_last_of("/"));
+    string mtlPath = basePath + "/" + mtlFilePath;
+    MTLMaterial mat = loadMTL(mtlPath);
+    Material material;
+    material.ka = mat.ka;
+    material.kd = mat.kd;
+    material.ks = mat.ks;
+    material.ke = mat.ke;
+    material.shininess = mat.shininess;
+    geom.materialIndex = materialTable.add(material);
+    geom.textureFilePath = mat.texturePath;
 
-        out_vertices.push_back(vertex);
-        out_uvs.push_back(uv);
-        out_normals.push_back(normal);
+    if (!mat.texturePath.empty())
+    {
+        string fullTexturePath = basePath + "/" + mat.texturePath;
+        geom.mesh.textureID = loadTexture(fullTexturePath);
     }
 
-    file.close();
+    return geom;
+}
 
-    return true;
+void framebufferSizeCallback(GLFWwindow* window, int width, int height)
+{
+    // Runs on the main thread; the render thread applies the viewport from the next snapshot.
+    framebufferWidth = width;
+    framebufferHeight = height;
 }
 
 GLuint setupBackgroundQuad(GLuint& quadVAO, GLuint& quadVBO, const char* texturePath, const char* type)
@@ -1243,19 +1888,8 @@ GLuint setupBackgroundQuad(GLuint& quadVAO, GLuint& quadVBO, const char* texture
             -halfSize, floorHeight, halfSize, 0.0f, repeatFactor
         };
 
-        glGenVertexArrays(1, &quadVAO);
-        glGenBuffers(1, &quadVBO);
-
-        glBindVertexArray(quadVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
-        glBufferData(GL_ARRAY_BUFFER, quadVertices.size() * sizeof(float), quadVertices.data(), GL_STATIC_DRAW);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(1);
-        glBindVertexArray(0);
+        quadVBO = createStaticBuffer(quadVertices.data(), quadVertices.size() * sizeof(float));
+        quadVAO = createVertexArray(quadVBO, 5 * sizeof(float), {{0, 3, 0}, {1, 2, 3 * sizeof(float)}});
 
         textureID = loadTexture(texturePath);
     }
@@ -1270,20 +1904,8 @@ GLuint setupBackgroundQuad(GLuint& quadVAO, GLuint& quadVBO, const char* texture
             1.0f, -1.0f, 1.0f, 0.0f,
             1.0f, 1.0f, 1.0f, 1.0f
         };
-        glGenVertexArrays(1, &quadVAO);
-        glGenBuffers(1, &quadVBO);
-
-        glBindVertexArray(quadVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
-        glBufferData(GL_ARRAY_BUFFER, quadVertices.size() * sizeof(float), quadVertices.data(), GL_STATIC_DRAW);
-
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-        glEnableVertexAttribArray(1);
-
-        glBindVertexArray(0);
+        quadVBO = createStaticBuffer(quadVertices.data(), quadVertices.size() * sizeof(float));
+        quadVAO = createVertexArray(quadVBO, 4 * sizeof(float), {{0, 2, 0}, {1, 2, 2 * sizeof(float)}});
 
         textureID = loadTexture(texturePath);
     }
@@ -1294,6 +1916,7 @@ GLuint setupBackgroundQuad(GLuint& quadVAO, GLuint& quadVBO, const char* texture
 
 int loadTexture(const string& path)
 {
+    PROFILE_SCOPE("loadTexture");
     GLuint texID;
     glGenTextures(1, &texID);
     glBindTexture(GL_TEXTURE_2D, texID);
@@ -1323,51 +1946,6 @@ int loadTexture(const string& path)
     return texID;
 }
 
-Material loadMTL(const string& path)
-{
-    Material mat;
-    ifstream mtlFile(path);
-    if (!mtlFile)
-    {
-        cerr << "Failed to open MTL file: " << path << endl;
-        return mat;
-    }
-
-    string line;
-    while (getline(mtlFile, line))
-    {
-        istringstream iss(line);
-        string keyword;
-        iss >> keyword;
-
-        if (keyword == "map_Kd")
-        {
-            iss >> mat.texturePath;
-        }
-        else if (keyword == "Ka")
-        {
-            iss >> mat.ka.r >> mat.ka.g >> mat.ka.b;
-        }
-        else if (keyword == "Kd")
-        {
-            iss >> mat.kd.r >> mat.kd.g >> mat.kd.b;
-        }
-        else if (keyword == "Ks")
-        {
-            iss >> mat.ks.r >> mat.ks.g >> mat.ks.b;
-        }
-        else if (keyword == "Ke")
-        {
-            iss >> mat.ke.r >> mat.ke.g >> mat.ke.b;
-        }
-        else if (keyword == "Ns")
-        {
-            iss >> mat.shininess;
-        }
-    }
-    return mat;
-}
-
 std::vector<glm::vec3> generateCircleControlPointsSet(int nPoints, float radius, string orientation)
 {
     std::vector<glm::vec3> controlPoints;
@@ -1434,39 +2012,1478 @@ vector<glm::vec3> generateControlPointsSet()
 
 GLuint generateControlPointsBuffer(vector<glm::vec3> controlPoints)
 {
-    GLuint VBO, VAO;
+    GLuint VBO = createStaticBuffer(controlPoints.data(), controlPoints.size() * sizeof(glm::vec3));
+    return createVertexArray(VBO, sizeof(glm::vec3), {{0, 3, 0}});
+}
+
+json jsonReader(string jsonpath)
+{
+    PROFILE_SCOPE("jsonReader");
+    ifstream f(jsonpath);
+    json jsonData = json::parse(f);
+    string json_string = jsonData.dump();
+
+    return jsonData;
+}
+
+void bindFrameUniformBlock(const Shader& shader)
+{
+    GLuint blockIndex = glGetUniformBlockIndex(shader.ID, "FrameData");
+    if (blockIndex != GL_INVALID_INDEX)
+    {
+        glUniformBlockBinding(shader.ID, blockIndex, FRAME_UNIFORMS_BINDING);
+    }
+}
 
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, controlPoints.size() * sizeof(GLfloat) * 3, controlPoints.data(), GL_STATIC_DRAW);
+void setPointLightCount(int count)
+{
+    count = std::clamp(count, 0, MAX_POINT_LIGHTS);
+
+    // Fixed seed so the same count always produces the same light layout.
+    std::mt19937 generator(2025);
+    std::uniform_real_distribution<float> radius(1.0f, 14.0f);
+    std::uniform_real_distribution<float> height(0.0f, 8.0f);
+    std::uniform_real_distribution<float> phase(0.0f, glm::two_pi<float>());
+    std::uniform_real_distribution<float> speed(-0.8f, 0.8f);
+    std::uniform_real_distribution<float> hue(0.0f, 1.0f);
+
+    // Light nodes are only ever added; lights beyond the current count stay idle.
+    while ((int)pointLightNodes.size() < count)
+    {
+        pointLightNodes.push_back(sceneGraph.createNode(lightRigNode, NodeKind::Light, (int)pointLightNodes.size()));
+    }
 
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
+    lightOrbits.resize(count);
+    pointLights.resize(count);
+    for (int i = 0; i < count; ++i)
+    {
+        lightOrbits[i] = {radius(generator), height(generator), phase(generator), speed(generator)};
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)0);
-    glEnableVertexAttribArray(0);
+        float h = hue(generator) * 6.0f;
+        glm::vec3 color = glm::clamp(glm::vec3(fabs(h - 3.0f) - 1.0f, 2.0f - fabs(h - 2.0f), 2.0f - fabs(h - 4.0f)),
+                                     0.0f, 1.0f);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+        pointLights[i].radius = pointLightRadius;
+        pointLights[i].color = color;
+        pointLights[i].intensity = pointLightIntensity;
+    }
 
-    return VAO;
+    previousPointLightPositions.resize(count);
+    updatePointLights();
+    sceneGraph.updateWorldTransforms();
+    readPointLightPositions();
+    for (int i = 0; i < count; ++i)
+    {
+        previousPointLightPositions[i] = pointLights[i].position;
+    }
 }
 
-bool checkSphereAABB(glm::vec3 sphereCenter, float radius, glm::vec3 boxMin, glm::vec3 boxMax)
+void updatePointLights()
 {
-    float x = std::max(boxMin.x, std::min(sphereCenter.x, boxMax.x));
-    float y = std::max(boxMin.y, std::min(sphereCenter.y, boxMax.y));
-    float z = std::max(boxMin.z, std::min(sphereCenter.z, boxMax.z));
+    for (size_t i = 0; i < pointLights.size(); ++i)
+    {
+        const LightOrbit& orbit = lightOrbits[i];
+        float angle = orbit.phase + orbit.speed * (float)simulationTime;
 
-    float distance = glm::length(glm::vec3(x, y, z) - sphereCenter);
-    return distance < radius;
+        previousPointLightPositions[i] = pointLights[i].position;
+        sceneGraph.setLocalPosition(pointLightNodes[i],
+                                    glm::vec3(cos(angle) * orbit.radius, orbit.height, sin(angle) * orbit.radius));
+    }
 }
 
-json jsonReader(string jsonpath)
+void readPointLightPositions()
 {
-    ifstream f(jsonpath);
-    json jsonData = json::parse(f);
-    string json_string = jsonData.dump();
+    for (size_t i = 0; i < pointLights.size(); ++i)
+    {
+        pointLights[i].position = sceneGraph.getWorldPosition(pointLightNodes[i]);
+    }
+}
 
-    return jsonData;
+HoopNodes createHoopNodes(const glm::vec3& position, float scaleFactor)
+{
+    HoopNodes nodes;
+
+    // Colliders are placed in the root's space, which keeps the offsets they were
+    // measured with; the root scale carries any change of the hoop scale to them.
+    nodes.root = sceneGraph.createNode();
+    sceneGraph.setLocalPosition(nodes.root, position);
+    sceneGraph.setLocalScale(nodes.root, glm::vec3(scaleFactor / HOOP_REFERENCE_SCALE));
+
+    nodes.mesh = sceneGraph.createNode(nodes.root, NodeKind::Mesh);
+    sceneGraph.setLocalRotation(nodes.mesh, glm::angleAxis(glm::radians(-90.0f), glm::normalize(objectRotationAxis)));
+    sceneGraph.setLocalScale(nodes.mesh, glm::vec3(HOOP_REFERENCE_SCALE));
+
+    nodes.backboard = sceneGraph.createCollider(nodes.root, glm::vec3(-4.2f, 13.0f, 4.0f), glm::vec3(3.0f, 18.2f, 4.0f));
+    nodes.rim = sceneGraph.createCollider(nodes.root, glm::vec3(-0.2f, 13.5f, 7.0f), glm::vec3(0.2f, 13.5f, 7.0f));
+    nodes.scoreZone = sceneGraph.createCollider(nodes.root, glm::vec3(-1.0f, 15.0f, 3.0f),
+                                                glm::vec3(-0.9f, 15.0f, 3.2f));
+    nodes.pole = sceneGraph.createCollider(nodes.root, glm::vec3(-1.0f, 0.0f, 3.0f), glm::vec3(1.0f, 13.0f, 3.1f));
+
+    return nodes;
+}
+
+HoopColliders getHoopColliders(const HoopNodes& nodes)
+{
+    HoopColliders colliders;
+    sceneGraph.getColliderBounds(nodes.backboard, colliders.backboardMin, colliders.backboardMax);
+    sceneGraph.getColliderBounds(nodes.rim, colliders.rimMin, colliders.rimMax);
+    sceneGraph.getColliderBounds(nodes.scoreZone, colliders.scoreZoneMin, colliders.scoreZoneMax);
+    sceneGraph.getColliderBounds(nodes.pole, colliders.poleMin, colliders.poleMax);
+    colliders.hoopCenter = (colliders.scoreZoneMin + colliders.scoreZoneMax) * 0.5f;
+    return colliders;
+}
+
+Entity createMeshEntity(const Geometry& geometry, const glm::vec3& position, float scaleFactor)
+{
+    Entity entity = world.create(TRANSFORM | MATRIX_CACHE | MESH | MATERIAL);
+    world.getPosition(entity) = position;
+    world.getPreviousPosition(entity) = position;
+    world.getScale(entity) = glm::vec3(scaleFactor);
+    world.getMesh(entity) = geometry.mesh;
+    world.getMaterial(entity) = geometry.materialIndex;
+    return entity;
+}
+
+bool isBallInFlight()
+{
+    return world.has(ballEntity, RIGID_BODY) || world.has(ballEntity, CURVE_FOLLOWER);
+}
+
+glm::vec3 getBallHandPosition()
+{
+    return camera.Position + camera.Front * 2.0f + camera.Up * -0.5f;
+}
+
+void stepSimulation(float dt, Hermite& hermite, const HoopColliders& hoop)
+{
+    storePreviousTransforms(world);
+    simulationTime += dt;
+    updatePointLights();
+
+    // --- Flash effect ---
+    if (flashScreen)
+    {
+        flashTimer += dt;
+
+        if (flashTimer > flashDuration)
+        {
+            flashScreen = false;
+        }
+    }
+
+    // --- Selected ball rotation ---
+    if (currentScene == SELECTION_SCENE)
+    {
+        glm::quat rotation = glm::angleAxis(glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+        for (size_t i = 0; i < selectionBalls.size(); ++i)
+        {
+            world.getRotation(selectionBalls[i]) = rotation;
+        }
+
+        if (rotateX || rotateY || rotateZ)
+        {
+            glm::vec3 axis = rotateX ? glm::vec3(1.0f, 0.0f, 0.0f)
+                             : rotateY ? glm::vec3(0.0f, 1.0f, 0.0f)
+                             : glm::vec3(0.0f, 0.0f, 1.0f);
+            world.getRotation(selectionBalls[indexObject]) = rotation * glm::angleAxis((float)simulationTime, axis);
+        }
+    }
+
+    // --- Ball launch ---
+    if (currentScene == GAMEPLAY_SCENE && !isBallInFlight())
+    {
+        glm::vec3 handPosition = getBallHandPosition();
+
+        if (pendingThrow == BallThrow::Straight)
+        {
+            glm::vec3 launchDir = glm::normalize(camera.Front + camera.Up * 0.25f);
+
+            world.addComponents(ballEntity, RIGID_BODY);
+            world.getRigidBody(ballEntity).velocity = launchDir * launchBallSpeed;
+            world.getRigidBody(ballEntity).radius = ballRadius;
+            world.getPreviousPosition(ballEntity) = handPosition;
+        }
+        else if (pendingThrow == BallThrow::Bezier)
+        {
+            glm::vec3 p0 = handPosition;
+            glm::vec3 p2 = hoop.hoopCenter;
+            glm::vec3 p1 = (p0 + p2) * 0.5f + glm::vec3(0.0f, 8.0f, 0.0f);
+
+            bezierCurvePoints.clear();
+            for (int i = 0; i <= 30; ++i)
+            {
+                float t = i / 30.0f;
+                glm::vec3 point =
+                    (1 - t) * (1 - t) * p0 +
+                    2 * (1 - t) * t * p1 +
+                    t * t * p2;
+                bezierCurvePoints.push_back(point);
+            }
+
+            world.addComponents(ballEntity, CURVE_FOLLOWER);
+            world.getCurveFollower(ballEntity) = {0.0f, bezierSpeed, 1.0f, false};
+            world.getPreviousPosition(ballEntity) = p0;
+        }
+        else
+        {
+            // Held in front of the camera until thrown.
+            world.getRotation(ballEntity) = glm::quat_cast(glm::inverse(glm::mat3(camera.GetViewMatrix())));
+        }
+
+        world.getPosition(ballEntity) = handPosition;
+        pendingThrow = BallThrow::None;
+    }
+
+    // --- Systems ---
+    advanceCurveFollowers(world, dt);
+    integrateRigidBodies(world, GRAVITY, dt);
+
+    // --- Score number animation ---
+    if (world.isAlive(numberEntity))
+    {
+        glm::vec3 numberPosition = getInterpolatedCurvePoint(hermite, world.getCurveFollower(numberEntity).position);
+        world.getPosition(numberEntity) = numberPosition;
+        world.getRotation(numberEntity) = getNumberRotation(numberPosition);
+    }
+
+    if (currentScene == GAMEPLAY_SCENE && isBallInFlight())
+    {
+        stepBall(dt, hoop);
+    }
+}
+
+void stepBall(float dt, const HoopColliders& hoop)
+{
+    world.getRotation(ballEntity) = glm::angleAxis((float)simulationTime * 5, glm::vec3(-1.0f, 0.0f, 0.0f));
+
+    // --- Bezier flight ---
+    if (world.has(ballEntity, CURVE_FOLLOWER))
+    {
+        const CurveFollower& follower = world.getCurveFollower(ballEntity);
+
+        if (follower.isFinished())
+        {
+            glm::vec3 pA = bezierCurvePoints[bezierCurvePoints.size() - 2];
+            glm::vec3 pB = bezierCurvePoints.back();
+            glm::vec3 finalBezierDirection = glm::normalize(pB - pA);
+
+            world.removeComponents(ballEntity, CURVE_FOLLOWER);
+            world.addComponents(ballEntity, RIGID_BODY);
+            world.getRigidBody(ballEntity).velocity = finalBezierDirection * launchBallSpeed * 0.6f;
+            world.getRigidBody(ballEntity).radius = ballRadius;
+        }
+        else
+        {
+            int totalPoints = bezierCurvePoints.size();
+            float indexF = follower.position * (totalPoints - 1);
+            int idx = (int)indexF;
+            float frac = indexF - idx;
+
+            if (idx < totalPoints - 1)
+            {
+                world.getPosition(ballEntity) = glm::mix(bezierCurvePoints[idx], bezierCurvePoints[idx + 1], frac);
+            }
+        }
+        return;
+    }
+
+    // --- Ball physics ---
+    glm::vec3& ballPosition = world.getPosition(ballEntity);
+    RigidBody& body = world.getRigidBody(ballEntity);
+
+    if (!alreadyScored &&
+        checkSphereAABB(ballPosition, body.radius, hoop.scoreZoneMin, hoop.scoreZoneMax) &&
+        body.velocity.y < 0.0f)
+    {
+        score++;
+        alreadyScored = true;
+        ballSoftened = true;
+        softenTimer = 0.0f;
+        std::cout << "Hoop! Score: " << score << std::endl;
+        celebrationVersion++;
+
+        // Every third basket is celebrated with a flash.
+        if (score % 3 == 0)
+        {
+            flashScreen = true;
+            flashTimer = 0.0f;
+        }
+    }
+
+    if (alreadyScored &&
+        !checkSphereAABB(ballPosition, body.radius, hoop.scoreZoneMin, hoop.scoreZoneMax))
+    {
+        alreadyScored = false;
+    }
+
+    if (ballSoftened)
+    {
+        // Used to halve the velocity once per rendered frame; keep that decay at 60 Hz.
+        softenTimer += dt;
+        body.velocity *= pow(0.5f, dt * 60.0f);
+
+        if (softenTimer >= softenDuration)
+        {
+            ballSoftened = false;
+        }
+    }
+
+    if (checkSphereAABB(ballPosition, body.radius, hoop.backboardMin, hoop.backboardMax) ||
+        checkSphereAABB(ballPosition, body.radius, hoop.rimMin, hoop.rimMax) ||
+        checkSphereAABB(ballPosition, body.radius, hoop.poleMin, hoop.poleMax))
+    {
+        glm::vec3 normal = glm::vec3(0.0f, 0.0f, 1.0f);
+        body.velocity = body.velocity - 2.0f * glm::dot(body.velocity, normal) * normal;
+        body.velocity *= 0.7f;
+        ballPosition += normal * 0.03f;
+        std::cout << "Colision\n";
+    }
+
+    if (ballPosition.y < ballGroundY)
+    {
+        ballPosition.y = ballGroundY;
+        body.velocity.y *= -0.6f;
+        body.velocity.x *= 0.95f;
+        body.velocity.z *= 0.95f;
+
+        if (glm::length(body.velocity) < 10.5f)
+        {
+            // Leaving the rigid body archetype invalidates ballPosition and body.
+            glm::vec3 handPosition = getBallHandPosition();
+            world.removeComponents(ballEntity, RIGID_BODY);
+            world.getPosition(ballEntity) = handPosition;
+            world.getPreviousPosition(ballEntity) = handPosition;
+        }
+    }
+}
+
+void runEntityBenchmark()
+{
+    World benchmarkWorld;
+    benchmarkWorld.reserve(TRANSFORM | RIGID_BODY, ENTITY_BENCHMARK_COUNT);
+    for (size_t i = 0; i < ENTITY_BENCHMARK_COUNT; ++i)
+    {
+        Entity entity = benchmarkWorld.create(TRANSFORM | RIGID_BODY);
+        benchmarkWorld.getPosition(entity) = glm::vec3((float)(i % 100), 0.0f, (float)(i / 100 % 100));
+        benchmarkWorld.getRigidBody(entity).velocity = glm::vec3(1.0f, 10.0f, 0.5f);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int update = 0; update < ENTITY_BENCHMARK_UPDATES; ++update)
+    {
+        storePreviousTransforms(benchmarkWorld);
+        integrateRigidBodies(benchmarkWorld, GRAVITY, 1.0f / 60.0f);
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    // Bytes read and written per entity: position and rotation copied to the
+    // previous columns, then position and rigid body updated in place.
+    double bytesPerEntity = 2.0 * (sizeof(glm::vec3) + sizeof(glm::quat)) + 2.0 * (sizeof(glm::vec3) + sizeof(RigidBody));
+    double milliseconds = elapsed.count() / ENTITY_BENCHMARK_UPDATES;
+    double gigabytesPerSecond = bytesPerEntity * ENTITY_BENCHMARK_COUNT / (milliseconds * 1.0e6);
+
+    cout << "Entity update: " << ENTITY_BENCHMARK_COUNT << " entities, " << milliseconds << " ms per step, "
+         << gigabytesPerSecond << " GB/s" << endl;
+}
+
+void runParticleBenchmark(RenderResources& resources)
+{
+    ParticlePrograms& programs = *resources.particlePrograms;
+    const float dt = 1.0f / 60.0f;
+    GLuint timeQuery;
+    glGenQueries(1, &timeQuery);
+    std::ios::fmtflags flags = cout.flags();
+    std::streamsize precision = cout.precision();
+
+    cout << "Particle update, " << PARTICLE_BENCHMARK_STEPS << " steps of one burst (GPU time for the GPU backends):"
+        << endl;
+    cout << "  particles  backend              ms/step  ns/particle    alive  reference" << endl;
+    for (int count : PARTICLE_BENCHMARK_COUNTS)
+    {
+        ParticleBurst burst;
+        burst.origin = glm::vec3(0.0f, 2.0f, 0.0f);
+        burst.seed = 1234;
+        burst.count = count;
+
+        // Every backend should end with as many live particles as the reference.
+        ParticleSimulation reference(count);
+        reference.emit(particleSettings, burst);
+        for (int step = 0; step < PARTICLE_BENCHMARK_STEPS; ++step)
+        {
+            reference.update(particleSettings, dt);
+        }
+
+        for (ParticleBackend backend : {ParticleBackend::Compute, ParticleBackend::TransformFeedback,
+                                        ParticleBackend::CPU})
+        {
+            if (!programs.supports(backend))
+            {
+                continue;
+            }
+
+            ParticleSystem system(backend, count, particleSettings, &programs, resources.frameRing);
+            system.emit(burst);
+            system.update(dt);
+            glFinish();
+
+            auto start = std::chrono::steady_clock::now();
+            glBeginQuery(GL_TIME_ELAPSED, timeQuery);
+            for (int step = 0; step < PARTICLE_BENCHMARK_STEPS; ++step)
+            {
+                system.update(dt);
+            }
+            glEndQuery(GL_TIME_ELAPSED);
+            glFinish();
+            std::chrono::duration<double, std::milli> cpuTime = std::chrono::steady_clock::now() - start;
+
+            GLuint64 gpuNanoseconds = 0;
+            glGetQueryObjectui64v(timeQuery, GL_QUERY_RESULT, &gpuNanoseconds);
+            double milliseconds = backend == ParticleBackend::CPU ? cpuTime.count() : gpuNanoseconds / 1.0e6;
+            milliseconds /= PARTICLE_BENCHMARK_STEPS;
+
+            cout << "  " << std::setw(9) << count << "  " << std::left << std::setw(18)
+                << getParticleBackendName(backend) << std::right << std::fixed << std::setprecision(3)
+                << std::setw(9) << milliseconds << std::setw(13) << milliseconds * 1.0e6 / count
+                << std::setw(9) << system.readCount() << std::setw(11) << reference.getCount() << endl;
+        }
+    }
+
+    cout.flags(flags);
+    cout.precision(precision);
+    glDeleteQueries(1, &timeQuery);
+}
+
+void applyTimingMode()
+{
+    double rate = batteryMode ? batterySimulationRate : simulationRate;
+    double renderRate = batteryMode ? batteryRenderRateLimit : renderRateLimit;
+
+    // The render rate and vsync travel to the render thread with the next snapshot.
+    simulationClock.setStep(1.0 / rate);
+
+    cout << "Simulation: " << rate << " Hz, render limit: ";
+    if (renderRate > 0.0)
+    {
+        cout << renderRate << " Hz";
+    }
+    else
+    {
+        cout << "uncapped";
+    }
+    cout << (vsync ? " (vsync)" : "") << (batteryMode ? " [battery mode]" : "") << endl;
+}
+
+glm::vec3 getInterpolatedCurvePoint(Curve& curve, float position)
+{
+    int nbPoints = curve.getNbCurvePoints();
+    position = fmod(position, (float)nbPoints);
+
+    int index = (int)position;
+    float frac = position - index;
+
+    return glm::mix(curve.getPointOnCurve(index), curve.getPointOnCurve((index + 1) % nbPoints), frac);
+}
+
+DrawItem makeDrawItem(const MeshRef& mesh, MaterialIndex materialIndex)
+{
+    DrawItem item;
+    item.VAO = mesh.VAO;
+    item.vertexCount = mesh.vertexCount;
+    item.textureID = mesh.textureID;
+    item.boundsCenter = mesh.boundsCenter;
+    item.boundsRadius = mesh.boundsRadius;
+    item.materialIndex = materialIndex;
+    return item;
+}
+
+glm::quat getNumberRotation(glm::vec3 numberPosition)
+{
+    glm::vec3 center = glm::vec3(0.0f, numberPosition.y, 0.0f);
+    glm::vec3 dirToCenter = glm::normalize(center - numberPosition);
+    float angle = atan2(dirToCenter.x, dirToCenter.z);
+
+    // The text faces +Z, so this turns it towards the center of the circle.
+    return glm::angleAxis(angle, glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+void buildFrameSnapshot(FrameSnapshot& snapshot, const HoopColliders& hoop)
+{
+    snapshot.previousCameraPosition = camera.PreviousPosition;
+    snapshot.cameraPosition = camera.Position;
+    snapshot.cameraFront = camera.Front;
+    snapshot.cameraUp = camera.Up;
+    snapshot.framebufferWidth = framebufferWidth;
+    snapshot.framebufferHeight = framebufferHeight;
+
+    snapshot.objects.clear();
+    world.forEach(MESH | MATERIAL, [&](Archetype& archetype)
+    {
+        for (size_t row = 0; row < archetype.size(); ++row)
+        {
+            DrawItem item = makeDrawItem(archetype.meshes[row], archetype.materials[row]);
+            if (item.vertexCount == 0)
+            {
+                continue;
+            }
+
+            if (archetype.mask & SCENE_NODE)
+            {
+                // Static meshes attached to the scene graph reuse its cached world matrices.
+                NodeId node = archetype.sceneNodes[row];
+                item.isStatic = true;
+                item.interpolated = false;
+                item.model = sceneGraph.getWorldMatrix(node);
+                item.normalMatrix = sceneGraph.getNormalMatrix(node);
+                snapshot.objects.push_back(item);
+                continue;
+            }
+
+            InterpolatedTransform& transform = item.transform;
+            transform.previousPosition = archetype.previousPositions[row];
+            transform.position = archetype.positions[row];
+            transform.previousRotation = archetype.previousRotations[row];
+            transform.rotation = archetype.rotations[row];
+            transform.scale = archetype.scales[row];
+
+            // Objects that stay put reuse the matrices cached in their transform.
+            if (!transform.isMoving() && (archetype.mask & MATRIX_CACHE))
+            {
+                Transform& cache = archetype.matrixCaches[row];
+                cache.setPosition(transform.position);
+                cache.setRotation(transform.rotation);
+                cache.setScale(transform.scale);
+
+                item.interpolated = false;
+                item.model = cache.getWorldMatrix();
+                item.normalMatrix = cache.getNormalMatrix();
+            }
+
+            snapshot.objects.push_back(item);
+        }
+    });
+
+    // Front to back, so the depth test rejects hidden fragments before they are shaded.
+    std::sort(snapshot.objects.begin(), snapshot.objects.end(), [](const DrawItem& a, const DrawItem& b)
+    {
+        return glm::dot(a.getPosition() - camera.Position, camera.Front) <
+            glm::dot(b.getPosition() - camera.Position, camera.Front);
+    });
+
+    snapshot.drawScore = world.isAlive(numberEntity);
+    snapshot.score = score;
+    snapshot.scoreColor = scoreColor;
+    if (snapshot.drawScore)
+    {
+        snapshot.scoreTransform.previousPosition = world.getPreviousPosition(numberEntity);
+        snapshot.scoreTransform.position = world.getPosition(numberEntity);
+        snapshot.scoreTransform.previousRotation = world.getPreviousRotation(numberEntity);
+        snapshot.scoreTransform.rotation = world.getRotation(numberEntity);
+        snapshot.scoreTransform.scale = world.getScale(numberEntity);
+    }
+
+    if (world.isAlive(ballEntity))
+    {
+        snapshot.previousBallPosition = world.getPreviousPosition(ballEntity);
+        snapshot.ballPosition = world.getPosition(ballEntity);
+    }
+    snapshot.hoopCenter = hoop.hoopCenter;
+    snapshot.showParametricCurves = showParametricCurves;
+
+    snapshot.flashScreen = flashScreen;
+    snapshot.flashTimer = flashTimer;
+
+    snapshot.perVertexNormalMatrix = perVertexNormalMatrix;
+    snapshot.depthPrePass = depthPrePass;
+    snapshot.showOverdraw = showOverdraw;
+    snapshot.showHUD = showHUD;
+    snapshot.dynamicResolution = dynamicResolution;
+    snapshot.capturing = capturing;
+    snapshot.profileReportVersion = profileReportVersion;
+    snapshot.celebrationVersion = celebrationVersion;
+    snapshot.particleBenchmarkVersion = particleBenchmarkVersion;
+
+    snapshot.shadowSettings = shadowSettings;
+    snapshot.staticShadowVersion = staticShadowVersion;
+
+    snapshot.pointLights = pointLights;
+    snapshot.previousPointLightPositions = previousPointLightPositions;
+
+    snapshot.renderRateLimit = batteryMode ? batteryRenderRateLimit : renderRateLimit;
+    snapshot.vsync = vsync;
+}
+
+void renderFrame(RenderResources& resources, const FrameSnapshot& snapshot, float alpha)
+{
+    RingBuffer& frameRing = *resources.frameRing;
+    Shader& shader = *resources.shader;
+    Shader& curvesShader = *resources.curvesShader;
+    GPUProfiler& profiler = *resources.gpuProfiler;
+
+    RenderStats& stats = resources.renderStats;
+    CommandBuffer& commands = resources.commands;
+
+    frameRing.beginFrame();
+    profiler.beginFrame();
+    profiler.beginPass("frame");
+    stats = RenderStats();
+    commands.reset();
+    resources.submittedCommands = 0;
+    resources.pendingPrograms.poll();
+
+    // --- Dynamic resolution ---
+    // Below full scale the scene goes into a smaller target, upscaled before the HUD.
+    updateResolutionGovernor(resources, snapshot);
+    const QualityLevel& quality = resources.quality;
+    int renderWidth = snapshot.framebufferWidth;
+    int renderHeight = snapshot.framebufferHeight;
+    bool scaled = quality.resolutionScale < 1.0f;
+    GLuint renderFramebuffer = resources.outputFramebuffer;
+    if (scaled)
+    {
+        renderWidth = std::max((int)(snapshot.framebufferWidth * quality.resolutionScale), 1);
+        renderHeight = std::max((int)(snapshot.framebufferHeight * quality.resolutionScale), 1);
+        resources.sceneTarget->resize(renderWidth, renderHeight);
+        resources.sceneTarget->bind(commands);
+        renderFramebuffer = resources.sceneTarget->getFramebuffer();
+    }
+    else
+    {
+        commands.viewport(0, 0, renderWidth, renderHeight);
+    }
+
+    glm::vec4 clearColor = glm::vec4(0.1f, 0.1f, 0.1f, 1.0f);
+    if (snapshot.flashScreen && fmod(snapshot.flashTimer * 10.0f, 2.0f) < 1.0f)
+    {
+        clearColor = glm::vec4(1.0f);
+    }
+    commands.clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT, clearColor);
+    commands.lineWidth(10.0f);
+    commands.pointSize(20.0f);
+
+    glm::vec3 cameraPosition = glm::mix(snapshot.previousCameraPosition, snapshot.cameraPosition, alpha);
+    glm::mat4 view = glm::lookAt(cameraPosition, cameraPosition + snapshot.cameraFront, snapshot.cameraUp);
+    float aspect = (float)snapshot.framebufferWidth / (float)std::max(snapshot.framebufferHeight, 1);
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
+
+    FrameUniforms frameUniforms = {view, projection};
+    RingAllocation frameUniformsAllocation = frameRing.upload(&frameUniforms, sizeof(FrameUniforms),
+                                                              frameRing.getUniformAlignment());
+    if (frameUniformsAllocation.valid())
+    {
+        commands.bindBufferRange(GL_UNIFORM_BUFFER, FRAME_UNIFORMS_BINDING, frameUniformsAllocation.buffer,
+                                 frameUniformsAllocation.offset, sizeof(FrameUniforms));
+    }
+    resources.materialTable->bind(commands);
+    submitCommands(resources);
+
+    // --- Impostor fades ---
+    // Atlases are baked the first time a mesh is far enough away to need one. Until
+    // the impostor programs are ready every mesh keeps a fade of zero, drawn in full.
+    ImpostorRenderer* impostors = resources.impostorRenderer;
+    std::vector<float>& impostorFades = resources.impostorFades;
+    impostorFades.assign(snapshot.objects.size(), 0.0f);
+    bool drawImpostors = false;
+    float projectionScale = renderHeight / (2.0f * std::tan(glm::radians(45.0f) * 0.5f));
+    for (size_t i = 0; impostors && i < snapshot.objects.size(); ++i)
+    {
+        const DrawItem& item = snapshot.objects[i];
+        glm::mat4 model = item.getModelMatrix(alpha);
+        float scale = std::max({glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])),
+                                glm::length(glm::vec3(model[2]))});
+        glm::vec3 center = glm::vec3(model * glm::vec4(item.boundsCenter, 1.0f));
+        impostorFades[i] = impostors->getFade(glm::distance(center, cameraPosition), item.boundsRadius * scale,
+                                              projectionScale);
+        drawImpostors = drawImpostors || impostorFades[i] > 0.0f;
+    }
+    if (drawImpostors)
+    {
+        auto bakeStart = std::chrono::steady_clock::now();
+        int baked = impostors->prepare(snapshot.objects, impostorFades, commands, renderFramebuffer, renderWidth,
+                                       renderHeight);
+        submitCommands(resources);
+        if (baked > 0)
+        {
+            std::chrono::duration<double, std::milli> bakeTime = std::chrono::steady_clock::now() - bakeStart;
+            cout << "Impostor atlases baked: " << baked << " (" << bakeTime.count() << " ms, "
+                << impostors->getAtlasCount() << " cached)" << endl;
+        }
+    }
+
+    // --- Clustered lights ---
+    if (resources.lightClusters)
+    {
+        profiler.beginPass("lights");
+        resources.frameLights = snapshot.pointLights;
+        for (size_t i = 0; i < resources.frameLights.size(); ++i)
+        {
+            resources.frameLights[i].position =
+                glm::mix(snapshot.previousPointLightPositions[i], snapshot.pointLights[i].position, alpha);
+        }
+
+        auto buildStart = std::chrono::steady_clock::now();
+        resources.lightClusters->build(resources.frameLights, view, glm::radians(45.0f), aspect, 0.1f, 100.0f);
+        std::chrono::duration<double, std::milli> buildTime = std::chrono::steady_clock::now() - buildStart;
+
+        resources.lightClusters->upload(frameRing, renderWidth, renderHeight, commands);
+        submitCommands(resources);
+
+        LightingBenchmark& benchmark = resources.lightingBenchmark;
+        if (benchmark.lightCount != resources.lightClusters->getLightCount())
+        {
+            benchmark = LightingBenchmark();
+            benchmark.lightCount = resources.lightClusters->getLightCount();
+        }
+        if (benchmark.frames < BENCHMARK_FRAMES)
+        {
+            benchmark.buildMilliseconds += buildTime.count();
+            benchmark.lightIndices += resources.lightClusters->getIndexCount();
+            benchmark.frames++;
+        }
+        profiler.endPass();
+    }
+
+    // --- Shadows ---
+    profiler.beginPass("shadows");
+    ShadowMap& shadowMap = *resources.shadowMap;
+    ShadowSettings shadowSettings = snapshot.shadowSettings;
+    shadowSettings.resolution = std::max(shadowSettings.resolution >> quality.shadowResolutionShift,
+                                         std::min(shadowSettings.resolution, 256));
+    if (shadowMap.update(shadowSettings, snapshot.staticShadowVersion))
+    {
+        drawShadowCasters(shadowMap, ShadowMap::STATIC_LAYER, resources, snapshot, alpha, renderFramebuffer,
+                          renderWidth, renderHeight);
+        cout << "Static shadow casters cached (" << shadowMap.getStaticRebuilds() << " rebuilds)" << endl;
+    }
+    if (shadowMap.isEnabled())
+    {
+        drawShadowCasters(shadowMap, ShadowMap::DYNAMIC_LAYER, resources, snapshot, alpha, renderFramebuffer,
+                          renderWidth, renderHeight);
+    }
+    shadowMap.upload(frameRing, commands);
+    submitCommands(resources);
+    profiler.endPass();
+
+    glm::mat4 modelFloor = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+
+    // --- Depth pre-pass ---
+    // With the final depth already in place, the shading passes below only pass
+    // the depth test, and run the fragment shader, for visible fragments.
+    if (snapshot.depthPrePass)
+    {
+        profiler.beginPass("depth prepass");
+        drawDepthPrePass(resources, snapshot, alpha, modelFloor);
+        profiler.endPass();
+        commands.depthFunc(GL_LEQUAL);
+        commands.depthMask(false);
+    }
+
+    if (snapshot.showOverdraw)
+    {
+        commands.enable(GL_STENCIL_TEST);
+        commands.stencilFunc(GL_ALWAYS, 0, 0xFF);
+        commands.stencilOp(GL_KEEP, GL_KEEP, GL_INCR);
+    }
+
+    // --- Scene objects ---
+    reportVertexStageBenchmark(resources.vertexStageBenchmark, profiler, snapshot.perVertexNormalMatrix);
+    profiler.beginPass("objects");
+    commands.useProgram(shader.ID);
+    commands.setUniform(resources.cameraPosLoc, cameraPosition);
+    commands.setUniform(resources.perVertexNormalMatrixLoc, (int)snapshot.perVertexNormalMatrix);
+    commands.bindSampler(0, resources.textureSampler);
+
+    for (size_t i = 0; i < snapshot.objects.size(); ++i)
+    {
+        if (impostorFades[i] == 0.0f)
+        {
+            drawObject(commands, resources.modelLoc, resources.normalMatrixLoc, resources.materialIndexLoc,
+                       snapshot.objects[i], alpha);
+        }
+    }
+    submitCommands(resources);
+    profiler.endPass();
+
+    // --- Impostors ---
+    // Meshes left out of the depth pre-pass write their own depth.
+    if (drawImpostors)
+    {
+        profiler.beginPass("impostors");
+        if (snapshot.depthPrePass)
+        {
+            commands.depthMask(true);
+        }
+
+        const FadingObjects& fading = resources.fadingObjects;
+        commands.useProgram(fading.shader->ID);
+        commands.setUniform(fading.cameraPosLoc, cameraPosition);
+        commands.setUniform(fading.perVertexNormalMatrixLoc, (int)snapshot.perVertexNormalMatrix);
+        for (size_t i = 0; i < snapshot.objects.size(); ++i)
+        {
+            if (impostorFades[i] > 0.0f && impostorFades[i] < 1.0f)
+            {
+                commands.setUniform(fading.impostorFadeLoc, impostorFades[i]);
+                drawObject(commands, fading.modelLoc, fading.normalMatrixLoc, fading.materialIndexLoc,
+                           snapshot.objects[i], alpha);
+            }
+        }
+
+        // The atlases carry their own filtering.
+        commands.bindSampler(0, 0);
+        impostors->begin(commands, cameraPosition);
+        for (size_t i = 0; i < snapshot.objects.size(); ++i)
+        {
+            const DrawItem& item = snapshot.objects[i];
+            if (impostorFades[i] > 0.0f)
+            {
+                impostors->draw(commands, item, item.getModelMatrix(alpha), item.getNormalMatrix(alpha),
+                                impostorFades[i]);
+            }
+        }
+        commands.bindVertexArray(0);
+        commands.bindSampler(0, resources.textureSampler);
+
+        if (snapshot.depthPrePass)
+        {
+            commands.depthMask(false);
+        }
+        submitCommands(resources);
+        profiler.endPass();
+    }
+
+    // --- Background Floor ---
+    // Covers most of the screen, so it goes after the objects standing on it.
+    profiler.beginPass("floor");
+    commands.useProgram(resources.backgroundShader->ID);
+    commands.setUniform(resources.modelLocFloor, modelFloor);
+    commands.bindTexture(0, GL_TEXTURE_2D, resources.backgroundTexture);
+    commands.bindVertexArray(resources.backgroundVAO);
+    commands.drawArrays(GL_TRIANGLES, 0, 6);
+    commands.bindVertexArray(0);
+    commands.bindSampler(0, 0);
+    submitCommands(resources);
+    profiler.endPass();
+
+    // --- Background Stars ---
+    // Last and at the far plane: only pixels nothing else covered reach the fragment shader.
+    if (!snapshot.flashScreen)
+    {
+        profiler.beginPass("stars");
+        commands.depthFunc(GL_LEQUAL);
+        commands.depthMask(false);
+        commands.useProgram(resources.backgroundStarsShader->ID);
+        commands.bindTexture(0, GL_TEXTURE_2D, resources.backgroundStarsTexture);
+        commands.bindVertexArray(resources.backgroundStarsVAO);
+        commands.drawArrays(GL_TRIANGLES, 0, 6);
+        commands.bindVertexArray(0);
+        submitCommands(resources);
+        profiler.endPass();
+    }
+
+    // --- Particles ---
+    // Advanced by the snapshot clock, so they keep pace with the simulation.
+    double frameTime = snapshot.stateTime + (alpha - 1.0) * snapshot.step;
+    float particleStep = (float)std::clamp(frameTime - resources.particleTime, 0.0, 0.1);
+    resources.particleTime = frameTime;
+    ParticleSystem& particles = *resources.particleSystem;
+    if (resources.celebrationVersion != snapshot.celebrationVersion)
+    {
+        resources.celebrationVersion = snapshot.celebrationVersion;
+        ParticleBurst burst;
+        burst.origin = snapshot.hoopCenter;
+        burst.seed = hashParticle(snapshot.celebrationVersion);
+        burst.count = particlesPerBasket;
+        particles.emit(burst);
+    }
+    if (particles.isActive())
+    {
+        profiler.beginPass("particles");
+        particles.update(particleStep);
+        commands.depthMask(false);
+        int drawn = particles.draw(commands);
+        submitCommands(resources);
+        // The geometry shader turns every point into two triangles, unseen by the backend.
+        stats.triangles += 2LL * drawn;
+        profiler.endPass();
+    }
+
+    // --- Score ---
+    // Blended over the finished scene: depth tested, but without writing depth.
+    if (snapshot.drawScore)
+    {
+        profiler.beginPass("text");
+        commands.depthMask(false);
+        resources.textRenderer->addWorldText(std::to_string(snapshot.score),
+                                             snapshot.scoreTransform.getModelMatrix(alpha), snapshot.scoreColor);
+        resources.textRenderer->drawWorld(commands);
+        submitCommands(resources);
+        profiler.endPass();
+    }
+
+    commands.depthFunc(GL_LESS);
+    commands.depthMask(true);
+    commands.disable(GL_STENCIL_TEST);
+    commands.disable(GL_DEPTH_TEST);
+
+    // --- Drawing Bezier Curve ---
+    // The curves are a debug overlay, drawn on top of the scene.
+    profiler.beginPass("curves");
+    commands.useProgram(curvesShader.ID);
+
+    glm::vec3 p0 = glm::mix(snapshot.previousBallPosition, snapshot.ballPosition, alpha);
+    glm::vec3 p2 = snapshot.hoopCenter;
+
+    glm::vec3 p1 = (p0 + p2) * 0.5f + glm::vec3(0.0f, 3.0f, 0.0f);
+    {
+        PROFILE_SCOPE("curve generation");
+        std::vector<glm::vec3> controlPoints;
+        controlPoints.push_back(p0);
+        controlPoints.push_back(p1);
+        controlPoints.push_back(p2);
+
+        resources.bezier->setControlPoints(controlPoints);
+        resources.bezier->generateQuadraticCurve(
+            std::max((int)(BEZIER_POINTS_PER_SEGMENT * quality.curveDetail), 4));
+    }
+
+    if (snapshot.showParametricCurves)
+    {
+        resources.bezier->drawCurve(commands, glm::vec4(1, 0, 0, 1));
+    }
+
+    // --- Hermite ---
+    if (snapshot.showParametricCurves)
+    {
+        resources.hermite->drawCurve(commands, glm::vec4(1, 1, 0, 1));
+    }
+    submitCommands(resources);
+    profiler.endPass();
+
+    // --- Overdraw view ---
+    if (snapshot.showOverdraw)
+    {
+        profiler.beginPass("overdraw");
+        drawOverdraw(resources, snapshot, renderWidth, renderHeight);
+        profiler.endPass();
+    }
+    else
+    {
+        resources.overdrawCounter.frames = 0;
+    }
+
+    // --- Upscale ---
+    if (scaled)
+    {
+        profiler.beginPass("upscale");
+        resources.sceneTarget->resolve(commands, resources.outputFramebuffer, snapshot.framebufferWidth,
+                                       snapshot.framebufferHeight);
+        submitCommands(resources);
+        profiler.endPass();
+    }
+
+    // --- Score readout ---
+    // Screen text goes after the upscale, so it stays sharp.
+    if (snapshot.drawScore)
+    {
+        profiler.beginPass("text");
+        string scoreText = "SCORE " + std::to_string(snapshot.score);
+        float textWidth = TextRenderer::getTextWidth(scoreText) * SCORE_READOUT_HEIGHT;
+        resources.textRenderer->addScreenText(scoreText, snapshot.framebufferWidth - textWidth - SCORE_READOUT_HEIGHT,
+                                              SCORE_READOUT_HEIGHT, SCORE_READOUT_HEIGHT, glm::vec4(1.0f));
+        resources.textRenderer->drawScreen(commands, snapshot.framebufferWidth, snapshot.framebufferHeight);
+        submitCommands(resources);
+        profiler.endPass();
+    }
+
+    // --- Performance HUD ---
+    // Shows this frame's statistics, without the HUD's own draw.
+    if (snapshot.showHUD)
+    {
+        profiler.beginPass("hud");
+        stats.uploadedBytes = frameRing.getFrameUsage();
+        const GPUProfiler::PassTimes* framePass = profiler.findPass("frame");
+        resources.perfHUD->draw(commands, stats, framePass ? &framePass->gpu : nullptr, snapshot.framebufferWidth,
+                                snapshot.framebufferHeight);
+        submitCommands(resources);
+        profiler.endPass();
+    }
+
+    commands.enable(GL_DEPTH_TEST);
+
+    // --- Finalizing Frame ---
+    commands.bindVertexArray(0);
+    commands.bindTexture(0, GL_TEXTURE_2D, 0);
+    submitCommands(resources);
+    profiler.endPass();
+    profiler.endFrame();
+    frameRing.endFrame();
+
+    if (resources.profileReportVersion != snapshot.profileReportVersion)
+    {
+        resources.profileReportVersion = snapshot.profileReportVersion;
+        profiler.print(cout);
+    }
+
+    if (resources.particleBenchmarkVersion != snapshot.particleBenchmarkVersion)
+    {
+        resources.particleBenchmarkVersion = snapshot.particleBenchmarkVersion;
+        runParticleBenchmark(resources);
+    }
+}
+
+void drawObject(CommandBuffer& commands, GLint modelLoc, GLint normalMatrixLoc, GLint materialIndexLoc,
+                const DrawItem& item, float alpha)
+{
+    commands.setUniform(modelLoc, item.getModelMatrix(alpha));
+    commands.setUniform(normalMatrixLoc, item.getNormalMatrix(alpha));
+    commands.setUniform(materialIndexLoc, (int)item.materialIndex);
+
+    commands.bindTexture(0, GL_TEXTURE_2D, item.textureID);
+    commands.bindVertexArray(item.VAO);
+    commands.drawArrays(GL_TRIANGLES, 0, item.vertexCount);
+}
+
+void submitCommands(RenderResources& resources)
+{
+    resources.commandBackend->submit(resources.commands, resources.submittedCommands, resources.renderStats);
+    resources.submittedCommands = resources.commands.size();
+}
+
+void drawDepthPrePass(RenderResources& resources, const FrameSnapshot& snapshot, float alpha,
+                      const glm::mat4& modelFloor)
+{
+    const DepthPrePass& prePass = resources.depthPrePass;
+    CommandBuffer& commands = resources.commands;
+    commands.colorMask(false, false, false, false);
+
+    commands.useProgram(prePass.objectShader->ID);
+    for (size_t i = 0; i < snapshot.objects.size(); ++i)
+    {
+        // Fading meshes and impostors only cover part of their pixels, so they lay down their own depth.
+        const DrawItem& item = snapshot.objects[i];
+        if (resources.impostorFades[i] > 0.0f)
+        {
+            continue;
+        }
+        commands.setUniform(prePass.objectModelLoc, item.getModelMatrix(alpha));
+        commands.bindVertexArray(item.VAO);
+        commands.drawArrays(GL_TRIANGLES, 0, item.vertexCount);
+    }
+
+    commands.useProgram(prePass.floorShader->ID);
+    commands.setUniform(prePass.floorModelLoc, modelFloor);
+    commands.bindVertexArray(resources.backgroundVAO);
+    commands.drawArrays(GL_TRIANGLES, 0, 6);
+    commands.bindVertexArray(0);
+    commands.colorMask(true, true, true, true);
+    submitCommands(resources);
+}
+
+void drawOverdraw(RenderResources& resources, const FrameSnapshot& snapshot, int width, int height)
+{
+    // Every fragment that passed the depth test during the shading passes
+    // incremented the stencil value of its pixel.
+    OverdrawCounter& counter = resources.overdrawCounter;
+    if (counter.depthPrePass != snapshot.depthPrePass)
+    {
+        counter.depthPrePass = snapshot.depthPrePass;
+        counter.frames = 0;
+    }
+
+    // The null backend drew nothing to count.
+    if (counter.frames < BENCHMARK_FRAMES && !nullCommandBackend)
+    {
+        if (counter.frames == 0)
+        {
+            counter.fragmentsPerPixel = 0.0;
+            counter.maxFragments = 0;
+        }
+
+        // Reading the stencil back stalls the pipeline; the view is a debugging aid only.
+        size_t pixels = (size_t)width * height;
+        counter.stencil.resize(pixels);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, width, height, GL_STENCIL_INDEX,
+                     GL_UNSIGNED_BYTE, counter.stencil.data());
+
+        long long fragments = 0;
+        for (GLubyte count : counter.stencil)
+        {
+            fragments += count;
+            counter.maxFragments = std::max(counter.maxFragments, (int)count);
+        }
+        counter.fragmentsPerPixel += (double)fragments / std::max(pixels, (size_t)1);
+        counter.frames++;
+
+        if (counter.frames == BENCHMARK_FRAMES)
+        {
+            cout << "Overdraw: " << counter.fragmentsPerPixel / BENCHMARK_FRAMES << " fragments shaded per pixel, "
+                << counter.maxFragments << " max (depth pre-pass: " << (counter.depthPrePass ? "on" : "off") << ")"
+                << endl;
+        }
+    }
+
+    // Heat map: one full screen quad per count, the stencil test picks the pixels it covers.
+    CommandBuffer& commands = resources.commands;
+    commands.enable(GL_STENCIL_TEST);
+    commands.stencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+    commands.useProgram(resources.overdrawShader->ID);
+    commands.bindVertexArray(resources.backgroundStarsVAO);
+    for (int level = 0; level <= OVERDRAW_LEVELS; ++level)
+    {
+        glm::vec3 color(0.0f);
+        if (level > 0)
+        {
+            color = glm::mix(glm::vec3(0.0f, 0.2f, 1.0f), glm::vec3(1.0f, 0.1f, 0.0f),
+                             (float)(level - 1) / (OVERDRAW_LEVELS - 1));
+        }
+
+        // The reference is compared against the stencil value, so LEQUAL selects level and above.
+        commands.stencilFunc(level == OVERDRAW_LEVELS ? GL_LEQUAL : GL_EQUAL, level, 0xFF);
+        commands.setUniform(resources.overdrawColorLoc, glm::vec4(color, 1.0f));
+        commands.drawArrays(GL_TRIANGLES, 0, 6);
+    }
+    commands.bindVertexArray(0);
+    commands.disable(GL_STENCIL_TEST);
+    submitCommands(resources);
+}
+
+void updateResolutionGovernor(RenderResources& resources, const FrameSnapshot& snapshot)
+{
+    ResolutionGovernor& governor = *resources.resolutionGovernor;
+    GPUProfiler& profiler = *resources.gpuProfiler;
+
+    bool changed = false;
+    double gpuMilliseconds = 0.0;
+    if (!snapshot.dynamicResolution)
+    {
+        changed = governor.getLevel() != 0;
+        governor.reset();
+    }
+    else if (profiler.getCollectedFrames() != resources.governorFrames)
+    {
+        // The whole-frame GPU time of the frame the profiler just read back.
+        const GPUProfiler::PassTimes* framePass = profiler.findPass("frame");
+        if (framePass && framePass->gpu.getCount() > 0)
+        {
+            gpuMilliseconds = framePass->gpu.getLatest();
+            changed = governor.update(gpuMilliseconds);
+        }
+    }
+    resources.governorFrames = profiler.getCollectedFrames();
+
+    if (!changed)
+    {
+        return;
+    }
+
+    resources.quality = governor.getQuality();
+    glSamplerParameterf(resources.textureSampler, GL_TEXTURE_LOD_BIAS, resources.quality.textureLodBias);
+    if (snapshot.dynamicResolution)
+    {
+        cout << "Dynamic resolution: level " << governor.getLevel() << "/" << governor.getLevelCount() - 1 << ", "
+            << (int)(resources.quality.resolutionScale * 100.0f + 0.5f) << "% scale after " << gpuMilliseconds
+            << " ms GPU frame (budget " << governor.getSettings().targetMilliseconds << " ms)" << endl;
+    }
+}
+
+void renderThreadMain(RenderResources* resources)
+{
+    PROFILE_THREAD_NAME("render");
+    setRenderContextCurrent(*resources, true);
+
+    FramePacer framePacer;
+    double appliedRenderRate = -1.0;
+    int appliedSwapInterval = -1;
+    auto previousFrameStart = std::chrono::steady_clock::now();
+
+    while (renderThreadRunning)
+    {
+        PROFILE_SCOPE("frame");
+        frameSnapshots.acquire();
+        const FrameSnapshot& snapshot = frameSnapshots.front();
+
+        if (snapshot.renderRateLimit != appliedRenderRate)
+        {
+            appliedRenderRate = snapshot.renderRateLimit;
+            framePacer.setTargetRate(appliedRenderRate);
+        }
+
+        int swapInterval = snapshot.vsync ? 1 : 0;
+        if (resources->window && swapInterval != appliedSwapInterval)
+        {
+            appliedSwapInterval = swapInterval;
+            glfwSwapInterval(swapInterval);
+        }
+
+        auto frameStart = std::chrono::steady_clock::now();
+        std::chrono::duration<double, std::milli> frameInterval = frameStart - previousFrameStart;
+        previousFrameStart = frameStart;
+        {
+            PROFILE_SCOPE("submission");
+            renderFrame(*resources, snapshot, snapshot.getAlpha(glfwGetTime()));
+        }
+        std::chrono::duration<double, std::milli> frameTime = std::chrono::steady_clock::now() - frameStart;
+        resources->perfHUD->addFrame(frameTime.count(), frameInterval.count());
+        if (benchmarkReplay)
+        {
+            resources->benchmarkFrameTimes.push_back(frameTime.count());
+            resources->benchmarkFrameIntervals.push_back(frameInterval.count());
+        }
+
+        LightingBenchmark& benchmark = resources->lightingBenchmark;
+        if (resources->lightClusters && benchmark.frames <= BENCHMARK_FRAMES)
+        {
+            benchmark.frameMilliseconds += frameTime.count();
+            if (benchmark.frames == BENCHMARK_FRAMES)
+            {
+                cout << "Clustered lighting: " << benchmark.lightCount << " lights, "
+                    << benchmark.buildMilliseconds / BENCHMARK_FRAMES << " ms cluster build, "
+                    << benchmark.frameMilliseconds / BENCHMARK_FRAMES << " ms frame CPU, "
+                    << (double)benchmark.lightIndices / BENCHMARK_FRAMES / LightClusters::CLUSTER_COUNT
+                    << " lights per cluster" << endl;
+                benchmark.frames++;
+            }
+        }
+        resources->frameCapture->endFrame(snapshot.capturing, snapshot.framebufferWidth, snapshot.framebufferHeight);
+
+        if (resources->headlessContext)
+        {
+            // Nothing to present; the frame stays in the offscreen framebuffer.
+            glFlush();
+            if (++renderedFrames == headlessFrameCount && !headlessOutputPath.empty())
+            {
+                HeadlessContext& context = *resources->headlessContext;
+                std::vector<unsigned char> pixels;
+                context.readPixels(pixels);
+                saveFramePPM(headlessOutputPath, pixels, context.getWidth(), context.getHeight());
+            }
+        }
+        else
+        {
+            PROFILE_SCOPE("swap");
+            glfwSwapBuffers(resources->window);
+        }
+        PROFILE_SCOPE("frame pacing");
+        framePacer.wait();
+    }
+
+    resources->frameCapture->finish();
+    setRenderContextCurrent(*resources, false);
+}
+
+bool parseCommandLine(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        string argument = argv[i];
+        if (argument == "--headless")
+        {
+            headless = true;
+        }
+        else if (argument == "--frames" && i + 1 < argc)
+        {
+            headlessFrameCount = std::max(1, atoi(argv[++i]));
+        }
+        else if (argument == "--output" && i + 1 < argc)
+        {
+            headlessOutputPath = argv[++i];
+        }
+        else if (argument == "--capture")
+        {
+            capturing = true;
+        }
+        else if (argument == "--profile" && i + 1 < argc)
+        {
+            profileOutputPath = argv[++i];
+        }
+        else if (argument == "--trace" && i + 1 < argc)
+        {
+            traceOutputPath = argv[++i];
+        }
+        else if (argument == "--record" && i + 1 < argc)
+        {
+            inputRecordPath = argv[++i];
+        }
+        else if (argument == "--replay" && i + 1 < argc)
+        {
+            inputReplayPath = argv[++i];
+        }
+        else if (argument == "--benchmark")
+        {
+            benchmarkReplay = true;
+        }
+        else if (argument == "--particle-benchmark")
+        {
+            particleBenchmarkVersion++;
+        }
+        else if (argument == "--null-backend")
+        {
+            nullCommandBackend = true;
+        }
+        else if (argument == "--dump-commands" && i + 1 < argc)
+        {
+            commandDumpPath = argv[++i];
+        }
+        else
+        {
+            cerr << "Unknown argument: " << argument << endl;
+            cerr << "Usage: app [--headless [--frames N] [--output frame.ppm]] [--capture] [--profile passes.csv]"
+                " [--trace trace.json] [--record input.bin | --replay input.bin [--benchmark]] [--particle-benchmark]"
+                " [--null-backend] [--dump-commands commands.bin]" << endl;
+            return false;
+        }
+    }
+
+    if (!inputRecordPath.empty() && !inputReplayPath.empty())
+    {
+        cerr << "--record and --replay cannot be combined" << endl;
+        return false;
+    }
+    if (benchmarkReplay && inputReplayPath.empty())
+    {
+        cerr << "--benchmark needs a recording to --replay" << endl;
+        return false;
+    }
+    // A headless benchmark runs for the length of the replay instead of a frame count.
+    if (benchmarkReplay && headless)
+    {
+        headlessFrameCount = std::numeric_limits<int>::max();
+    }
+    return true;
+}
+
+void setRenderContextCurrent(const RenderResources& resources, bool current)
+{
+    if (resources.headlessContext)
+    {
+        if (current)
+        {
+            resources.headlessContext->makeCurrent();
+        }
+        else
+        {
+            resources.headlessContext->releaseCurrent();
+        }
+    }
+    else
+    {
+        glfwMakeContextCurrent(current ? resources.window : nullptr);
+    }
+}
+
+void saveFramePPM(const string& path, const std::vector<unsigned char>& pixels, int width, int height)
+{
+    ofstream file(path, ios::binary);
+    if (!file)
+    {
+        cerr << "Failed to write frame: " << path << endl;
+        return;
+    }
+
+    // GL rows start at the bottom, PPM rows at the top.
+    file << "P6\n" << width << " " << height << "\n255\n";
+    for (int row = height - 1; row >= 0; --row)
+    {
+        file.write((const char*)&pixels[(size_t)row * width * 3], (std::streamsize)width * 3);
+    }
+    cout << "Frame written to " << path << endl;
+}
+
+ShadowType parseShadowType(const string& name)
+{
+    if (name == "directional")
+    {
+        return ShadowType::Directional;
+    }
+    if (name == "point")
+    {
+        return ShadowType::Point;
+    }
+    return ShadowType::None;
+}
+
+const char* getShadowTypeName(ShadowType type)
+{
+    switch (type)
+    {
+    case ShadowType::Directional:
+        return "directional";
+    case ShadowType::Point:
+        return "point";
+    default:
+        return "none";
+    }
+}
+
+CaptureFormat parseCaptureFormat(const string& name)
+{
+    if (name == "raw")
+    {
+        return CaptureFormat::Raw;
+    }
+    if (name == "pipe")
+    {
+        return CaptureFormat::Pipe;
+    }
+    return CaptureFormat::PPM;
+}
+
+void drawShadowCasters(ShadowMap& shadowMap, ShadowMap::Layer layer, RenderResources& resources,
+                       const FrameSnapshot& snapshot, float alpha, GLuint framebuffer, int width, int height)
+{
+    bool isStatic = layer == ShadowMap::STATIC_LAYER;
+    bool hasCasters = isStatic;
+    for (const DrawItem& item : snapshot.objects)
+    {
+        hasCasters = hasCasters || item.isStatic == isStatic;
+    }
+
+    CommandBuffer& commands = resources.commands;
+    if (!hasCasters)
+    {
+        shadowMap.clearDynamicLayer(commands, framebuffer, width, height);
+        submitCommands(resources);
+        return;
+    }
+
+    for (int pass = 0; pass < shadowMap.getPassCount(); ++pass)
+    {
+        shadowMap.beginPass(layer, pass, commands);
+
+        if (isStatic)
+        {
+            glm::mat4 modelFloor = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+            shadowMap.drawCaster(commands, modelFloor, resources.backgroundVAO, 6);
+        }
+
+        for (const DrawItem& item : snapshot.objects)
+        {
+            if (item.isStatic == isStatic)
+            {
+                shadowMap.drawCaster(commands, item.getModelMatrix(alpha), item.VAO, item.vertexCount);
+            }
+        }
+    }
+
+    shadowMap.endPasses(commands, framebuffer, width, height);
+    submitCommands(resources);
+}
+
+void reportVertexStageBenchmark(VertexStageBenchmark& benchmark, GPUProfiler& profiler, bool perVertexNormalMatrix)
+{
+    // Results still in flight belong to the previous mode and are dropped by the reset.
+    if (benchmark.perVertexNormalMatrix != perVertexNormalMatrix)
+    {
+        benchmark.perVertexNormalMatrix = perVertexNormalMatrix;
+        benchmark.reported = false;
+        profiler.resetPass("objects");
+    }
+
+    const GPUProfiler::PassTimes* pass = profiler.findPass("objects");
+    if (!benchmark.reported && pass && pass->gpu.getCount() >= BENCHMARK_FRAMES)
+    {
+        cout << "Scene object pass: " << pass->gpu.getAverage() << " ms GPU (normal matrix: "
+            << (benchmark.perVertexNormalMatrix ? "per-vertex inverse" : "uniform") << ")" << endl;
+        benchmark.reported = true;
+    }
 }
@@ -0,0 +1,164 @@
+#version 460 core
+
+// Emits and simulates particles for ParticleSystem. The hash, emission and
+// integration steps mirror ParticleSimulation.cpp, the CPU reference.
+layout(local_size_x = 256) in;
+
+struct Particle
+{
+    vec4 positionLife;
+    vec4 velocityLifetime;
+    vec4 color;
+};
+
+// Indirect draw arguments of each particle buffer; count is its number of live particles.
+struct DrawCommand
+{
+    uint count;
+    uint instanceCount;
+    uint first;
+    uint baseInstance;
+};
+
+layout (std430, binding = 3) readonly buffer SourceParticles
+{
+    Particle sourceParticles[];
+};
+
+layout (std430, binding = 4) writeonly buffer DestinationParticles
+{
+    Particle destinationParticles[];
+};
+
+layout (std430, binding = 5) buffer DrawCommands
+{
+    DrawCommand commands[2];
+};
+
+// Emitting appends a burst to the destination; otherwise the source's live
+// particles are moved and the survivors appended to the destination.
+uniform bool emitting;
+uniform uint sourceIndex;
+uniform uint destinationIndex;
+uniform uint capacity;
+
+uniform float dt;
+uniform vec3 gravity;
+uniform float drag;
+uniform float floorHeight;
+uniform float restitution;
+
+uniform vec3 burstOrigin;
+uniform uint burstSeed;
+uniform uint burstCount;
+uniform float cosSpread;
+uniform float minSpeed;
+uniform float maxSpeed;
+uniform float minLifetime;
+uniform float maxLifetime;
+uniform vec4 colorA;
+uniform vec4 colorB;
+
+// Survivors of the work group, appended with one global atomic per group.
+shared uint groupCount;
+shared uint groupBase;
+
+uint hashParticle(uint value)
+{
+    uint state = value * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+float nextRandom(inout uint state)
+{
+    state = hashParticle(state);
+    return float(state >> 8u) * (1.0 / 16777216.0);
+}
+
+Particle makeParticle(uint index)
+{
+    uint state = index * 2654435769u + burstSeed;
+
+    float azimuth = nextRandom(state) * 2.0 * 3.14159265;
+    float cosTheta = 1.0 + (cosSpread - 1.0) * nextRandom(state);
+    float sinTheta = sqrt(max(1.0 - cosTheta * cosTheta, 0.0));
+    float speed = minSpeed + (maxSpeed - minSpeed) * nextRandom(state);
+    float lifetime = minLifetime + (maxLifetime - minLifetime) * nextRandom(state);
+    float colorMix = nextRandom(state);
+
+    vec3 velocity = vec3(sinTheta * cos(azimuth), cosTheta, sinTheta * sin(azimuth)) * speed;
+    Particle particle;
+    particle.positionLife = vec4(burstOrigin, lifetime);
+    particle.velocityLifetime = vec4(velocity, lifetime);
+    particle.color = colorA + (colorB - colorA) * colorMix;
+    return particle;
+}
+
+Particle integrate(Particle particle)
+{
+    float damping = max(1.0 - drag * dt, 0.0);
+    vec3 velocity = (particle.velocityLifetime.xyz + gravity * dt) * damping;
+    vec3 position = particle.positionLife.xyz + velocity * dt;
+
+    if (position.y < floorHeight)
+    {
+        position.y = floorHeight;
+        velocity.y *= -restitution;
+    }
+
+    particle.positionLife = vec4(position, particle.positionLife.w - dt);
+    particle.velocityLifetime.xyz = velocity;
+    return particle;
+}
+
+void main()
+{
+    if (gl_LocalInvocationIndex == 0)
+    {
+        groupCount = 0;
+    }
+    barrier();
+
+    uint index = gl_GlobalInvocationID.x;
+    Particle particle;
+    bool alive;
+    if (emitting)
+    {
+        alive = index < burstCount;
+        if (alive)
+        {
+            particle = makeParticle(index);
+        }
+    }
+    else
+    {
+        alive = index < commands[sourceIndex].count;
+        if (alive)
+        {
+            particle = integrate(sourceParticles[index]);
+            alive = particle.positionLife.w > 0.0;
+        }
+    }
+
+    uint slot = 0;
+    if (alive)
+    {
+        slot = atomicAdd(groupCount, 1u);
+    }
+    barrier();
+
+    if (gl_LocalInvocationIndex == 0 && groupCount > 0)
+    {
+        groupBase = atomicAdd(commands[destinationIndex].count, groupCount);
+        // A burst may not fit; slots past the capacity are dropped.
+        atomicMin(commands[destinationIndex].count, capacity);
+    }
+    barrier();
+
+    slot += groupBase;
+    if (alive && slot < capacity)
+    {
+        destinationParticles[slot] = particle;
+    }
+}
@@ -1,11 +1,15 @@
 #version 460 core
 
 in vec2 TexCoord;
+in vec3 worldPos;
 out vec4 FragColor;
 
 uniform sampler2D backgroundTexture;
 
+// The shadow maps and getShadowVisibility are declared in lighting.glsl.
+
 void main()
 {
     FragColor = texture(backgroundTexture, TexCoord);
+    FragColor.rgb *= getShadowVisibility(worldPos, vec3(0.0, 1.0, 0.0));
 }
\ No newline at end of file
@@ -0,0 +1,6 @@
+#version 460 core
+
+// Depth only: the pre-pass writes no color, so there is nothing to shade.
+void main()
+{
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+#version 460 core
+
+in vec2 TexCoords;
+in vec4 Color;
+
+// Glyph coverage in the red channel.
+uniform sampler2D font;
+
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = vec4(Color.rgb, Color.a * texture(font, TexCoords).r);
+}
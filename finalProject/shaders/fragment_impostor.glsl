@@ -0,0 +1,150 @@
+#version 460 core
+
+// Shades an impostor quad like fragment_shader.glsl shades the mesh, with the
+// albedo, normal and depth read from the views of the atlas closest to the camera.
+in vec3 modelPosition;
+
+// Row of the material table (MaterialTable.h) this draw is shaded with.
+uniform int materialIndex;
+
+uniform vec3 lightPos;
+uniform vec3 lightColor;
+
+uniform vec3 cameraPos;
+
+uniform mat4 model;
+uniform mat3 normalMatrix;
+uniform vec3 boundsCenter;
+uniform float boundsRadius;
+uniform vec3 modelCamera;
+
+// Views per side of the atlas; every view is rendered looking at the bounding
+// sphere from the direction of its octahedral cell center.
+uniform int impostorViews;
+uniform sampler2D impostorAlbedo;
+uniform sampler2D impostorNormals;
+// Share of the pixels drawn here instead of by the fading mesh.
+uniform float impostorFade;
+
+// The lights, the material table and the shadow maps are declared in lighting.glsl.
+
+layout (std140) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+};
+
+out vec4 color;
+
+// Same as ImpostorRenderer::getViewBasis.
+void getViewBasis(vec3 direction, out vec3 right, out vec3 up)
+{
+    vec3 reference = abs(direction.y) > 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(0.0, 1.0, 0.0);
+    right = normalize(cross(reference, direction));
+    up = cross(direction, right);
+}
+
+// Octahedral mapping of the unit sphere onto [-1, 1]^2, with +y at the center.
+vec2 encodeOctahedral(vec3 direction)
+{
+    vec2 p = direction.xz / (abs(direction.x) + abs(direction.y) + abs(direction.z));
+    if (direction.y < 0.0)
+    {
+        p = (1.0 - abs(p.yx)) * vec2(p.x >= 0.0 ? 1.0 : -1.0, p.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return p;
+}
+
+vec3 decodeOctahedral(vec2 p)
+{
+    vec3 direction = vec3(p.x, 1.0 - abs(p.x) - abs(p.y), p.y);
+    float fold = max(-direction.y, 0.0);
+    direction.x += direction.x >= 0.0 ? -fold : fold;
+    direction.z += direction.z >= 0.0 ? -fold : fold;
+    return normalize(direction);
+}
+
+// Projects this fragment into one view of the atlas, as the orthographic bake did.
+vec2 getAtlasCoordinates(ivec2 cell)
+{
+    vec3 right;
+    vec3 up;
+    getViewBasis(decodeOctahedral((vec2(cell) + 0.5) / float(impostorViews) * 2.0 - 1.0), right, up);
+    vec3 offset = modelPosition - boundsCenter;
+    vec2 uv = vec2(dot(offset, right), dot(offset, up)) / boundsRadius * 0.5 + 0.5;
+    return (vec2(cell) + clamp(uv, 0.0, 1.0)) / float(impostorViews);
+}
+
+float getDitherThreshold()
+{
+    const float bayer[16] = float[](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0,
+                                    3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+    ivec2 pixel = ivec2(gl_FragCoord.xy) & 3;
+    return (bayer[pixel.x + pixel.y * 4] + 0.5) / 16.0;
+}
+
+void main()
+{
+    if (getDitherThreshold() >= impostorFade)
+    {
+        discard;
+    }
+
+    // Blend the four views around the camera direction, weighted bilinearly.
+    vec3 cameraDirection = normalize(modelCamera - boundsCenter);
+    vec2 grid = (encodeOctahedral(cameraDirection) * 0.5 + 0.5) * float(impostorViews) - 0.5;
+    ivec2 cell = clamp(ivec2(floor(grid)), ivec2(0), ivec2(impostorViews - 1));
+    vec2 weight = clamp(grid - vec2(cell), 0.0, 1.0);
+
+    vec4 albedo = vec4(0.0);
+    vec4 normalDepth = vec4(0.0);
+    for (int i = 0; i < 4; ++i)
+    {
+        ivec2 corner = ivec2(i & 1, i >> 1);
+        ivec2 neighbor = min(cell + corner, ivec2(impostorViews - 1));
+        float w = (corner.x == 1 ? weight.x : 1.0 - weight.x) * (corner.y == 1 ? weight.y : 1.0 - weight.y);
+        vec2 uv = getAtlasCoordinates(neighbor);
+        albedo += texture(impostorAlbedo, uv) * w;
+        normalDepth += texture(impostorNormals, uv) * w;
+    }
+
+    // Texels outside the silhouette are zero, so coverage is the albedo's alpha
+    // and everything is divided by it to undo the filtering against empty texels.
+    if (albedo.a < 0.5)
+    {
+        discard;
+    }
+    normalDepth /= albedo.a;
+    vec3 texColor = albedo.rgb / albedo.a;
+    vec3 N = normalize(normalMatrix * (normalDepth.xyz * 2.0 - 1.0));
+
+    // The bake's orthographic depth spans 0.5 to 3.5 radii from an eye two radii
+    // out, so this is how far the surface stands out of the quad towards the camera.
+    float height = (1.5 - 3.0 * normalDepth.w) * boundsRadius;
+    vec4 worldPos = model * vec4(modelPosition + cameraDirection * height, 1.0);
+    vec4 viewPos = view * worldPos;
+    vec4 clipPos = projection * viewPos;
+    gl_FragDepth = clipPos.z / clipPos.w * 0.5 + 0.5;
+    // Surface point and view depth, reconstructed from the atlas depth.
+    vec3 fragPos = vec3(worldPos);
+    float viewDepth = -viewPos.z;
+
+    vec3 L = normalize(lightPos - fragPos);
+    vec3 V = normalize(cameraPos - fragPos);
+    vec3 R = reflect(-L, N);
+
+    MaterialData material = materials[materialIndex];
+    vec3 ambient = material.ka * lightColor * texColor;
+    float diff = max(dot(N, L), 0.0);
+    vec3 diffuse = diff * material.kd * lightColor * texColor;
+    vec3 specular = vec3(0.0);
+    if (diff > 0.0)
+    {
+        specular = pow(max(dot(R, V), 0.0), material.shininess) * material.ks * lightColor;
+    }
+    float shadow = getShadowVisibility(fragPos, N);
+    vec3 result = ambient + (diffuse + specular) * shadow +
+                  shadeClusteredLights(fragPos, viewDepth, N, V, texColor, material);
+
+    color = vec4(result, 1.0);
+}
@@ -0,0 +1,17 @@
+#version 460 core
+
+in vec2 texCoord;
+in vec3 modelNormal;
+
+uniform sampler2D colorBuffer;
+
+// The atlas is cleared to zero, so the albedo's alpha marks the texels the mesh
+// covers. The normal's alpha keeps the depth, for the impostor to write.
+layout (location = 0) out vec4 albedo;
+layout (location = 1) out vec4 normalDepth;
+
+void main()
+{
+    albedo = vec4(texture(colorBuffer, texCoord).rgb, 1.0);
+    normalDepth = vec4(normalize(modelNormal) * 0.5 + 0.5, gl_FragCoord.z);
+}
@@ -0,0 +1,18 @@
+#version 460 core
+
+in vec2 Corner;
+in vec4 Color;
+
+out vec4 FragColor;
+
+void main()
+{
+    // Round sprite with a soft edge, premultiplied for additive blending.
+    float radius = dot(Corner, Corner);
+    if (radius >= 1.0)
+    {
+        discard;
+    }
+    float alpha = Color.a * (1.0 - radius);
+    FragColor = vec4(Color.rgb * alpha, alpha);
+}
@@ -3,11 +3,10 @@
 in vec3 fragNormal;
 in vec3 fragPos;
 in vec2 texCoord;
+in float viewDepth;
 
-uniform vec3 ka;
-uniform vec3 kd;
-uniform vec3 ks;
-uniform float q;
+// Row of the material table (MaterialTable.h) this draw is shaded with.
+uniform int materialIndex;
 
 uniform vec3 lightPos;
 uniform vec3 lightColor;
@@ -16,10 +15,33 @@ uniform vec3 cameraPos;
 
 uniform sampler2D colorBuffer;
 
+// The lights, the material table and the shadow maps are declared in lighting.glsl.
+
+#ifdef IMPOSTOR_FADE
+// Share of the pixels handed over to the mesh's impostor, which draws exactly the
+// complementary part of the same 4x4 ordered dither pattern.
+uniform float impostorFade;
+
+float getDitherThreshold()
+{
+    const float bayer[16] = float[](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0,
+                                    3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+    ivec2 pixel = ivec2(gl_FragCoord.xy) & 3;
+    return (bayer[pixel.x + pixel.y * 4] + 0.5) / 16.0;
+}
+#endif
+
 out vec4 color;
 
 void main()
 {
+#ifdef IMPOSTOR_FADE
+    if (getDitherThreshold() < impostorFade)
+    {
+        discard;
+    }
+#endif
+
     vec3 N = normalize(fragNormal);
     vec3 L = normalize(lightPos - fragPos);
     vec3 V = normalize(cameraPos - fragPos);
@@ -29,20 +51,23 @@ void main()
     float attenuation = 1.0 / (1.0 + 0.09 * distance + 0.032 * distance * distance);
     vec3 texColor = texture(colorBuffer, texCoord).rgb;
 
-    vec3 ambient = ka * lightColor * texColor;// * 0.05;
+    MaterialData material = materials[materialIndex];
+    vec3 ambient = material.ka * lightColor * texColor;// * 0.05;
 
     float diff = max(dot(N, L), 0.0);
-    vec3 diffuse = diff * kd * lightColor * texColor;// * attenuation * 3;
+    vec3 diffuse = diff * material.kd * lightColor * texColor;// * attenuation * 3;
 
     //    float spec = pow(max(dot(R, V), 0.0), q);
     //  vec3 specular = spec * ks * lightColor * attenuation * 2.0;
     vec3 specular = vec3(0.0);
     if (diff > 0.0)
     {
-        float spec = pow(max(dot(R, V), 0.0), q);
-        specular = spec * ks * lightColor;// * attenuation * 2.0;
+        float spec = pow(max(dot(R, V), 0.0), material.shininess);
+        specular = spec * material.ks * lightColor;// * attenuation * 2.0;
     }
-    vec3 result = ambient + diffuse + specular;
+    float shadow = getShadowVisibility(fragPos, N);
+    vec3 result = ambient + (diffuse + specular) * shadow +
+                  shadeClusteredLights(fragPos, viewDepth, N, V, texColor, material);
 
     color = vec4(result, 1.0);
 }
@@ -0,0 +1,20 @@
+#version 460 core
+
+in vec3 worldPos;
+
+uniform vec3 lightPosition;
+uniform float farPlane;
+uniform bool linearDepth;
+
+void main()
+{
+    // Point light cube maps store the distance to the light instead of projected depth.
+    if (linearDepth)
+    {
+        gl_FragDepth = length(worldPos - lightPosition) / farPlane;
+    }
+    else
+    {
+        gl_FragDepth = gl_FragCoord.z;
+    }
+}
\ No newline at end of file
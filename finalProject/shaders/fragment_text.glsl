@@ -0,0 +1,22 @@
+#version 460 core
+
+in vec2 TexCoords;
+in vec4 Color;
+
+// Distance to the glyph outline, 0.5 on the outline and larger inside.
+uniform sampler2D glyphAtlas;
+
+out vec4 FragColor;
+
+void main()
+{
+    float distance = texture(glyphAtlas, TexCoords).r;
+    // About one pixel of antialiasing at any scale.
+    float width = max(fwidth(distance) * 0.75, 1e-4);
+    float alpha = smoothstep(0.5 - width, 0.5 + width, distance);
+    if (alpha <= 0.0)
+    {
+        discard;
+    }
+    FragColor = vec4(Color.rgb, Color.a * alpha);
+}
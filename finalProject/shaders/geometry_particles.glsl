@@ -0,0 +1,34 @@
+#version 460 core
+
+layout(points) in;
+layout(triangle_strip, max_vertices = 4) out;
+
+layout (std140) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+};
+
+// Edge length of the billboards in world units.
+uniform float particleSize;
+
+in vec4 ParticleColor[];
+
+out vec2 Corner;
+out vec4 Color;
+
+void main()
+{
+    // Expanded in view space, so the quads always face the camera.
+    vec4 center = view * gl_in[0].gl_Position;
+    float halfSize = particleSize * 0.5;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        Corner = vec2(i & 1, i >> 1) * 2.0 - 1.0;
+        Color = ParticleColor[0];
+        gl_Position = projection * (center + vec4(Corner * halfSize, 0.0, 0.0));
+        EmitVertex();
+    }
+    EndPrimitive();
+}
@@ -0,0 +1,27 @@
+#version 460 core
+
+// Passes live particles on to the feedback buffer, compacting it.
+layout(points) in;
+layout(points, max_vertices = 1) out;
+
+in vec4 PositionLife[];
+in vec4 VelocityLifetime[];
+in vec4 Color[];
+
+out vec4 outPositionLife;
+out vec4 outVelocityLifetime;
+out vec4 outColor;
+
+void main()
+{
+    if (PositionLife[0].w <= 0.0)
+    {
+        return;
+    }
+
+    outPositionLife = PositionLife[0];
+    outVelocityLifetime = VelocityLifetime[0];
+    outColor = Color[0];
+    EmitVertex();
+    EndPrimitive();
+}
@@ -0,0 +1,120 @@
+// Shared by the lit fragment shaders: Shader inserts this file after the #version
+// line and the defines, so they declare none of it themselves.
+
+struct PointLight
+{
+    vec3 position;
+    float radius;
+    vec3 color;
+    float intensity;
+};
+
+layout (std430, binding = 0) readonly buffer PointLights
+{
+    PointLight pointLights[];
+};
+
+// Offset and count into clusterLightIndices for every cluster.
+layout (std430, binding = 1) readonly buffer ClusterRanges
+{
+    uvec2 clusterRanges[];
+};
+
+layout (std430, binding = 2) readonly buffer ClusterLightIndices
+{
+    uint clusterLightIndices[];
+};
+
+struct MaterialData
+{
+    vec3 ka;
+    float shininess;
+    vec3 kd;
+    vec3 ks;
+    vec3 ke;
+};
+
+layout (std430, binding = 6) readonly buffer Materials
+{
+    MaterialData materials[];
+};
+
+layout (std140) uniform ShadowData
+{
+    mat4 lightViewProjection;
+    vec4 shadowLightPosition;  // xyz, far plane
+    ivec4 shadowParams;        // type: 0 none, 1 directional, 2 point
+    vec4 shadowBias;           // depth bias, normal bias, strength
+};
+
+// Static casters are cached in one layer, dynamic casters redrawn in the other.
+uniform sampler2DShadow staticShadowMap;
+uniform sampler2DShadow dynamicShadowMap;
+uniform samplerCubeShadow staticShadowCube;
+uniform samplerCubeShadow dynamicShadowCube;
+
+layout (std140) uniform ClusterData
+{
+    uvec4 clusterGrid;   // x, y, z, light count
+    vec4 clusterScreen;  // tile width, tile height, slice scale, slice bias
+};
+
+float getShadowVisibility(vec3 worldPosition, vec3 N)
+{
+    float visibility = 1.0;
+    vec3 offsetPosition = worldPosition + N * shadowBias.y;
+
+    if (shadowParams.x == 1)
+    {
+        vec4 lightClip = lightViewProjection * vec4(offsetPosition, 1.0);
+        vec3 coord = lightClip.xyz / lightClip.w * 0.5 + 0.5;
+        if (coord.z < 1.0)
+        {
+            coord.z -= shadowBias.x;
+            visibility = min(texture(staticShadowMap, coord), texture(dynamicShadowMap, coord));
+        }
+    }
+    else if (shadowParams.x == 2)
+    {
+        vec3 toFragment = offsetPosition - shadowLightPosition.xyz;
+        vec4 coord = vec4(toFragment, length(toFragment) / shadowLightPosition.w - shadowBias.x);
+        visibility = min(texture(staticShadowCube, coord), texture(dynamicShadowCube, coord));
+    }
+
+    return mix(1.0, visibility, shadowBias.z);
+}
+
+vec3 shadeClusteredLights(vec3 worldPosition, float viewDepth, vec3 N, vec3 V, vec3 texColor,
+                          MaterialData material)
+{
+    float slice = max(log(viewDepth) * clusterScreen.z + clusterScreen.w, 0.0);
+    uvec3 cluster = min(uvec3(uvec2(gl_FragCoord.xy / clusterScreen.xy), uint(slice)), clusterGrid.xyz - 1u);
+    uvec2 range = clusterRanges[cluster.x + clusterGrid.x * (cluster.y + clusterGrid.y * cluster.z)];
+
+    vec3 result = vec3(0.0);
+    for (uint i = 0u; i < range.y; ++i)
+    {
+        PointLight light = pointLights[clusterLightIndices[range.x + i]];
+
+        vec3 toLight = light.position - worldPosition;
+        float distance = length(toLight);
+        if (distance >= light.radius)
+        {
+            continue;
+        }
+
+        // Windowed inverse square falloff so the light reaches exactly zero at its radius.
+        float falloff = clamp(1.0 - pow(distance / light.radius, 4.0), 0.0, 1.0);
+        vec3 radiance = light.color * light.intensity * falloff * falloff / (1.0 + distance * distance);
+
+        vec3 L = toLight / distance;
+        float diff = max(dot(N, L), 0.0);
+        result += diff * material.kd * texColor * radiance;
+        if (diff > 0.0)
+        {
+            result += pow(max(dot(reflect(-L, N), V), 0.0), material.shininess) * material.ks * radiance;
+        }
+    }
+
+    return result;
+}
@@ -3,14 +3,24 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoord;
 
+// Same depth in the pre-pass and the shading pass.
+invariant gl_Position;
+
 uniform mat4 modelFloor;
-uniform mat4 view;
-uniform mat4 projection;
+
+layout (std140) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+};
 
 out vec2 TexCoord;
+out vec3 worldPos;
 
 void main()
 {
-    gl_Position = projection * view * modelFloor * vec4(aPos, 1.0);
+    vec4 world = modelFloor * vec4(aPos, 1.0);
+    worldPos = vec3(world);
+    gl_Position = projection * view * world;
     TexCoord = aTexCoord;
 }
\ No newline at end of file
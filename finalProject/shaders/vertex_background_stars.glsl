@@ -8,5 +8,6 @@ out vec2 TexCoords;
 void main()
 {
     TexCoords = aTexCoords;
-    gl_Position = vec4(aPos.x, aPos.y, 0.0, 1.0);
+    // Drawn last at the far plane, so the depth test skips every pixel already covered.
+    gl_Position = vec4(aPos.x, aPos.y, 1.0, 1.0);
 }
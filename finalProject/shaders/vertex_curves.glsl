@@ -1,8 +1,11 @@
 #version 460 core
 layout (location = 0) in vec3 position;
  
-uniform mat4 view;
-uniform mat4 projection;
+layout (std140) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+};
 
 void main()
 {
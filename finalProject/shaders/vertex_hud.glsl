@@ -0,0 +1,19 @@
+#version 460 core
+
+layout(location = 0) in vec2 aPos;
+layout(location = 1) in vec2 aTexCoords;
+layout(location = 2) in vec4 aColor;
+
+// Framebuffer size; positions are in pixels from the top left corner.
+uniform vec2 viewportSize;
+
+out vec2 TexCoords;
+out vec4 Color;
+
+void main()
+{
+    TexCoords = aTexCoords;
+    Color = aColor;
+    vec2 ndc = aPos / viewportSize * 2.0 - 1.0;
+    gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);
+}
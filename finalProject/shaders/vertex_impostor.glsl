@@ -0,0 +1,38 @@
+#version 460 core
+
+// A quad around the mesh's bounding sphere, facing the camera. It is built in
+// model space, so the model matrix places, turns and scales it like the mesh.
+uniform mat4 model;
+uniform vec3 boundsCenter;
+uniform float boundsRadius;
+// Camera position in model space.
+uniform vec3 modelCamera;
+
+layout (std140) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+};
+
+out vec3 modelPosition;
+
+// Same as ImpostorRenderer::getViewBasis: the axes of a view looking back along direction.
+void getViewBasis(vec3 direction, out vec3 right, out vec3 up)
+{
+    vec3 reference = abs(direction.y) > 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(0.0, 1.0, 0.0);
+    right = normalize(cross(reference, direction));
+    up = cross(direction, right);
+}
+
+void main()
+{
+    vec3 right;
+    vec3 up;
+    getViewBasis(normalize(modelCamera - boundsCenter), right, up);
+
+    // Triangle strip corners (-1,-1), (1,-1), (-1,1), (1,1).
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+    modelPosition = boundsCenter + (right * corner.x + up * corner.y) * boundsRadius;
+
+    gl_Position = projection * view * model * vec4(modelPosition, 1.0);
+}
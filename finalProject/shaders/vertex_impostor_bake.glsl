@@ -0,0 +1,19 @@
+#version 460 core
+
+// Renders one view of a mesh into its impostor atlas, in model space.
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec2 tex_coord;
+layout (location = 2) in vec3 normal;
+
+// Orthographic projection of the bounding sphere, seen from the view's direction.
+uniform mat4 viewProjection;
+
+out vec2 texCoord;
+out vec3 modelNormal;
+
+void main()
+{
+    gl_Position = viewProjection * vec4(position, 1.0);
+    texCoord = vec2(tex_coord.x, 1.0 - tex_coord.y);
+    modelNormal = normal;
+}
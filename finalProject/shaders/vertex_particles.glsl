@@ -0,0 +1,16 @@
+#version 460 core
+
+// One point per particle, expanded into a billboard by the geometry shader.
+layout(location = 0) in vec4 aPositionLife;
+layout(location = 1) in vec4 aVelocityLifetime;
+layout(location = 2) in vec4 aColor;
+
+out vec4 ParticleColor;
+
+void main()
+{
+    // Fade out over the last third of the particle's life.
+    float fade = clamp(aPositionLife.w / (aVelocityLifetime.w * 0.33), 0.0, 1.0);
+    ParticleColor = vec4(aColor.rgb, aColor.a * fade);
+    gl_Position = vec4(aPositionLife.xyz, 1.0);
+}
@@ -0,0 +1,78 @@
+#version 460 core
+
+// Transform feedback fallback of compute_particles.glsl: the same emission and
+// integration, one particle per point. The geometry shader drops dead particles.
+layout(location = 0) in vec4 aPositionLife;
+layout(location = 1) in vec4 aVelocityLifetime;
+layout(location = 2) in vec4 aColor;
+
+// Emitting creates particle gl_VertexID of the burst; otherwise the input particle is moved.
+uniform bool emitting;
+
+uniform float dt;
+uniform vec3 gravity;
+uniform float drag;
+uniform float floorHeight;
+uniform float restitution;
+
+uniform vec3 burstOrigin;
+uniform uint burstSeed;
+uniform float cosSpread;
+uniform float minSpeed;
+uniform float maxSpeed;
+uniform float minLifetime;
+uniform float maxLifetime;
+uniform vec4 colorA;
+uniform vec4 colorB;
+
+out vec4 PositionLife;
+out vec4 VelocityLifetime;
+out vec4 Color;
+
+uint hashParticle(uint value)
+{
+    uint state = value * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+float nextRandom(inout uint state)
+{
+    state = hashParticle(state);
+    return float(state >> 8u) * (1.0 / 16777216.0);
+}
+
+void main()
+{
+    if (emitting)
+    {
+        uint state = uint(gl_VertexID) * 2654435769u + burstSeed;
+
+        float azimuth = nextRandom(state) * 2.0 * 3.14159265;
+        float cosTheta = 1.0 + (cosSpread - 1.0) * nextRandom(state);
+        float sinTheta = sqrt(max(1.0 - cosTheta * cosTheta, 0.0));
+        float speed = minSpeed + (maxSpeed - minSpeed) * nextRandom(state);
+        float lifetime = minLifetime + (maxLifetime - minLifetime) * nextRandom(state);
+        float colorMix = nextRandom(state);
+
+        vec3 velocity = vec3(sinTheta * cos(azimuth), cosTheta, sinTheta * sin(azimuth)) * speed;
+        PositionLife = vec4(burstOrigin, lifetime);
+        VelocityLifetime = vec4(velocity, lifetime);
+        Color = colorA + (colorB - colorA) * colorMix;
+        return;
+    }
+
+    float damping = max(1.0 - drag * dt, 0.0);
+    vec3 velocity = (aVelocityLifetime.xyz + gravity * dt) * damping;
+    vec3 position = aPositionLife.xyz + velocity * dt;
+
+    if (position.y < floorHeight)
+    {
+        position.y = floorHeight;
+        velocity.y *= -restitution;
+    }
+
+    PositionLife = vec4(position, aPositionLife.w - dt);
+    VelocityLifetime = vec4(velocity, aVelocityLifetime.w);
+    Color = aColor;
+}
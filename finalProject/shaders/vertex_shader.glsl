@@ -8,18 +8,32 @@ layout (location = 2) in vec3 normal;
 out vec2 texCoord;
 out vec3 fragPos;
 out vec3 fragNormal;
+out float viewDepth;
+
+// The depth pre-pass links this shader with an empty fragment shader; invariance
+// guarantees both programs write the same depth, so the shading pass can test LEQUAL.
+invariant gl_Position;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+uniform mat3 normalMatrix;
+// Only used to benchmark against computing the normal matrix for every vertex.
+uniform bool perVertexNormalMatrix;
+
+layout (std140) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+};
 
 void main()
 {
     vec4 worldPos = model * vec4(position, 1.0);
-    gl_Position = projection * view * worldPos;
+    vec4 viewPos = view * worldPos;
+    gl_Position = projection * viewPos;
+    viewDepth = -viewPos.z;
 
     texCoord = vec2(tex_coord.x, 1.0 - tex_coord.y);
 
     fragPos = vec3(worldPos);
-    fragNormal = mat3(transpose(inverse(model))) * normal;
+    fragNormal = perVertexNormalMatrix ? mat3(transpose(inverse(model))) * normal : normalMatrix * normal;
 }
\ No newline at end of file
@@ -0,0 +1,15 @@
+#version 460 core
+
+layout (location = 0) in vec3 position;
+
+uniform mat4 model;
+uniform mat4 lightViewProjection;
+
+out vec3 worldPos;
+
+void main()
+{
+    vec4 world = model * vec4(position, 1.0);
+    worldPos = vec3(world);
+    gl_Position = lightViewProjection * world;
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#version 460 core
+
+// One instance per glyph: the quad's corner and edges, in world units or pixels.
+layout(location = 0) in vec3 aOrigin;
+layout(location = 1) in vec3 aRight;
+layout(location = 2) in vec3 aUp;
+layout(location = 3) in vec4 aUVRect;
+layout(location = 4) in vec4 aColor;
+
+// Screen text is in pixels from the top left corner of a viewportSize framebuffer.
+uniform bool screenSpace;
+uniform vec2 viewportSize;
+
+layout (std140) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+};
+
+out vec2 TexCoords;
+out vec4 Color;
+
+void main()
+{
+    // Triangle strip corners (0,0), (1,0), (0,1), (1,1).
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    vec3 position = aOrigin + aRight * corner.x + aUp * corner.y;
+
+    TexCoords = mix(aUVRect.xy, aUVRect.zw, corner);
+    Color = aColor;
+    if (screenSpace)
+    {
+        vec2 ndc = position.xy / viewportSize * 2.0 - 1.0;
+        gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);
+    }
+    else
+    {
+        gl_Position = projection * view * vec4(position, 1.0);
+    }
+}